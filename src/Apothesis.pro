@@ -10,6 +10,16 @@ CONFIG += c++11
 CONFIG += debug_and_release
 CONFING -= qt
 
+# The morphology analysis runs on a background thread
+QMAKE_CXXFLAGS += -pthread
+LIBS += -pthread
+
+# The lattice snapshots are compressed if zlib is found
+packagesExist(zlib) {
+    DEFINES += HAVE_ZLIB
+    LIBS += -lz
+}
+
 
 INCLUDEPATH += . \
               IO \
@@ -17,6 +27,11 @@ INCLUDEPATH += . \
               error \
               processes \
 	      species \
+	      memory \
+	      engine \
+	      gas \
+	      analysis \
+	      api \
 	      rapidjson/include
 
 # The following define makes your compiler warn you if you use any
@@ -33,6 +48,8 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # Input
 HEADERS += apothesis.h \
            IO/cml_reader.h \
+           IO/trace.h \
+           IO/perf_counters.h \
            IO/txt_reader.h \
            IO/xyz_reader.h \
            lattice/BCC.h \
@@ -43,19 +60,49 @@ HEADERS += apothesis.h \
            error/errorhandler.h \
            lattice/lattice.h \
            lattice/site.h \
+           lattice/topology_cache.h \
+           lattice/voxel_lattice.h \
            processes/abstract_process.h \
            processes/adsorption.h \
            processes/desorption.h \
+           processes/rate_classes.h \
+           processes/rate_expression.h \
+           processes/rate_law.h \
+           processes/reaction_template.h \
+           processes/lateral_interactions.h \
            processes/diffusion.h \
            processes/factory_process.h \
            processes/process.h \
            processes/SurfaceReaction.h \
            species/species.h \
            IO/read.h \
-           processes/io.h
+           IO/observables.h \
+           IO/metrics.h \
+           IO/snapshot_writer.h \
+           IO/observation_scheduler.h \
+           IO/event_recorder.h \
+           IO/event_replay.h \
+           IO/mapped_file.h \
+           IO/lattice_reader.h \
+           processes/io.h \
+           memory/arena.h \
+           memory/memory_report.h \
+           engine/indexed_heap.h \
+           engine/next_reaction.h \
+           engine/parallel.h \
+           engine/sum_tree.h \
+           engine/hierarchical_selector.h \
+           engine/process_table.h \
+           engine/tau_leaping.h \
+           gas/boundary_layer.h \
+           analysis/fft.h \
+           analysis/morphology.h \
+           api/apothesis_c.h
 
 SOURCES += apothesis.cpp \
            IO/cml_reader.cpp \
+           IO/trace.cpp \
+           IO/perf_counters.cpp \
            IO/txt_reader.cpp \
            IO/xyz_reader.cpp \
            lattice/BCC.cpp \
@@ -66,14 +113,42 @@ SOURCES += apothesis.cpp \
            error/errorhandler.cpp \
            lattice/lattice.cpp \
            lattice/site.cpp \
+           lattice/topology_cache.cpp \
+           lattice/voxel_lattice.cpp \
            processes/adsorption.cpp \
            processes/desorption.cpp \
+           processes/rate_classes.cpp \
+           processes/rate_expression.cpp \
+           processes/rate_law.cpp \
+           processes/reaction_template.cpp \
+           processes/lateral_interactions.cpp \
            processes/diffusion.cpp \
            processes/factory_process.cpp \
            processes/process.cpp \
            processes/SurfaceReaction.cpp \
            species/species.cpp \
            IO/read.cpp \
-           processes/io.cpp
+           IO/observables.cpp \
+           IO/metrics.cpp \
+           IO/snapshot_writer.cpp \
+           IO/observation_scheduler.cpp \
+           IO/event_recorder.cpp \
+           IO/event_replay.cpp \
+           IO/mapped_file.cpp \
+           IO/lattice_reader.cpp \
+           processes/io.cpp \
+           memory/arena.cpp \
+           memory/memory_report.cpp \
+           engine/indexed_heap.cpp \
+           engine/next_reaction.cpp \
+           engine/parallel.cpp \
+           engine/sum_tree.cpp \
+           engine/hierarchical_selector.cpp \
+           engine/process_table.cpp \
+           engine/tau_leaping.cpp \
+           gas/boundary_layer.cpp \
+           analysis/fft.cpp \
+           analysis/morphology.cpp \
+           api/apothesis_c.cpp
 
 
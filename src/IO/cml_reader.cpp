@@ -1,3 +1,94 @@
 #include "cml_reader.h"
+#include "mapped_file.h"
+#include "errorhandler.h"
 
-CmlReader::CmlReader(string cmlPath){}
+#include <cstring>
+
+using namespace Utils;
+
+CmlReader::CmlReader(Apothesis* apothesis, string cmlPath):LatticeReader(apothesis, cmlPath){}
+
+void CmlReader::read(int nx, int ny)
+{
+    MappedFile file(m_path);
+    if (!file.isOpen())
+    {
+      m_errorHandler->error_simple_msg("Cannot open file " + m_path);
+      EXIT;
+    }
+
+    mf_init(nx, ny);
+
+    const char* p = file.begin();
+    const char* end = file.end();
+
+    while (p < end)
+    {
+      // Next element
+      p = (const char*)memchr(p, '<', end - p);
+      if (!p)
+        break;
+      p++;
+
+      // Only <atom ...> (not <atomArray>)
+      if (end - p < 5 || memcmp(p, "atom", 4) != 0 || (p[4] != ' ' && p[4] != '\t' && p[4] != '\n' && p[4] != '\r' && p[4] != '/' && p[4] != '>'))
+        continue;
+      p += 4;
+
+      const char* tagEnd = (const char*)memchr(p, '>', end - p);
+      if (!tagEnd)
+        break;
+
+      const char* symbolBegin = 0;
+      const char* symbolEnd = 0;
+      double x = 0, y = 0, z = 0;
+      int found = 0;
+
+      // Attributes name="value"
+      while (p < tagEnd)
+      {
+        while (p < tagEnd && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' || *p == '/'))
+          p++;
+
+        const char* nameBegin = p;
+        while (p < tagEnd && *p != '=')
+          p++;
+        const char* nameEnd = p;
+
+        // Opening quote
+        p++;
+        if (p >= tagEnd || (*p != '"' && *p != '\''))
+          break;
+        char quote = *p++;
+
+        const char* valueBegin = p;
+        while (p < tagEnd && *p != quote)
+          p++;
+        const char* valueEnd = p;
+        p++;
+
+        size_t len = nameEnd - nameBegin;
+        if (len == 11 && memcmp(nameBegin, "elementType", 11) == 0)
+        {
+          symbolBegin = valueBegin;
+          symbolEnd = valueEnd;
+          found |= 1;
+        }
+        else if (len == 2 && memcmp(nameBegin, "x3", 2) == 0 && Tokenizer::toNumber(valueBegin, valueEnd, x))
+          found |= 2;
+        else if (len == 2 && memcmp(nameBegin, "y3", 2) == 0 && Tokenizer::toNumber(valueBegin, valueEnd, y))
+          found |= 4;
+        else if (len == 2 && memcmp(nameBegin, "z3", 2) == 0 && Tokenizer::toNumber(valueBegin, valueEnd, z))
+          found |= 8;
+      }
+
+      if (found != 15)
+      {
+        m_errorHandler->error_simple_msg("An atom in " + m_path + " has no elementType, x3, y3 or z3.");
+        EXIT;
+      }
+
+      mf_addAtom(symbolBegin, symbolEnd, x, y, z);
+      p = tagEnd + 1;
+    }
+}
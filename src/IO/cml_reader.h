@@ -2,14 +2,21 @@
 #define CMLREADER_H
 
 #include <string>
-///XML library neaded here
+
+#include "lattice_reader.h"
 
 using namespace std;
 
-class CmlReader
+/** Reads a starting surface in CML (Chemical Markup Language) format.
+ * Every <atom .../> element gives its symbol in elementType and its position in x3, y3 and z3. */
+
+class CmlReader: public LatticeReader
 {
 public:
-    explicit CmlReader(string cmlPath);
+    explicit CmlReader(Apothesis* apothesis, string cmlPath);
+
+    /// Parses the file for a lattice of nx x ny sites.
+    void read(int nx, int ny);
 };
 
 #endif // CMLREADER_H
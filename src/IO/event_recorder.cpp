@@ -0,0 +1,129 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "event_recorder.h"
+#include "lattice.h"
+#include "site.h"
+#include "process.h"
+#include "errorhandler.h"
+#include "trace.h"
+#include "memory_report.h"
+
+#include <cstring>
+#include <cstdint>
+
+using namespace MicroProcesses;
+
+EventRecorder::EventRecorder( Apothesis* apothesis, string path, long keyframeInterval ):Pointers( apothesis ),
+  m_sPath( path ),
+  m_lKeyframeInterval( keyframeInterval ),
+  m_lEvents( 0 ),
+  m_pFile( 0 )
+{
+  if ( m_lKeyframeInterval <= 0 ){
+    m_errorHandler->error_simple_msg( "The keyframe interval of the event stream must be positive." );
+    EXIT;
+  }
+}
+
+EventRecorder::~EventRecorder()
+{
+  if ( m_pFile )
+    fclose( m_pFile );
+}
+
+void EventRecorder::init( vector< Process* > processes )
+{
+  m_pFile = fopen( m_sPath.c_str(), "wb" );
+  if ( !m_pFile ){
+    m_errorHandler->error_simple_msg( "Cannot open the event stream " + m_sPath );
+    EXIT;
+  }
+
+  // The events are small so the file is written in large blocks
+  setvbuf( m_pFile, 0, _IOFBF, BUFFER_SIZE );
+
+  int32_t header[ 3 ] = { m_lattice->getSize(), (int32_t)m_lKeyframeInterval, (int32_t)processes.size() };
+  fwrite( "APOEVT01", 1, 8, m_pFile );
+  fwrite( header, sizeof( int32_t ), 3, m_pFile );
+
+  for ( int i = 0; i < (int)processes.size(); i++ ){
+    string name = processes[ i ]->getName();
+    int32_t length = name.size();
+    fwrite( &length, sizeof( int32_t ), 1, m_pFile );
+    fwrite( name.data(), 1, length, m_pFile );
+  }
+
+  mf_keyframe( 0 );
+}
+
+void EventRecorder::record( Process* p, long double time )
+{
+  char record[ 1 + EVENT_SIZE ];
+  int32_t values[ 3 ] = { p->getIndex(), p->getSite(), p->getEventData() };
+  double t = (double)time;
+
+  record[ 0 ] = EVENT;
+  memcpy( record + 1, values, sizeof( values ) );
+  memcpy( record + 1 + sizeof( values ), &t, sizeof( double ) );
+  fwrite( record, 1, sizeof( record ), m_pFile );
+
+  m_lEvents++;
+  if ( m_lEvents % m_lKeyframeInterval == 0 )
+    mf_keyframe( time );
+}
+
+void EventRecorder::mf_keyframe( long double time )
+{
+  Utils::TraceScope trace( "EventRecorder::keyframe" );
+
+  int size = m_lattice->getSize();
+
+  vector< int32_t > heights( size );
+  vector< uint8_t > counts( size );
+  vector< int16_t > ids;
+  for ( int i = 0; i < size; i++ ){
+    Site* s = m_lattice->getSite( i );
+    heights[ i ] = s->getHeight();
+    counts[ i ] = s->getNumSpecies();
+    for ( int k = 0; k < s->getNumSpecies(); k++ )
+      ids.push_back( s->getSpeciesAt( k )->getId() );
+  }
+
+  double t = (double)time;
+  int64_t events = m_lEvents;
+  int64_t bytes = sizeof( t ) + sizeof( events ) + heights.size()*sizeof( int32_t ) + counts.size() + ids.size()*sizeof( int16_t );
+
+  fputc( KEYFRAME, m_pFile );
+  fwrite( &bytes, sizeof( bytes ), 1, m_pFile );
+  fwrite( &t, sizeof( t ), 1, m_pFile );
+  fwrite( &events, sizeof( events ), 1, m_pFile );
+  fwrite( heights.data(), sizeof( int32_t ), heights.size(), m_pFile );
+  fwrite( counts.data(), 1, counts.size(), m_pFile );
+  fwrite( ids.data(), sizeof( int16_t ), ids.size(), m_pFile );
+}
+
+void EventRecorder::accountMemory( Utils::MemoryReport& report )
+{
+  // The stream of the file buffers BUFFER_SIZE bytes (see init)
+  report.add( Utils::MemoryReport::IO, sizeof( EventRecorder ) + ( m_pFile ? Utils::MemoryReport::block( BUFFER_SIZE ) : 0 ) );
+}
+
+void EventRecorder::estimateMemory( Utils::MemoryReport& report )
+{
+  report.add( Utils::MemoryReport::IO, sizeof( EventRecorder ) + Utils::MemoryReport::block( BUFFER_SIZE ) );
+}
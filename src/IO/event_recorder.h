@@ -0,0 +1,90 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef EVENT_RECORDER_H
+#define EVENT_RECORDER_H
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "pointers.h"
+
+using namespace std;
+
+namespace MicroProcesses { class Process; }
+
+/** Records the run as a compact event stream (event_stream <file> [keyframe interval]) from which
+ * the lattice at any past time is rebuilt by EventReplay. The binary file holds:
+ * - a header: "APOEVT01", the number of sites, the keyframe interval and the names of the processes,
+ * - an event record per event: 'E', the process (index), the site, the data of the event
+ *   (see Process::getEventData) and its time,
+ * - a keyframe every so many events and at the start: 'K', the size of the rest of the record, the time,
+ *   the number of events, the heights, the number of species on each site and their ids.
+ * An event is 21 bytes instead of the whole lattice of a snapshot. */
+
+class EventRecorder: public Pointers
+{
+public:
+    /// The tags of the records
+    static const char EVENT = 'E';
+    static const char KEYFRAME = 'K';
+
+    /// The size of an event record after its tag
+    static const int EVENT_SIZE = 3*sizeof( int ) + sizeof( double );
+
+    /// The size of the buffer of the file stream
+    static const int BUFFER_SIZE = 1 << 20;
+
+    /// Constructor
+    EventRecorder( Apothesis* apothesis, string path, long keyframeInterval );
+
+    /// Destructor. Closes the file.
+    virtual ~EventRecorder();
+
+    /// Opens the file and writes the header and the first keyframe. The processes are in the order of their
+    /// index (see Process::getIndex), which is the number the events are recorded with.
+    void init( vector< MicroProcesses::Process* > processes );
+
+    /// Records an event of the process that has just been performed. A keyframe follows every keyframe interval events.
+    void record( MicroProcesses::Process* p, long double time );
+
+    /// Adds the recorder and the buffer of its file to the memory report.
+    void accountMemory( Utils::MemoryReport& report );
+
+    /// Adds the projection of the recorder to the memory report.
+    static void estimateMemory( Utils::MemoryReport& report );
+
+private:
+    /// The path of the file
+    string m_sPath;
+
+    /// The events between two keyframes
+    long m_lKeyframeInterval;
+
+    /// The number of events recorded
+    long m_lEvents;
+
+    /// The file
+    FILE* m_pFile;
+
+    /// Writes the lattice as a keyframe
+    void mf_keyframe( long double time );
+};
+
+#endif // EVENT_RECORDER_H
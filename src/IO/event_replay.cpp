@@ -0,0 +1,275 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "event_replay.h"
+#include "event_recorder.h"
+#include "snapshot_writer.h"
+#include "parallel.h"
+#include "io.h"
+#include "lattice.h"
+#include "site.h"
+#include "process.h"
+#include "errorhandler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#include <sys/wait.h>
+#include <unistd.h>
+#define HAVE_FORK
+#endif
+
+using namespace MicroProcesses;
+
+EventReplay::EventReplay( Apothesis* apothesis, string path ):Pointers( apothesis ),
+  m_pApothesis( apothesis ),
+  m_sPath( path )
+{;}
+
+EventReplay::~EventReplay(){;}
+
+FILE* EventReplay::mf_open()
+{
+  FILE* file = fopen( m_sPath.c_str(), "rb" );
+  if ( !file ){
+    m_errorHandler->error_simple_msg( "Cannot open the event stream " + m_sPath );
+    EXIT;
+  }
+  return file;
+}
+
+void EventReplay::init( vector< Process* > processes, map< string, Species* > species )
+{
+  m_vProcesses = processes;
+
+  for ( auto& s : species ){
+    if ( !s.second )
+      continue;
+
+    int id = s.second->getId();
+    if ( id >= (int)m_vSpecies.size() ){
+      m_vSpecies.resize( id + 1, 0 );
+      m_vSpeciesNames.resize( id + 1 );
+    }
+    m_vSpecies[ id ] = s.second;
+    m_vSpeciesNames[ id ] = s.first;
+  }
+
+  FILE* file = mf_open();
+
+  // The header must match the lattice and the processes of the input
+  char magic[ 8 ];
+  int32_t header[ 3 ];
+  bool valid = fread( magic, 1, 8, file ) == 8 && memcmp( magic, "APOEVT01", 8 ) == 0 &&
+               fread( header, sizeof( int32_t ), 3, file ) == 3 &&
+               header[ 0 ] == m_lattice->getSize() && header[ 2 ] == (int32_t)m_vProcesses.size();
+
+  for ( int i = 0; valid && i < (int)m_vProcesses.size(); i++ ){
+    int32_t length;
+    valid = fread( &length, sizeof( int32_t ), 1, file ) == 1 && length >= 0;
+    string name( valid ? length : 0, ' ' );
+    valid = valid && fread( &name[ 0 ], 1, length, file ) == (size_t)length && name == m_vProcesses[ i ]->getName();
+  }
+
+  if ( !valid ){
+    m_errorHandler->error_simple_msg( "The event stream " + m_sPath + " was not recorded with the lattice and the processes of this input." );
+    EXIT;
+  }
+
+  // Index the keyframes
+  int tag;
+  while ( ( tag = fgetc( file ) ) != EOF ){
+    if ( tag == EventRecorder::EVENT ){
+      fseek( file, EventRecorder::EVENT_SIZE, SEEK_CUR );
+      continue;
+    }
+
+    int64_t bytes;
+    Keyframe k;
+    if ( tag != EventRecorder::KEYFRAME || fread( &bytes, sizeof( bytes ), 1, file ) != 1 ){
+      m_errorHandler->error_simple_msg( "The event stream " + m_sPath + " is corrupted." );
+      EXIT;
+    }
+
+    int64_t events;
+    k.offset = ftell( file );
+    if ( fread( &k.time, sizeof( double ), 1, file ) != 1 || fread( &events, sizeof( events ), 1, file ) != 1 )
+      break;
+    k.events = events;
+    m_vKeyframes.push_back( k );
+
+    fseek( file, k.offset + bytes, SEEK_SET );
+  }
+
+  fclose( file );
+
+  if ( m_vKeyframes.empty() ){
+    m_errorHandler->error_simple_msg( "The event stream " + m_sPath + " has no keyframe." );
+    EXIT;
+  }
+
+  m_io->writeLogOutput( "Event stream with " + to_string( m_vKeyframes.size() ) + " keyframes" );
+}
+
+void EventReplay::run( vector< double > times )
+{
+  sort( times.begin(), times.end() );
+
+  int groups = min( Utils::getNumThreads(), (int)times.size() );
+  vector< vector< double > > vGroups( groups );
+  for ( int i = 0; i < (int)times.size(); i++ )
+    vGroups[ (long)i*groups/times.size() ].push_back( times[ i ] );
+
+#ifdef HAVE_FORK
+  if ( groups > 1 ){
+    // Every child starts from the initialized lattice of the parent. Nothing buffered must be written twice.
+    cout.flush();
+    fflush( stdout );
+
+    vector< pid_t > children;
+    for ( vector< double >& g : vGroups ){
+      pid_t pid = fork();
+      if ( pid == 0 ){
+        mf_replay( g );
+        _exit( 0 );
+      }
+      children.push_back( pid );
+    }
+
+    bool failed = false;
+    for ( pid_t pid : children ){
+      int status = 0;
+      if ( pid < 0 || waitpid( pid, &status, 0 ) < 0 || !WIFEXITED( status ) || WEXITSTATUS( status ) != 0 )
+        failed = true;
+    }
+
+    if ( failed ){
+      m_errorHandler->error_simple_msg( "The replay of the event stream failed." );
+      EXIT;
+    }
+    return;
+  }
+#endif
+
+  // One keyframe per group. A keyframe can only be loaded on the initialized lattice so the groups are merged.
+  mf_replay( times );
+}
+
+void EventReplay::mf_replay( vector< double > times )
+{
+  if ( times.empty() )
+    return;
+
+  // The last keyframe before the first time
+  int k = 0;
+  while ( k + 1 < (int)m_vKeyframes.size() && m_vKeyframes[ k + 1 ].time < times[ 0 ] )
+    k++;
+
+  FILE* file = mf_open();
+  fseek( file, m_vKeyframes[ k ].offset, SEEK_SET );
+  mf_loadKeyframe( file );
+
+  long events = m_vKeyframes[ k ].events;
+  size_t next = 0;
+
+  // The events before each time are performed, as an observation sees the lattice before the event that crosses its time
+  int tag;
+  while ( next < times.size() && ( tag = fgetc( file ) ) != EOF ){
+    if ( tag == EventRecorder::KEYFRAME ){
+      int64_t bytes;
+      if ( fread( &bytes, sizeof( bytes ), 1, file ) != 1 )
+        break;
+      fseek( file, bytes, SEEK_CUR );
+      continue;
+    }
+
+    char record[ EventRecorder::EVENT_SIZE ];
+    if ( fread( record, 1, sizeof( record ), file ) != sizeof( record ) )
+      break;
+
+    int32_t values[ 3 ];
+    double time;
+    memcpy( values, record, sizeof( values ) );
+    memcpy( &time, record + sizeof( values ), sizeof( double ) );
+
+    while ( next < times.size() && times[ next ] <= time )
+      mf_write( times[ next++ ], events );
+
+    if ( next == times.size() )
+      break;
+
+    if ( values[ 0 ] < 0 || values[ 0 ] >= (int)m_vProcesses.size() || values[ 1 ] < 0 || values[ 1 ] >= m_lattice->getSize() ){
+      m_errorHandler->error_simple_msg( "The event stream " + m_sPath + " is corrupted." );
+      EXIT;
+    }
+
+    m_vProcesses[ values[ 0 ] ]->replay( m_lattice->getSite( values[ 1 ] ), values[ 2 ] );
+    events++;
+  }
+
+  fclose( file );
+
+  // The times after the end of the stream see the final lattice
+  while ( next < times.size() )
+    mf_write( times[ next++ ], events );
+}
+
+void EventReplay::mf_loadKeyframe( FILE* file )
+{
+  int size = m_lattice->getSize();
+
+  double time;
+  int64_t events;
+  vector< int32_t > heights( size );
+  vector< uint8_t > counts( size );
+  bool valid = fread( &time, sizeof( time ), 1, file ) == 1 && fread( &events, sizeof( events ), 1, file ) == 1 &&
+               fread( heights.data(), sizeof( int32_t ), size, file ) == (size_t)size &&
+               fread( counts.data(), 1, size, file ) == (size_t)size;
+
+  vector< int > vHeights( heights.begin(), heights.end() );
+  vector< vector< Species* > > vSpecies( size );
+  for ( int i = 0; valid && i < size; i++ ){
+    for ( int c = 0; c < counts[ i ]; c++ ){
+      int16_t id;
+      valid = fread( &id, sizeof( id ), 1, file ) == 1 && id >= 0 && id < (int)m_vSpecies.size() && m_vSpecies[ id ];
+      if ( valid )
+        vSpecies[ i ].push_back( m_vSpecies[ id ] );
+    }
+  }
+
+  if ( !valid ){
+    m_errorHandler->error_simple_msg( "The keyframe of the event stream " + m_sPath + " is corrupted." );
+    EXIT;
+  }
+
+  m_pApothesis->setSurface( vHeights, vSpecies );
+}
+
+void EventReplay::mf_write( double time, long events )
+{
+  ostringstream path;
+  path << m_sPath << "-" << time;
+
+  SnapshotWriter writer( m_pApothesis );
+  writer.init( path.str(), m_vSpeciesNames );
+  writer.snapshot( time, events );
+  m_io->writeLogOutput( "Replayed " + to_string( events ) + " events up to " + path.str() );
+}
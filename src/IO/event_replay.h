@@ -0,0 +1,93 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef EVENT_REPLAY_H
+#define EVENT_REPLAY_H
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "pointers.h"
+
+using namespace std;
+
+namespace MicroProcesses { class Process; }
+
+/** Rebuilds the lattice at given times from an event stream of EventRecorder
+ * (Apothesis --replay <file> <time> ...). For each time the nearest keyframe before it is loaded into the
+ * freshly initialized lattice and the events up to the time are performed again through the processes
+ * (see Process::replay). The lattice at each time is written as a snapshot <file>-<time>.
+ * The sorted times are split in contiguous groups that are replayed in parallel, each in a child process
+ * that starts from the initialized state (fork). Without fork, or with one thread, the groups are replayed in turn
+ * and one keyframe serves all the times of a group. */
+
+class EventReplay: public Pointers
+{
+public:
+    /// Constructor
+    EventReplay( Apothesis* apothesis, string path );
+
+    /// Destructor
+    virtual ~EventReplay();
+
+    /// Reads the header and indexes the keyframes. The processes must be the ones of the recorded run.
+    void init( vector< MicroProcesses::Process* > processes, map< string, Species* > species );
+
+    /// Writes the lattice at each of the times.
+    void run( vector< double > times );
+
+private:
+    /// A keyframe: its time, the events before it and the position of its data in the file
+    struct Keyframe
+    {
+        double time;
+        long events;
+        long offset;
+    };
+
+    /// The apothesis whose surface is set from the keyframes
+    Apothesis* m_pApothesis;
+
+    /// The path of the event stream
+    string m_sPath;
+
+    /// The processes in the order of the stream
+    vector< MicroProcesses::Process* > m_vProcesses;
+
+    /// The species and their names indexed by their id
+    vector< Species* > m_vSpecies;
+    vector< string > m_vSpeciesNames;
+
+    /// The keyframes in the order of the stream
+    vector< Keyframe > m_vKeyframes;
+
+    /// Opens the stream
+    FILE* mf_open();
+
+    /// Replays a group of sorted times from the keyframe before the first one
+    void mf_replay( vector< double > times );
+
+    /// Sets the lattice from a keyframe. The file is positioned at its data.
+    void mf_loadKeyframe( FILE* file );
+
+    /// Writes the lattice at time
+    void mf_write( double time, long events );
+};
+
+#endif // EVENT_REPLAY_H
@@ -0,0 +1,70 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "lattice_reader.h"
+#include "errorhandler.h"
+
+#include <cmath>
+#include <cstring>
+
+LatticeReader::LatticeReader( Apothesis* apothesis, string path ):Pointers( apothesis ),
+  m_path( path ),
+  m_iNx( 0 ),
+  m_iNy( 0 ),
+  m_lAtoms( 0 )
+{;}
+
+LatticeReader::~LatticeReader(){;}
+
+void LatticeReader::mf_init( int nx, int ny )
+{
+  m_iNx = nx;
+  m_iNy = ny;
+  m_vHeights.assign( nx*ny, -1 );
+  m_vTop.assign( nx*ny, -1 );
+  m_lAtoms = 0;
+}
+
+void LatticeReader::mf_addAtom( const char* begin, const char* end, double x, double y, double z )
+{
+  long i = lround( x );
+  long j = lround( y );
+  if ( i < 0 || i >= m_iNx || j < 0 || j >= m_iNy ){
+    m_errorHandler->error_simple_msg( "Atom at (" + to_string( x ) + ", " + to_string( y ) + ") in " + m_path + " is outside the lattice." );
+    EXIT;
+  }
+
+  int id = j + i*m_iNy;
+  int h = lround( z );
+  if ( h >= m_vHeights[ id ] ){
+    m_vHeights[ id ] = h;
+    m_vTop[ id ] = mf_symbol( begin, end );
+  }
+
+  m_lAtoms++;
+}
+
+int LatticeReader::mf_symbol( const char* begin, const char* end )
+{
+  size_t len = end - begin;
+  for ( int i = 0; i < (int)m_vSymbols.size(); i++ )
+    if ( m_vSymbols[ i ].size() == len && memcmp( m_vSymbols[ i ].data(), begin, len ) == 0 )
+      return i;
+
+  m_vSymbols.push_back( string( begin, end ) );
+  return m_vSymbols.size() - 1;
+}
@@ -0,0 +1,88 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef LATTICE_READER_H
+#define LATTICE_READER_H
+
+#include <string>
+#include <vector>
+
+#include "pointers.h"
+
+using namespace std;
+
+/** The base of the readers of starting surfaces (read_lattice keyword).
+ * A reader parses the atoms of a file and keeps, for every site of an nx x ny lattice,
+ * the height of its top atom and the symbol of that atom. The atom coordinates are in lattice
+ * units: x and y are the site indices and z is the height. The site of (x, y) has the id y + x*ny
+ * (the layout of IO::writeLatticeHeights). Only the top atom of each column is kept. */
+
+class LatticeReader: public Pointers
+{
+public:
+    /// Constructor
+    LatticeReader( Apothesis* apothesis, string path );
+
+    /// Destructor
+    virtual ~LatticeReader();
+
+    /// Parses the file for a lattice of nx x ny sites.
+    virtual void read( int nx, int ny ) = 0;
+
+    /// Returns the height of a site or -1 if no atom was given for it.
+    inline int getHeight( int id ) { return m_vHeights[ id ]; }
+
+    /// Returns the index in getSymbols() of the top atom of a site or -1.
+    inline int getSymbolIndex( int id ) { return m_vTop[ id ]; }
+
+    /// Returns the symbols found in the file.
+    inline const vector< string >& getSymbols() { return m_vSymbols; }
+
+    /// Returns the number of atoms read.
+    inline long getNumAtoms() { return m_lAtoms; }
+
+protected:
+    /// The path of the file
+    string m_path;
+
+    /// The dimensions of the lattice
+    int m_iNx;
+    int m_iNy;
+
+    /// The height of the top atom of each site
+    vector< int > m_vHeights;
+
+    /// The symbol of the top atom of each site
+    vector< int > m_vTop;
+
+    /// The symbols found in the file
+    vector< string > m_vSymbols;
+
+    /// The number of atoms read
+    long m_lAtoms;
+
+    /// Allocates the per site buffers.
+    void mf_init( int nx, int ny );
+
+    /// Places an atom with symbol [begin, end) at (x, y, z).
+    void mf_addAtom( const char* begin, const char* end, double x, double y, double z );
+
+    /// Returns the index of the symbol [begin, end). A string is allocated only for a new symbol.
+    int mf_symbol( const char* begin, const char* end );
+};
+
+#endif // LATTICE_READER_H
@@ -0,0 +1,183 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "mapped_file.h"
+
+#include <cmath>
+#include <fstream>
+
+#if defined( __linux__ ) || defined( __APPLE__ )
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define APOTHESIS_MMAP
+#endif
+
+namespace Utils
+{
+
+MappedFile::MappedFile( string path ):
+  m_pData( 0 ),
+  m_size( 0 ),
+  m_bOpen( false ),
+  m_bMapped( false )
+{
+#ifdef APOTHESIS_MMAP
+  int fd = open( path.c_str(), O_RDONLY );
+  if ( fd < 0 )
+    return;
+
+  struct stat st;
+  if ( fstat( fd, &st ) == 0 ){
+    // An empty file cannot be mapped but it is open
+    m_bOpen = true;
+    if ( st.st_size > 0 ){
+      void* p = mmap( 0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if ( p != MAP_FAILED ){
+        madvise( p, st.st_size, MADV_SEQUENTIAL );
+        m_pData = (const char*)p;
+        m_size = st.st_size;
+        m_bMapped = true;
+      }
+      else
+        m_bOpen = false;
+    }
+  }
+
+  close( fd );
+  if ( m_bOpen )
+    return;
+#endif
+
+  // Fallback: read the whole file in one buffer
+  ifstream file( path, ios::in | ios::binary | ios::ate );
+  if ( !file.is_open() )
+    return;
+
+  m_size = file.tellg();
+  char* buffer = new char[ m_size + 1 ];
+  file.seekg( 0 );
+  file.read( buffer, m_size );
+  m_pData = buffer;
+  m_bOpen = true;
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef APOTHESIS_MMAP
+  if ( m_bMapped ){
+    munmap( (void*)m_pData, m_size );
+    return;
+  }
+#endif
+  delete[] m_pData;
+}
+
+void Tokenizer::skipLine()
+{
+  while ( m_pPos < m_pEnd && *m_pPos != '\n' )
+    m_pPos++;
+
+  if ( m_pPos < m_pEnd )
+    m_pPos++;
+}
+
+bool Tokenizer::nextWord( const char*& begin, const char*& end )
+{
+  skipBlanks();
+  begin = m_pPos;
+  while ( m_pPos < m_pEnd && *m_pPos != ' ' && *m_pPos != '\t' && *m_pPos != '\r' && *m_pPos != '\n' )
+    m_pPos++;
+  end = m_pPos;
+
+  return end > begin;
+}
+
+bool Tokenizer::nextNumber( double& value )
+{
+  const char* begin;
+  const char* end;
+  if ( !nextWord( begin, end ) )
+    return false;
+
+  return toNumber( begin, end, value );
+}
+
+bool Tokenizer::toNumber( const char* p, const char* end, double& value )
+{
+  bool negative = false;
+  if ( p < end && ( *p == '-' || *p == '+' ) ){
+    negative = *p == '-';
+    p++;
+  }
+
+  double mantissa = 0;
+  int digits = 0;
+  while ( p < end && *p >= '0' && *p <= '9' ){
+    mantissa = mantissa*10 + ( *p - '0' );
+    p++;
+    digits++;
+  }
+
+  int exponent = 0;
+  if ( p < end && *p == '.' ){
+    p++;
+    while ( p < end && *p >= '0' && *p <= '9' ){
+      mantissa = mantissa*10 + ( *p - '0' );
+      exponent--;
+      p++;
+      digits++;
+    }
+  }
+
+  if ( digits == 0 )
+    return false;
+
+  if ( p < end && ( *p == 'e' || *p == 'E' ) ){
+    p++;
+    bool negativeExp = false;
+    if ( p < end && ( *p == '-' || *p == '+' ) ){
+      negativeExp = *p == '-';
+      p++;
+    }
+
+    int e = 0;
+    int expDigits = 0;
+    while ( p < end && *p >= '0' && *p <= '9' ){
+      e = e*10 + ( *p - '0' );
+      p++;
+      expDigits++;
+    }
+
+    if ( expDigits == 0 )
+      return false;
+
+    exponent += negativeExp ? -e : e;
+  }
+
+  if ( p != end )
+    return false;
+
+  value = exponent == 0 ? mantissa : mantissa*pow( 10.0, exponent );
+  if ( negative )
+    value = -value;
+
+  return true;
+}
+
+}
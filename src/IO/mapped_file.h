@@ -0,0 +1,110 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+namespace Utils{
+
+/** A read only view of a whole file. On POSIX systems the file is memory mapped
+ * so the readers parse it in place without copying lines into strings.
+ * Elsewhere the file is read into a single buffer. */
+
+class MappedFile
+{
+public:
+    /// Constructor. Maps the file; isOpen() tells if this succeeded.
+    explicit MappedFile( string path );
+
+    /// Destructor. Unmaps the file.
+    virtual ~MappedFile();
+
+    /// True if the file could be opened.
+    inline bool isOpen() { return m_bOpen; }
+
+    /// The first byte of the file.
+    inline const char* begin() { return m_pData; }
+
+    /// One past the last byte of the file.
+    inline const char* end() { return m_pData + m_size; }
+
+    /// The size of the file in bytes.
+    inline size_t getSize() { return m_size; }
+
+private:
+    /// The contents of the file
+    const char* m_pData;
+
+    /// The size of the file
+    size_t m_size;
+
+    /// True if the file is open
+    bool m_bOpen;
+
+    /// True if m_pData is a mapping (false if it is a heap buffer)
+    bool m_bMapped;
+};
+
+/** A minimal tokenizer over a character range. It never allocates: words are returned
+ * as [begin, end) ranges and numbers are converted directly from the bytes. */
+
+class Tokenizer
+{
+public:
+    /// Constructor
+    Tokenizer( const char* begin, const char* end ):m_pPos( begin ), m_pEnd( end ){;}
+
+    /// True if the end of the range has been reached.
+    inline bool atEnd() { return m_pPos >= m_pEnd; }
+
+    /// The current position.
+    inline const char* getPos() { return m_pPos; }
+
+    /// Moves to position p.
+    inline void setPos( const char* p ) { m_pPos = p; }
+
+    /// Skips spaces and tabs but not the end of the line.
+    inline void skipBlanks() { while ( m_pPos < m_pEnd && ( *m_pPos == ' ' || *m_pPos == '\t' || *m_pPos == '\r' ) ) m_pPos++; }
+
+    /// Skips the rest of the current line including the newline.
+    void skipLine();
+
+    /// Returns the next word (a run of non blank characters) in the current line. Empty if none.
+    bool nextWord( const char*& begin, const char*& end );
+
+    /// Parses a number (integer, decimal or with exponent) in the current line.
+    bool nextNumber( double& value );
+
+    /// Parses a number from [begin, end). Returns false if it is not a number.
+    static bool toNumber( const char* begin, const char* end, double& value );
+
+private:
+    /// The current position
+    const char* m_pPos;
+
+    /// The end of the range
+    const char* m_pEnd;
+};
+
+}
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,171 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "metrics.h"
+#include "process.h"
+#include "lattice.h"
+#include "errorhandler.h"
+#include "trace.h"
+#include "memory_report.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+Metrics::Metrics( Apothesis* apothesis, string path, double period ):Pointers( apothesis ),
+  m_sPath( path ),
+  m_dPeriod( period ),
+  m_dEndTime( 0 ),
+  m_iter( 0 ),
+  m_time( 0 ),
+  m_bRoughnessRequest( false ),
+  m_bStop( false )
+{
+  if ( m_dPeriod <= 0 ){
+    m_errorHandler->error_simple_msg( "The period of the metrics must be positive." );
+    EXIT;
+  }
+}
+
+Metrics::~Metrics()
+{
+  if ( !m_worker.joinable() )
+    return;
+
+  {
+    lock_guard< mutex > lock( m_mutex );
+    m_bStop = true;
+  }
+  m_wake.notify_one();
+  m_worker.join();
+}
+
+void Metrics::init( vector< MicroProcesses::Process* > processes, long double endTime )
+{
+  m_vProcesses = processes;
+  m_dEndTime = (double)endTime;
+
+  m_aEvents.reset( new atomic< long >[ m_vProcesses.size() ] );
+  for ( size_t i = 0; i < m_vProcesses.size(); i++ ){
+    m_aEvents[ i ].store( 0, memory_order_relaxed );
+    m_vNames.push_back( m_vProcesses[ i ]->getName() + "_" + to_string( i ) );
+  }
+
+  // Fail now rather than silently in the side thread
+  ofstream test( m_sPath + ".tmp" );
+  if ( !test.is_open() ){
+    m_errorHandler->error_simple_msg( "Cannot open the metrics file " + m_sPath );
+    EXIT;
+  }
+  test.close();
+
+  m_worker = thread( &Metrics::mf_run, this );
+}
+
+void Metrics::mf_run()
+{
+  typedef chrono::steady_clock Clock;
+
+  Utils::Trace::setThreadName( "metrics" );
+
+  Clock::time_point last = Clock::now();
+  unsigned int lastIter = 0;
+  double lastTime = 0;
+  vector< long > lastEvents( m_vProcesses.size(), 0 );
+
+  unique_lock< mutex > lock( m_mutex );
+  while ( !m_bStop ){
+    m_wake.wait_for( lock, chrono::duration< double >( m_dPeriod ) );
+
+    Clock::time_point now = Clock::now();
+    mf_write( chrono::duration< double >( now - last ).count(), lastIter, lastTime, lastEvents );
+    last = now;
+
+    m_bRoughnessRequest.store( true, memory_order_relaxed );
+  }
+}
+
+void Metrics::mf_write( double dt, unsigned int& lastIter, double& lastTime, vector< long >& lastEvents )
+{
+  Utils::TraceScope trace( "Metrics::write" );
+
+  unsigned int iter = m_iter.load( memory_order_relaxed );
+  double time = m_time.load( memory_order_relaxed );
+
+  double eventRate = 0;
+  double timeRate = 0;
+  if ( dt > 0 ){
+    eventRate = ( iter - lastIter )/dt;
+    timeRate = ( time - lastTime )/dt;
+  }
+
+  // Unknown (-1) until the simulation time advances
+  double eta = -1;
+  if ( timeRate > 0 )
+    eta = max( m_dEndTime - time, 0.0 )/timeRate;
+
+  string tmp = m_sPath + ".tmp";
+  ofstream file( tmp );
+  if ( !file.is_open() )
+    return;
+
+  file << "# HELP apothesis_iterations KMC iterations performed.\n"
+       << "# TYPE apothesis_iterations counter\n"
+       << "apothesis_iterations " << iter << "\n"
+       << "# HELP apothesis_events_per_second KMC iterations per second of wall clock time.\n"
+       << "# TYPE apothesis_events_per_second gauge\n"
+       << "apothesis_events_per_second " << eventRate << "\n"
+       << "# HELP apothesis_simulated_seconds Simulation time reached.\n"
+       << "# TYPE apothesis_simulated_seconds gauge\n"
+       << "apothesis_simulated_seconds " << time << "\n"
+       << "# HELP apothesis_simulated_seconds_end Simulation time to be reached.\n"
+       << "# TYPE apothesis_simulated_seconds_end gauge\n"
+       << "apothesis_simulated_seconds_end " << m_dEndTime << "\n"
+       << "# HELP apothesis_simulated_seconds_per_second Simulation time advanced per second of wall clock time.\n"
+       << "# TYPE apothesis_simulated_seconds_per_second gauge\n"
+       << "apothesis_simulated_seconds_per_second " << timeRate << "\n"
+       << "# HELP apothesis_eta_seconds Estimated wall clock time to the end of the simulation. -1 if unknown.\n"
+       << "# TYPE apothesis_eta_seconds gauge\n"
+       << "apothesis_eta_seconds " << eta << "\n"
+       << "# HELP apothesis_roughness Roughness of the surface when last computed.\n"
+       << "# TYPE apothesis_roughness gauge\n"
+       << "apothesis_roughness " << m_lattice->getLastRoughness() << "\n"
+       << "# HELP apothesis_resident_bytes Resident memory of the process.\n"
+       << "# TYPE apothesis_resident_bytes gauge\n"
+       << "apothesis_resident_bytes " << Utils::MemoryReport::getResident() << "\n";
+
+  file << "# HELP apothesis_process_events Events performed by each process.\n"
+       << "# TYPE apothesis_process_events counter\n";
+  vector< long > events( m_vProcesses.size() );
+  for ( size_t i = 0; i < m_vProcesses.size(); i++ ){
+    events[ i ] = m_aEvents[ i ].load( memory_order_relaxed );
+    file << "apothesis_process_events{process=\"" << m_vNames[ i ] << "\"} " << events[ i ] << "\n";
+  }
+
+  file << "# HELP apothesis_process_events_per_second Events of each process per second of wall clock time.\n"
+       << "# TYPE apothesis_process_events_per_second gauge\n";
+  for ( size_t i = 0; i < m_vProcesses.size(); i++ )
+    file << "apothesis_process_events_per_second{process=\"" << m_vNames[ i ] << "\"} "
+         << ( dt > 0 ? ( events[ i ] - lastEvents[ i ] )/dt : 0.0 ) << "\n";
+
+  file.close();
+  rename( tmp.c_str(), m_sPath.c_str() );
+
+  lastIter = iter;
+  lastTime = time;
+  lastEvents = events;
+}
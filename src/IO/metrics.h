@@ -0,0 +1,109 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pointers.h"
+
+using namespace std;
+
+namespace MicroProcesses { class Process; }
+
+/** Live progress metrics of a running simulation in the Prometheus text format.
+ * The KMC loop only stores the iteration, the simulation time and the events of each process in
+ * relaxed atomics (it is the single writer). The roughness is the last one the lattice computed; after
+ * every write the side thread asks the loop to compute it again so that it does not go stale. A side thread wakes up every period of wall
+ * clock time, derives the events per second, the simulated seconds per wall second, the estimated
+ * time to reach the end of the simulation, the event rate of each process and the resident memory,
+ * and rewrites the file (written to <file>.tmp and renamed so that a reader never sees half of it).
+ * A scheduler can then detect stalled or too slow jobs without parsing the log. */
+
+class Metrics: public Pointers
+{
+public:
+    /// Constructor. The period is in seconds of wall clock time.
+    Metrics( Apothesis* apothesis, string path, double period );
+
+    /// Destructor. Stops the side thread and writes the last values.
+    virtual ~Metrics();
+
+    /// Starts the side thread. The processes give the per process metrics and
+    /// the end time of the simulation the estimated time of arrival.
+    void init( vector< MicroProcesses::Process* > processes, long double endTime );
+
+    /// Records an event (or the events of a leap) of the process with this index (see Process::getIndex) at the
+    /// iteration and the simulation time. Called from the KMC loop.
+    void recordEvent( int process, unsigned int iter, long double time, long events = 1 )
+    {
+      m_aEvents[ process ].store( m_aEvents[ process ].load( memory_order_relaxed ) + events, memory_order_relaxed );
+      m_iter.store( iter, memory_order_relaxed );
+      m_time.store( (double)time, memory_order_relaxed );
+    }
+
+    /// True once after every write of the side thread, which then asks the KMC loop for a new roughness
+    /// (the lattice cannot be read from the side thread while the loop changes it).
+    bool takeRoughnessRequest()
+    {
+      return m_bRoughnessRequest.load( memory_order_relaxed ) && m_bRoughnessRequest.exchange( false, memory_order_relaxed );
+    }
+
+private:
+    /// The output file
+    string m_sPath;
+
+    /// The period of the side thread [s of wall clock time]
+    double m_dPeriod;
+
+    /// The end time of the simulation [s]
+    double m_dEndTime;
+
+    /// The processes and their names
+    vector< MicroProcesses::Process* > m_vProcesses;
+    vector< string > m_vNames;
+
+    /// The values stored by the KMC loop
+    unique_ptr< atomic< long >[] > m_aEvents;
+    atomic< unsigned int > m_iter;
+    atomic< double > m_time;
+
+    /// Set by the side thread when it needs a new roughness
+    atomic< bool > m_bRoughnessRequest;
+
+    /// The side thread and its stop signal
+    thread m_worker;
+    mutex m_mutex;
+    condition_variable m_wake;
+    bool m_bStop;
+
+    /// The loop of the side thread
+    void mf_run();
+
+    /// Writes the metrics. The rates are computed over dt seconds of wall clock time
+    /// from the previous values of the iteration, the time and the events, which are then updated.
+    void mf_write( double dt, unsigned int& lastIter, double& lastTime, vector< long >& lastEvents );
+};
+
+#endif // METRICS_H
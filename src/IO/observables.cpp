@@ -0,0 +1,164 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "observables.h"
+#include "process.h"
+#include "lattice.h"
+#include "species.h"
+#include "errorhandler.h"
+#include "trace.h"
+#include "memory_report.h"
+
+#include <cmath>
+
+using namespace MicroProcesses;
+
+Observables::Observables( Apothesis* apothesis, double interval ):Pointers( apothesis ),
+  m_dInterval( interval ),
+  m_nextTime( 0 ),
+  m_lastTime( 0 ),
+  m_dLastHeight( 0 ),
+  m_lEvents( 0 ),
+  m_bMemory( false )
+{
+  if ( m_dInterval < 0 ){
+    m_errorHandler->error_simple_msg( "The sampling interval of the observables must not be negative." );
+    EXIT;
+  }
+}
+
+Observables::~Observables()
+{
+  if ( m_file.is_open() )
+    m_file.close();
+}
+
+void Observables::init( string name, map< string, Species* > species, vector< Process* > processes )
+{
+  m_bMemory = name.empty();
+  if ( !m_bMemory ){
+    m_file.open( name + ".csv", ios::out );
+    if ( !m_file.is_open() ){
+      m_errorHandler->error_simple_msg( "Cannot open file " + name + ".csv" );
+      EXIT;
+    }
+  }
+
+  m_vColumns = { "time", "events", "mean_height", "width", "roughness", "growth_rate" };
+
+  for ( map< string, Species* >::iterator itr = species.begin(); itr != species.end(); ++itr ){
+    m_vSpecies.push_back( itr->second );
+    m_vColumns.push_back( "coverage_" + itr->first );
+  }
+
+  m_vProcesses = processes;
+  for ( int i = 0; i < (int)processes.size(); i++ )
+    m_vColumns.push_back( "frequency_" + processes[ i ]->getName() + "_" + to_string( i ) );
+  m_vEvents.assign( processes.size(), 0 );
+
+  if ( !m_bMemory ){
+    for ( int c = 0; c < (int)m_vColumns.size(); c++ )
+      m_file << ( c > 0 ? "," : "" ) << m_vColumns[ c ];
+    m_file << endl;
+  }
+
+  // The initial state is the first sample
+  sample( 0 );
+}
+
+void Observables::sample( long double time )
+{
+  if ( m_dInterval == 0 )
+    return;
+
+  while ( m_nextTime <= time ){
+    mf_write( m_nextTime );
+    m_nextTime += m_dInterval;
+  }
+}
+
+void Observables::observe( long double time )
+{
+  mf_write( time );
+}
+
+void Observables::recordEvent( Process* p, long events )
+{
+  m_lEvents += events;
+  m_vEvents[ p->getIndex() ] += events;
+}
+
+void Observables::mf_write( long double time )
+{
+  Utils::TraceScope trace( "Observables::write" );
+
+  // The heights are read from the flat storage of the lattice and the occupied sites
+  // from the running counts the sites keep up to date, so a sample allocates nothing.
+  const int* heights = m_lattice->getHeights();
+  int size = m_lattice->getSize();
+
+  double sum = 0;
+  double sum2 = 0;
+  for ( int i = 0; i < size; i++ ){
+    double h = heights[ i ];
+    sum += h;
+    sum2 += h*h;
+  }
+
+  double mean = sum/size;
+  double width = sqrt( fmax( sum2/size - mean*mean, 0.0 ) );
+
+  double dt = time - m_lastTime;
+  double growth = dt > 0 ? ( mean - m_dLastHeight )/dt : 0.0;
+
+  if ( m_bMemory ){
+    double row[] = { (double)time, (double)m_lEvents, mean, width, m_lattice->getRoughness(), growth };
+    m_vRows.insert( m_vRows.end(), row, row + 6 );
+
+    for ( int j = 0; j < (int)m_vSpecies.size(); j++ )
+      m_vRows.push_back( (double)m_lattice->getSpeciesSites( m_vSpecies[ j ]->getId() )/size );
+
+    for ( int i = 0; i < (int)m_vEvents.size(); i++ ){
+      m_vRows.push_back( dt > 0 ? m_vEvents[ i ]/dt : 0.0 );
+      m_vEvents[ i ] = 0;
+    }
+  }
+  else {
+    m_file << (double)time << "," << m_lEvents << "," << mean << "," << width << ","
+           << m_lattice->getRoughness() << "," << growth;
+
+    for ( int j = 0; j < (int)m_vSpecies.size(); j++ )
+      m_file << "," << (double)m_lattice->getSpeciesSites( m_vSpecies[ j ]->getId() )/size;
+
+    for ( int i = 0; i < (int)m_vEvents.size(); i++ ){
+      m_file << "," << ( dt > 0 ? m_vEvents[ i ]/dt : 0.0 );
+      m_vEvents[ i ] = 0;
+    }
+
+    m_file << "\n";
+  }
+
+  m_lastTime = time;
+  m_dLastHeight = mean;
+}
+
+void Observables::accountMemory( Utils::MemoryReport& report )
+{
+  report.add( Utils::MemoryReport::IO, sizeof( Observables ) + Utils::MemoryReport::heap( m_vColumns ) + Utils::MemoryReport::heap( m_vRows )
+              + Utils::MemoryReport::heap( m_vSpecies ) + Utils::MemoryReport::heap( m_vProcesses )
+              + Utils::MemoryReport::heap( m_vEvents ) );
+}
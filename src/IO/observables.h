@@ -0,0 +1,108 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef OBSERVABLES_H
+#define OBSERVABLES_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "pointers.h"
+
+using namespace std;
+
+namespace MicroProcesses { class Process; }
+
+/** Observables sampled on the fly at fixed intervals of simulation time and written as one CSV row per sample:
+ * time, number of events, mean height, interface width (rms of the heights), roughness, growth rate
+ * (change of the mean height per second since the last sample), the coverage of each species
+ * (fraction of the sites that hold it) and the frequency of each process (events per second since the last sample).
+ * Post-processing then reads one row per sample instead of parsing the per event log. */
+
+class Observables: public Pointers
+{
+public:
+    /// Constructor
+    /// A zero interval writes rows only when observed by the observation scheduler.
+    Observables( Apothesis* apothesis, double interval );
+
+    /// Destructor. Closes the file.
+    virtual ~Observables();
+
+    /// Opens the file and writes the header. The columns follow the species and the processes given,
+    /// which are in the order of their index (see Process::getIndex).
+    /// Without a name the rows are kept in memory instead (embedded use, see getRows).
+    void init( string name, map< string, Species* > species, vector< MicroProcesses::Process* > processes );
+
+    /// Writes a row for every sampling time up to time. Must be called after the time
+    /// is advanced and before the event is performed so that the rows describe the state
+    /// the lattice was in at the sampling times.
+    void sample( long double time );
+
+    /// Writes a row at time. Called by the observation scheduler.
+    void observe( long double time );
+
+    /// Counts an event (or the events of a leap) of the process.
+    void recordEvent( MicroProcesses::Process* p, long events = 1 );
+
+    /// The names of the columns
+    inline const vector< string >& getColumns() { return m_vColumns; }
+
+    /// The rows kept in memory one after the other (getColumns().size() values each). Empty if written in a file.
+    inline const vector< double >& getRows() { return m_vRows; }
+
+    /// Adds the observables and the rows kept in memory to the memory report.
+    void accountMemory( Utils::MemoryReport& report );
+
+private:
+    /// The sampling interval [s]
+    double m_dInterval;
+
+    /// The next sampling time
+    long double m_nextTime;
+
+    /// The time and the mean height of the last sample
+    long double m_lastTime;
+    double m_dLastHeight;
+
+    /// The total number of events
+    long m_lEvents;
+
+    /// The output file
+    ofstream m_file;
+
+    /// The names of the columns and the rows kept in memory
+    vector< string > m_vColumns;
+    vector< double > m_vRows;
+
+    /// Keep the rows in memory instead of the file
+    bool m_bMemory;
+
+    /// The species of the coverage columns
+    vector< Species* > m_vSpecies;
+
+    /// The processes, their column and their events since the last sample
+    vector< MicroProcesses::Process* > m_vProcesses;
+    vector< long > m_vEvents;
+
+    /// Writes one row at time
+    void mf_write( long double time );
+};
+
+#endif // OBSERVABLES_H
@@ -0,0 +1,88 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "observation_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+ObservationScheduler::ObservationScheduler( Apothesis* apothesis ):Pointers( apothesis ),
+  m_nextTime( numeric_limits< long double >::infinity() ),
+  m_lFired( 0 )
+{;}
+
+ObservationScheduler::~ObservationScheduler(){;}
+
+vector< long double > ObservationScheduler::grid( string type, vector< double > values, double end )
+{
+  vector< long double > times;
+  if ( type == "linear" ){
+    // Multiples of the interval so that the round off does not accumulate
+    for ( long k = 0; (long double)k*values[ 0 ] <= end; k++ )
+      times.push_back( (long double)k*values[ 0 ] );
+  }
+  else if ( type == "log" ){
+    for ( long k = 0; ; k++ ){
+      long double t = values[ 0 ]*pow( 10.0L, (long double)k/values[ 1 ] );
+      if ( t > end )
+        break;
+      times.push_back( t );
+    }
+  }
+  else {
+    times.assign( values.begin(), values.end() );
+    sort( times.begin(), times.end() );
+  }
+
+  return times;
+}
+
+void ObservationScheduler::addObserver( vector< long double > times, function< void( long double ) > observe )
+{
+  Observer observer;
+  observer.times = times;
+  observer.next = 0;
+  observer.observe = observe;
+  m_vObservers.push_back( observer );
+
+  mf_setNextTime();
+}
+
+void ObservationScheduler::mf_fire( long double time )
+{
+  while ( m_nextTime <= time ){
+    // The observer with the earliest pending time. Ties fire in the order of registration.
+    Observer* first = 0;
+    for ( Observer& o:m_vObservers )
+      if ( o.next < o.times.size() && ( !first || o.times[ o.next ] < first->times[ first->next ] ) )
+        first = &o;
+
+    first->observe( first->times[ first->next++ ] );
+    m_lFired++;
+
+    mf_setNextTime();
+  }
+}
+
+void ObservationScheduler::mf_setNextTime()
+{
+  m_nextTime = numeric_limits< long double >::infinity();
+  for ( Observer& o:m_vObservers )
+    if ( o.next < o.times.size() )
+      m_nextTime = min( m_nextTime, o.times[ o.next ] );
+}
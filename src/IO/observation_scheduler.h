@@ -0,0 +1,80 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef OBSERVATION_SCHEDULER_H
+#define OBSERVATION_SCHEDULER_H
+
+#include <vector>
+#include <string>
+#include <functional>
+
+#include "pointers.h"
+
+using namespace std;
+
+/** Fires the registered observers (roughness, heights, coverage, morphology) at given times of the
+ * simulation clock instead of every so many events (observe <observer> <grid> <values>).
+ * The times of each observer form a linear, a logarithmic or an explicit grid. The scheduler must be
+ * advanced after the time of an event is drawn and before the event is performed, so an observer sees
+ * the lattice in the state it was at its time. An observer fires once for every time the event crosses. */
+
+class ObservationScheduler: public Pointers
+{
+public:
+    /// Constructor
+    ObservationScheduler( Apothesis* apothesis );
+
+    /// Destructor
+    virtual ~ObservationScheduler();
+
+    /// Returns the times of a grid up to end: linear <interval> (0, dt, 2dt ...), log <first time> <points per decade>
+    /// or times <t1> <t2> ... (sorted).
+    static vector< long double > grid( string type, vector< double > values, double end );
+
+    /// Registers an observer that is called with each of the given times
+    void addObserver( vector< long double > times, function< void( long double ) > observer );
+
+    /// Fires the observations up to time in the order of their times
+    inline void advance( long double time ){ if ( time >= m_nextTime ) mf_fire( time ); }
+
+    /// Returns the number of observations fired
+    inline long getNumFired(){ return m_lFired; }
+
+private:
+    /// An observer, its times and the next one to fire
+    struct Observer{
+        vector< long double > times;
+        size_t next;
+        function< void( long double ) > observe;
+    };
+
+    vector< Observer > m_vObservers;
+
+    /// The earliest pending time of all the observers
+    long double m_nextTime;
+
+    /// The number of observations fired
+    long m_lFired;
+
+    /// Fires the pending observations up to time
+    void mf_fire( long double time );
+
+    /// Finds the earliest pending time
+    void mf_setNextTime();
+};
+
+#endif // OBSERVATION_SCHEDULER_H
@@ -0,0 +1,184 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "perf_counters.h"
+
+#include <cstring>
+#include <cerrno>
+#include <sstream>
+#include <iomanip>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Utils
+{
+
+namespace
+{
+  const char* s_names[ PerfCounters::NUM_PHASES ] = { "rates", "select", "perform", "updateNeighbours", "update", "output" };
+
+  /// The file descriptors of the counters (the first one leads the group). -1 if not open.
+  int s_fds[ PerfCounters::NUM_COUNTERS ] = { -1, -1, -1, -1 };
+
+  /// The counters of the group in the order they were opened
+  vector< int > s_vOpened;
+
+  /// The counts and the measurements of each phase
+  uint64_t s_counts[ PerfCounters::NUM_PHASES ][ PerfCounters::NUM_COUNTERS ];
+  long s_calls[ PerfCounters::NUM_PHASES ];
+
+#ifdef __linux__
+  int openCounter( uint64_t config, int group )
+  {
+    perf_event_attr attr;
+    memset( &attr, 0, sizeof( attr ) );
+    attr.size = sizeof( attr );
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = group == -1 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+
+    // This thread on any CPU
+    return syscall( __NR_perf_event_open, &attr, 0, -1, group, 0 );
+  }
+#endif
+}
+
+bool PerfCounters::s_bEnabled = false;
+bool PerfCounters::s_bSampled = false;
+int PerfCounters::s_iEvery = 1;
+long PerfCounters::s_lSteps = 0;
+
+bool PerfCounters::enable( int every, string& error )
+{
+#ifdef __linux__
+  uint64_t configs[ NUM_COUNTERS ] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                       PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+  s_fds[ CYCLES ] = openCounter( configs[ CYCLES ], -1 );
+  if ( s_fds[ CYCLES ] < 0 ){
+    error = strerror( errno );
+    return false;
+  }
+  s_vOpened.push_back( CYCLES );
+
+  // A counter that the hardware lacks is left out of the group
+  for ( int c = INSTRUCTIONS; c < NUM_COUNTERS; c++ ){
+    s_fds[ c ] = openCounter( configs[ c ], s_fds[ CYCLES ] );
+    if ( s_fds[ c ] >= 0 )
+      s_vOpened.push_back( c );
+  }
+
+  memset( s_counts, 0, sizeof( s_counts ) );
+  memset( s_calls, 0, sizeof( s_calls ) );
+
+  ioctl( s_fds[ CYCLES ], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP );
+  ioctl( s_fds[ CYCLES ], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP );
+
+  s_iEvery = every > 0 ? every : 1;
+  s_bEnabled = true;
+  return true;
+#else
+  error = "perf_event_open is only available on Linux";
+  return false;
+#endif
+}
+
+void PerfCounters::disable()
+{
+#ifdef __linux__
+  for ( int c = 0; c < NUM_COUNTERS; c++ ){
+    if ( s_fds[ c ] >= 0 )
+      close( s_fds[ c ] );
+    s_fds[ c ] = -1;
+  }
+#endif
+  s_vOpened.clear();
+  s_bEnabled = false;
+}
+
+void PerfCounters::read( uint64_t values[ NUM_COUNTERS ] )
+{
+  memset( values, 0, NUM_COUNTERS*sizeof( uint64_t ) );
+
+#ifdef __linux__
+  // PERF_FORMAT_GROUP: the number of counters and then their values in the order they were opened
+  uint64_t buffer[ 1 + NUM_COUNTERS ];
+  if ( ::read( s_fds[ CYCLES ], buffer, sizeof( buffer ) ) <= 0 )
+    return;
+
+  for ( int i = 0; i < (int)buffer[ 0 ] && i < (int)s_vOpened.size(); i++ )
+    values[ s_vOpened[ i ] ] = buffer[ 1 + i ];
+#endif
+}
+
+void PerfCounters::add( PHASE phase, const uint64_t begin[ NUM_COUNTERS ], const uint64_t end[ NUM_COUNTERS ] )
+{
+  for ( int c = 0; c < NUM_COUNTERS; c++ )
+    s_counts[ phase ][ c ] += end[ c ] - begin[ c ];
+  s_calls[ phase ]++;
+}
+
+vector< string > PerfCounters::report()
+{
+  vector< string > lines;
+
+  ostringstream header;
+  header << "Performance counters in one step in every " << s_iEvery << " (phases are inclusive):";
+  lines.push_back( header.str() );
+  lines.push_back( "phase calls cycles/call instructions/call IPC cache_misses/kinstr branch_misses/kinstr" );
+
+  bool opened[ NUM_COUNTERS ] = { false, false, false, false };
+  for ( int c : s_vOpened )
+    opened[ c ] = true;
+
+  for ( int p = 0; p < NUM_PHASES; p++ ){
+    if ( s_calls[ p ] == 0 )
+      continue;
+
+    double calls = s_calls[ p ];
+    double cycles = s_counts[ p ][ CYCLES ];
+    double instructions = s_counts[ p ][ INSTRUCTIONS ];
+
+    ostringstream line;
+    line << fixed << setprecision( 2 ) << s_names[ p ] << " " << s_calls[ p ] << " " << cycles/calls << " ";
+    if ( opened[ INSTRUCTIONS ] )
+      line << instructions/calls << " " << ( cycles > 0 ? instructions/cycles : 0.0 ) << " ";
+    else
+      line << "n/a n/a ";
+
+    for ( int c = CACHE_MISSES; c <= BRANCH_MISSES; c++ ){
+      if ( opened[ c ] && opened[ INSTRUCTIONS ] && instructions > 0 )
+        line << 1000.0*s_counts[ p ][ c ]/instructions;
+      else
+        line << "n/a";
+      line << ( c < BRANCH_MISSES ? " " : "" );
+    }
+    lines.push_back( line.str() );
+  }
+
+  return lines;
+}
+
+}
@@ -0,0 +1,107 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace Utils {
+
+/** Hardware performance counters of the phases of the KMC steps (perf_counters [every], Linux only).
+ * The cycles, the instructions, the cache misses and the branch misses of the KMC thread are opened as one
+ * perf_event_open group and read with a single system call when a PerfScope begins and ends. Reading costs
+ * about a microsecond, so the phases are measured in one step in every (sample() decides once per step);
+ * the ratios (instructions per cycle, misses per thousand instructions) do not depend on it. The phases
+ * may nest (updateNeighbours is part of perform) and their counts are inclusive. If the counters cannot be
+ * opened (no PMU, perf_event_paranoid, not Linux) enable returns false and every scope does nothing. */
+
+class PerfCounters
+{
+public:
+    /// The measured phases
+    enum PHASE{ RATES, SELECT, PERFORM, NEIGHBOURS, UPDATE, OUTPUT, NUM_PHASES };
+
+    /// The counters of the group
+    enum COUNTER{ CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, NUM_COUNTERS };
+
+    /// Opens the counters of the calling thread. Returns false with the reason if they are not available.
+    static bool enable( int every, string& error );
+
+    /// Closes the counters
+    static void disable();
+
+    /// Returns true if the counters are open
+    static inline bool isEnabled(){ return s_bEnabled; }
+
+    /// A new step: decides whether its phases are measured
+    static inline void sample(){ s_bSampled = s_lSteps++ % s_iEvery == 0; }
+
+    /// Returns true if the phases of the current step are measured
+    static inline bool isSampled(){ return s_bSampled; }
+
+    /// Reads the counters of the group (zero for those that could not be opened)
+    static void read( uint64_t values[ NUM_COUNTERS ] );
+
+    /// Adds the counts between begin and end to a phase
+    static void add( PHASE phase, const uint64_t begin[ NUM_COUNTERS ], const uint64_t end[ NUM_COUNTERS ] );
+
+    /// The lines of the report of the phases
+    static vector< string > report();
+
+private:
+    static bool s_bEnabled;
+    static bool s_bSampled;
+    static int s_iEvery;
+    static long s_lSteps;
+};
+
+/// Measures a phase from its construction to the end of its scope in the sampled steps.
+class PerfScope
+{
+public:
+    PerfScope( PerfCounters::PHASE phase ) : m_phase( phase ), m_bActive( PerfCounters::isEnabled() && PerfCounters::isSampled() )
+    {
+      if ( m_bActive )
+        PerfCounters::read( m_begin );
+    }
+
+    ~PerfScope()
+    {
+      if ( m_bActive ){
+        uint64_t end[ PerfCounters::NUM_COUNTERS ];
+        PerfCounters::read( end );
+        PerfCounters::add( m_phase, m_begin, end );
+      }
+    }
+
+    PerfScope( const PerfScope& ) = delete;
+    PerfScope& operator=( const PerfScope& ) = delete;
+
+private:
+    PerfCounters::PHASE m_phase;
+    bool m_bActive;
+    uint64_t m_begin[ PerfCounters::NUM_COUNTERS ];
+};
+
+}
+
+#endif // PERF_COUNTERS_H
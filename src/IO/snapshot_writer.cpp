@@ -0,0 +1,190 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "snapshot_writer.h"
+#include "lattice.h"
+#include "site.h"
+#include "errorhandler.h"
+#include "trace.h"
+#include "memory_report.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <algorithm>
+#include <sstream>
+
+SnapshotWriter::SnapshotWriter( Apothesis* apothesis ):Pointers( apothesis ),
+  m_iNext( 0 ),
+  m_pFile( 0 ),
+  m_bStop( false )
+{
+  for ( Buffer& b : m_buffers )
+    b.full = false;
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+  if ( m_worker.joinable() ){
+    {
+      lock_guard< mutex > lock( m_mutex );
+      m_bStop = true;
+    }
+    m_full.notify_one();
+    m_worker.join();
+  }
+
+  if ( m_pFile ){
+#ifdef HAVE_ZLIB
+    gzclose( (gzFile)m_pFile );
+#else
+    fclose( (FILE*)m_pFile );
+#endif
+  }
+}
+
+void SnapshotWriter::init( string path, vector< string > species )
+{
+  m_vSpecies = species;
+
+#ifdef HAVE_ZLIB
+  path += ".gz";
+  m_pFile = gzopen( path.c_str(), "wb" );
+#else
+  m_pFile = fopen( path.c_str(), "w" );
+#endif
+  if ( !m_pFile ){
+    m_errorHandler->error_simple_msg( "Cannot open the snapshot file " + path );
+    EXIT;
+  }
+
+  int size = m_lattice->getSize();
+  for ( Buffer& b : m_buffers ){
+    b.heights.resize( size );
+    b.counts.resize( size*m_vSpecies.size() );
+  }
+
+  m_worker = thread( &SnapshotWriter::mf_run, this );
+}
+
+void SnapshotWriter::snapshot( long double time, unsigned int iter )
+{
+  Utils::TraceScope trace( "SnapshotWriter::snapshot" );
+
+  Buffer& b = m_buffers[ m_iNext ];
+
+  // Back-pressure: wait until the writer is done with this buffer
+  {
+    unique_lock< mutex > lock( m_mutex );
+    m_free.wait( lock, [ &b ]{ return !b.full; } );
+  }
+
+  b.time = (double)time;
+  b.iter = iter;
+
+  int size = m_lattice->getSize();
+  int numSpecies = m_vSpecies.size();
+  fill( b.counts.begin(), b.counts.end(), 0 );
+  for ( int i = 0; i < size; i++ ){
+    Site* s = m_lattice->getSite( i );
+    b.heights[ i ] = s->getHeight();
+    for ( int k = 0; k < s->getNumSpecies(); k++ )
+      b.counts[ i*numSpecies + s->getSpeciesAt( k )->getId() ]++;
+  }
+
+  {
+    lock_guard< mutex > lock( m_mutex );
+    b.full = true;
+  }
+  m_full.notify_one();
+
+  m_iNext = 1 - m_iNext;
+}
+
+void SnapshotWriter::mf_run()
+{
+  Utils::Trace::setThreadName( "snapshots" );
+
+  int current = 0;
+  while ( true ){
+    Buffer& b = m_buffers[ current ];
+    {
+      unique_lock< mutex > lock( m_mutex );
+      m_full.wait( lock, [ this, &b ]{ return b.full || m_bStop; } );
+      // The pending buffers are written before stopping
+      if ( !b.full )
+        return;
+    }
+
+    mf_write( b );
+
+    {
+      lock_guard< mutex > lock( m_mutex );
+      b.full = false;
+    }
+    m_free.notify_one();
+
+    current = 1 - current;
+  }
+}
+
+void SnapshotWriter::mf_write( Buffer& buffer )
+{
+  Utils::TraceScope trace( "SnapshotWriter::write" );
+
+  int nx = m_lattice->getX();
+  int ny = m_lattice->getY();
+  int numSpecies = m_vSpecies.size();
+
+  ostringstream out;
+  out << " --------------------------------------- \n";
+  out << "Time: " << buffer.time << " Iterations: " << buffer.iter << "\n";
+  for ( int i = 0; i < nx; i++ ){
+    for ( int j = 0; j < ny; j++ ){
+      int index = j + i*ny;
+      out << "( " << buffer.heights[ index ] << ", [ ";
+      for ( int k = 0; k < numSpecies; k++ )
+        for ( int n = 0; n < buffer.counts[ index*numSpecies + k ]; n++ )
+          out << m_vSpecies[ k ] << " ";
+      out << "] ) ";
+    }
+    out << "\n";
+  }
+  out << " --------------------------------------- \n";
+
+  string text = out.str();
+
+#ifdef HAVE_ZLIB
+  gzwrite( (gzFile)m_pFile, text.data(), text.size() );
+#else
+  fwrite( text.data(), 1, text.size(), (FILE*)m_pFile );
+#endif
+}
+
+void SnapshotWriter::accountMemory( Utils::MemoryReport& report )
+{
+  size_t bytes = sizeof( SnapshotWriter ) + Utils::MemoryReport::heap( m_vSpecies );
+  for ( Buffer& b : m_buffers )
+    bytes += Utils::MemoryReport::heap( b.heights ) + Utils::MemoryReport::heap( b.counts );
+  report.add( Utils::MemoryReport::IO, bytes );
+}
+
+void SnapshotWriter::estimateMemory( Utils::MemoryReport& report, long sites, int species )
+{
+  report.add( Utils::MemoryReport::IO, sizeof( SnapshotWriter ) + 2*( Utils::MemoryReport::block( sites*sizeof( int ) ) + Utils::MemoryReport::block( sites*species*sizeof( int ) ) ) );
+}
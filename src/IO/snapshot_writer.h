@@ -0,0 +1,97 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef SNAPSHOT_WRITER_H
+#define SNAPSHOT_WRITER_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pointers.h"
+
+using namespace std;
+
+/** Asynchronous snapshots of the lattice (snapshots keyword).
+ * The KMC loop only copies the heights and the species counts of the sites into one of two
+ * preallocated buffers and hands it to a writer thread, which formats it (the layout of
+ * IO::writeLatticeHeights with the species of each site in the brackets), compresses it
+ * (gzip if Apothesis is built with zlib) and writes it while the simulation continues.
+ * If the writer falls behind and both buffers are full the KMC loop waits for one of them. */
+
+class SnapshotWriter: public Pointers
+{
+public:
+    /// Constructor
+    SnapshotWriter( Apothesis* apothesis );
+
+    /// Destructor. Writes the pending snapshots and closes the file.
+    virtual ~SnapshotWriter();
+
+    /// Opens the file, allocates the buffers and starts the writer. The names of the species are indexed by their id.
+    void init( string path, vector< string > species );
+
+    /// Copies the lattice and queues it for writing.
+    void snapshot( long double time, unsigned int iter );
+
+    /// Adds the writer and its two buffers to the memory report.
+    void accountMemory( Utils::MemoryReport& report );
+
+    /// Adds the projection of the writer for a lattice with sites sites and species species to the memory report.
+    static void estimateMemory( Utils::MemoryReport& report, long sites, int species );
+
+private:
+    /// A copy of the lattice
+    struct Buffer
+    {
+        double time;
+        unsigned int iter;
+        vector< int > heights;
+        /// The count of each species on each site (site*species + id)
+        vector< int > counts;
+        /// True from the copy until it is written
+        bool full;
+    };
+
+    /// The two buffers and the next one to fill
+    Buffer m_buffers[ 2 ];
+    int m_iNext;
+
+    /// The names of the species
+    vector< string > m_vSpecies;
+
+    /// The output file: a gzFile if built with zlib, a FILE otherwise
+    void* m_pFile;
+
+    /// The writer thread and its signals
+    thread m_worker;
+    mutex m_mutex;
+    condition_variable m_full;
+    condition_variable m_free;
+    bool m_bStop;
+
+    /// The loop of the writer thread. Writes the buffers in the order they are filled.
+    void mf_run();
+
+    /// Formats a buffer and writes it to the file
+    void mf_write( Buffer& buffer );
+};
+
+#endif // SNAPSHOT_WRITER_H
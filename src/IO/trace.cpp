@@ -0,0 +1,205 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "trace.h"
+#include "memory_report.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Utils
+{
+
+namespace
+{
+  /// A phase of a thread
+  struct Event
+  {
+    const char* name;
+    long begin;
+    long duration;
+  };
+
+  /// The buffers of a thread: the ring of the sampled events and the events that are always recorded.
+  /// Only its thread writes them; the counts are published after the event.
+  struct Buffer
+  {
+    int id;
+    string name;
+    vector< Event > events;
+    atomic< long > count;
+    vector< Event > always;
+    atomic< long > alwaysCount;
+  };
+
+  typedef chrono::steady_clock Clock;
+
+  string s_sPath;
+  int s_iEvery = 1;
+  Clock::time_point s_start;
+
+  /// The buffers of all the threads that recorded. They outlive their threads.
+  mutex s_mutex;
+  vector< unique_ptr< Buffer > > s_vBuffers;
+
+  thread_local Buffer* t_pBuffer = 0;
+  thread_local long t_lSteps = 0;
+  thread_local bool t_bSampled = false;
+
+  Buffer* threadBuffer()
+  {
+    if ( !t_pBuffer ){
+      lock_guard< mutex > lock( s_mutex );
+      s_vBuffers.push_back( unique_ptr< Buffer >( new Buffer() ) );
+      t_pBuffer = s_vBuffers.back().get();
+      t_pBuffer->id = s_vBuffers.size() - 1;
+      t_pBuffer->name = "thread " + to_string( t_pBuffer->id );
+      t_pBuffer->count.store( 0, memory_order_relaxed );
+      t_pBuffer->alwaysCount.store( 0, memory_order_relaxed );
+    }
+    return t_pBuffer;
+  }
+
+  /// Escapes a string for JSON
+  string escape( const string& s )
+  {
+    string out;
+    for ( char c : s ){
+      if ( c == '"' || c == '\\' )
+        out += '\\';
+      out += c;
+    }
+    return out;
+  }
+
+  /// Writes a complete event of the thread with this id
+  void writeEvent( ofstream& file, int id, const Event& e )
+  {
+    file << ",\n{\"name\":\"" << escape( e.name ) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << id
+         << ",\"ts\":" << e.begin/1000.0 << ",\"dur\":" << e.duration/1000.0 << "}";
+  }
+}
+
+bool Trace::s_bEnabled = false;
+
+void Trace::enable( string path, int every )
+{
+  s_sPath = path;
+  s_iEvery = every > 0 ? every : 1;
+  s_start = Clock::now();
+  s_bEnabled = true;
+
+  setThreadName( "kmc" );
+}
+
+void Trace::sample()
+{
+  t_bSampled = t_lSteps++ % s_iEvery == 0;
+}
+
+bool Trace::isSampled()
+{
+  return t_bSampled;
+}
+
+void Trace::setThreadName( string name )
+{
+  if ( !s_bEnabled )
+    return;
+
+  Buffer* b = threadBuffer();
+  lock_guard< mutex > lock( s_mutex );
+  b->name = name;
+}
+
+void Trace::record( const char* name, long begin, long end, MODE mode )
+{
+  Buffer* b = threadBuffer();
+  Event e = { name, begin, end - begin };
+
+  if ( mode == Always ){
+    b->always.push_back( e );
+    b->alwaysCount.store( b->always.size(), memory_order_release );
+    return;
+  }
+
+  long n = b->count.load( memory_order_relaxed );
+  if ( n < CAPACITY )
+    b->events.push_back( e );
+  else
+    b->events[ n % CAPACITY ] = e;
+
+  b->count.store( n + 1, memory_order_release );
+}
+
+void Trace::accountMemory( MemoryReport& report )
+{
+  // The ring only grows to its capacity, so the sizes of both follow from the published counts
+  lock_guard< mutex > lock( s_mutex );
+  for ( unique_ptr< Buffer >& b : s_vBuffers ){
+    long n = b->count.load( memory_order_acquire );
+    long always = b->alwaysCount.load( memory_order_acquire );
+    report.add( MemoryReport::IO, MemoryReport::block( sizeof( Buffer ) ) + MemoryReport::block( MemoryReport::capacity( n < CAPACITY ? n : CAPACITY )*sizeof( Event ) )
+                + MemoryReport::block( MemoryReport::capacity( always )*sizeof( Event ) ) );
+  }
+}
+
+long Trace::now()
+{
+  return chrono::duration_cast< chrono::nanoseconds >( Clock::now() - s_start ).count();
+}
+
+void Trace::write()
+{
+  ofstream file( s_sPath );
+  if ( !file.is_open() ){
+    cout << "Cannot open the trace file " << s_sPath << endl;
+    return;
+  }
+
+  lock_guard< mutex > lock( s_mutex );
+
+  // Microseconds with the nanoseconds as decimals
+  file << fixed << setprecision( 3 );
+  file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+  bool first = true;
+  for ( unique_ptr< Buffer >& b : s_vBuffers ){
+    file << ( first ? "" : ",\n" ) << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->id
+         << ",\"args\":{\"name\":\"" << escape( b->name ) << "\"}}";
+    first = false;
+
+    long always = b->alwaysCount.load( memory_order_acquire );
+    for ( long k = 0; k < always; k++ )
+      writeEvent( file, b->id, b->always[ k ] );
+
+    // The oldest event first: a full ring starts at the slot that is overwritten next
+    long n = b->count.load( memory_order_acquire );
+    long size = n < CAPACITY ? n : CAPACITY;
+    long start = n < CAPACITY ? 0 : n % CAPACITY;
+    for ( long k = 0; k < size; k++ )
+      writeEvent( file, b->id, b->events[ ( start + k ) % CAPACITY ] );
+  }
+  file << "\n]}\n";
+}
+
+}
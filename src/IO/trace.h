@@ -0,0 +1,112 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+
+using namespace std;
+
+namespace Utils {
+
+class MemoryReport;
+
+/** A timeline of the phases of a run in the Chrome trace format (chrome://tracing or ui.perfetto.dev),
+ * enabled with --trace <file> [every]. A phase is a TraceScope: when it ends its begin and duration are stored
+ * in the buffers of the thread that ran it. Every thread owns its buffers so recording takes no lock; only
+ * the first event of a thread registers them. The phases of the KMC steps are recorded for one step in every
+ * (sample() decides once per step) in a ring that overwrites its oldest events when full. The rest are recorded
+ * always in a buffer that is never overwritten, so that the initialization and the output stay in the timeline
+ * of a long run. The file is written by write() at the end of the run. */
+
+class Trace
+{
+public:
+    /// Which scopes are recorded: always or only in the sampled steps
+    enum MODE{ Always, Sampled };
+
+    /// The sampled events kept per thread
+    static const long CAPACITY = 1 << 16;
+
+    /// Start the timeline. The phases of one step in every are recorded.
+    static void enable( string path, int every );
+
+    /// Returns true if the timeline is recorded
+    static inline bool isEnabled(){ return s_bEnabled; }
+
+    /// A new step of the calling thread: decides whether its Sampled scopes are recorded
+    static void sample();
+
+    /// Returns true if the current step of the calling thread is sampled
+    static bool isSampled();
+
+    /// The name of the calling thread in the timeline
+    static void setThreadName( string name );
+
+    /// Stores a phase of the calling thread. The name must outlive the trace (a literal).
+    static void record( const char* name, long begin, long end, MODE mode = Always );
+
+    /// The time since enable [ns]
+    static long now();
+
+    /// Writes the events of all the threads. Called once the other threads are done.
+    static void write();
+
+    /// Adds the buffers of the threads to the memory report.
+    static void accountMemory( MemoryReport& report );
+
+private:
+    /// Set once by enable before the other threads start
+    static bool s_bEnabled;
+};
+
+/// Records the phase from its construction to the end of its scope in the timeline of the thread.
+class TraceScope
+{
+public:
+    TraceScope( const char* name, Trace::MODE mode = Trace::Always ) : m_sName( 0 ), m_lBegin( 0 ), m_mode( mode )
+    {
+      if ( Trace::isEnabled() && ( mode == Trace::Always || Trace::isSampled() ) ){
+        m_sName = name;
+        m_lBegin = Trace::now();
+      }
+    }
+
+    ~TraceScope()
+    {
+      if ( m_sName )
+        Trace::record( m_sName, m_lBegin, Trace::now(), m_mode );
+    }
+
+    TraceScope( const TraceScope& ) = delete;
+    TraceScope& operator=( const TraceScope& ) = delete;
+
+private:
+    /// The name of the phase. Null if it is not recorded.
+    const char* m_sName;
+
+    /// The begin of the phase [ns]
+    long m_lBegin;
+
+    /// The buffer of the phase
+    Trace::MODE m_mode;
+};
+
+}
+
+#endif // TRACE_H
@@ -1,7 +1,11 @@
 #include "txt_reader.h"
+#include "arena.h"
+#include "trace.h"
+#include <sstream>
 
-TxtReader::TxtReader(Apothesis *apothesis, string inputPath): Pointers(apothesis),
+TxtReader::TxtReader(Apothesis *apothesis, string inputPath, SOURCE source): Pointers(apothesis),
                                        m_inputPath(inputPath),
+                                       m_source(source),
                                        m_sBuildKey("build_lattice"),
                                        m_sReadKey("read_lattice"),
                                        m_sStepKey("steps"),
@@ -10,8 +14,33 @@ TxtReader::TxtReader(Apothesis *apothesis, string inputPath): Pointers(apothesis
                                        m_sPressureKey("pressure"),
                                        m_sTemperatureKey("temperature"),
                                        m_sTimeKey("time"),
+                                       m_sEngineKey("engine"),
+                                       m_sBoundaryLayerKey("boundary_layer"),
+                                       m_sObservablesKey("observables"),
+                                       m_sEventLogKey("event_log"),
+                                       m_sMorphologyKey("morphology"),
+                                       m_sTopologyCacheKey("topology_cache"),
+                                       m_sVoxelLatticeKey("voxel_lattice"),
+                                       m_sLateralKey("lateral"),
+                                       m_sMetricsKey("metrics"),
+                                       m_sSnapshotsKey("snapshots"),
+                                       m_sTauLeapingKey("tau_leaping"),
+                                       m_sObserveKey("observe"),
+                                       m_sEventStreamKey("event_stream"),
+                                       m_sPerfCountersKey("perf_counters"),
+                                       m_sPluginKey("plugin"),
                                        m_ssiteKey("*"),
-                                       m_sCommentLine("#")
+                                       m_sCommentLine("#"),
+                                       m_sEngine("bkl"),
+                                       m_dObservablesInterval(0),
+                                       m_bEventLog(true),
+                                       m_dMorphologyInterval(0),
+                                       m_bVoxelLattice(false),
+                                       m_dMetricsPeriod(0),
+                                       m_dTauLeaping(0),
+                                       m_lKeyframeInterval(100000),
+                                       m_iPerfCounters(0),
+                                       m_bSteps(false)
 {
     //Initialize the map for the lattice
     m_apothesis=apothesis;
@@ -21,9 +50,20 @@ TxtReader::TxtReader(Apothesis *apothesis, string inputPath): Pointers(apothesis
 }
 
 void TxtReader::parseFile(){
+    Utils::TraceScope trace("TxtReader::parseFile");
 
-    openInputFile(m_inputPath);
-    vector<string> fLines=inputFileLines();
+    vector<string> fLines;
+    if (m_source == Text)
+    {
+        // The input is given in memory (embedded use)
+        istringstream input(m_inputPath);
+        fLines=inputLines(input);
+    }
+    else
+    {
+        openInputFile(m_inputPath);
+        fLines=inputFileLines();
+    }
 
     for(int i=0; i < fLines.size(); ++i) {
         string currentLine;
@@ -39,8 +79,14 @@ void TxtReader::parseFile(){
         }
         if (vsTokens[0].compare(m_sReadKey) == 0)
         {
-            //Cml reader constructor
-            //xyz reader constructor
+            // The surface is read after the lattice is built (see Apothesis::init).
+            // The type and the dimensions still come from build_lattice.
+            if (vsTokens.size() < 2 || !exists(vsTokens[1]))
+            {
+              m_errorHandler->error_simple_msg("Could not find the file given in read_lattice.");
+              EXIT;
+            }
+            m_sLatticeFile=vsTokens[1];
         }
 
         if(vsTokens[0].compare(m_sNSpeciesKey)==0){
@@ -87,6 +133,81 @@ void TxtReader::parseFile(){
             m_fsetDebugMode(vsTokens[1]);
         }
 
+        if (vsTokens[0].compare(m_sEngineKey) == 0)
+        {
+            m_fsetEngine(vsTokens[1]);
+        }
+
+        if (vsTokens[0].compare(m_sBoundaryLayerKey) == 0)
+        {
+            m_fsetBoundaryLayer(vsTokens);
+        }
+
+        if (vsTokens[0].compare(m_sObservablesKey) == 0)
+        {
+            m_fsetObservables(vsTokens[1]);
+        }
+
+        if (vsTokens[0].compare(m_sEventLogKey) == 0)
+        {
+            m_fsetEventLog(vsTokens[1]);
+        }
+
+        if (vsTokens[0].compare(m_sMorphologyKey) == 0)
+        {
+            m_fsetMorphology(vsTokens[1]);
+        }
+
+        if (vsTokens[0].compare(m_sTopologyCacheKey) == 0)
+        {
+            m_fsetTopologyCache(vsTokens[1]);
+        }
+
+        if (vsTokens[0].compare(m_sVoxelLatticeKey) == 0)
+        {
+            m_fsetVoxelLattice(vsTokens[1]);
+        }
+
+        if (vsTokens[0].compare(m_sLateralKey) == 0)
+        {
+            m_faddLateral(vsTokens);
+        }
+
+        if (vsTokens[0].compare(m_sMetricsKey) == 0)
+        {
+            m_fsetMetrics(vsTokens);
+        }
+
+        if (vsTokens[0].compare(m_sSnapshotsKey) == 0)
+        {
+            m_fsetSnapshots(vsTokens);
+        }
+
+        if (vsTokens[0].compare(m_sTauLeapingKey) == 0)
+        {
+            m_fsetTauLeaping(vsTokens[1]);
+        }
+
+        if (vsTokens[0].compare(m_sObserveKey) == 0)
+        {
+            m_faddObservation(vsTokens);
+        }
+
+        if (vsTokens[0].compare(m_sEventStreamKey) == 0)
+        {
+            m_fsetEventStream(vsTokens);
+        }
+
+        if (vsTokens[0].compare(m_sPerfCountersKey) == 0)
+        {
+            m_fsetPerfCounters(vsTokens);
+        }
+
+        if (vsTokens[0].compare(m_sPluginKey) == 0)
+        {
+            m_faddPlugin(vsTokens);
+        }
+
     }
 
     initializeLattice();
@@ -110,12 +231,12 @@ void TxtReader::initializeLattice(){
     {
       if (m_bSteps)
       {
-        FCC *lattice = new FCC(m_apothesis, true, m_vSteps);
+        FCC *lattice = m_arena->create<FCC>(m_apothesis, true, m_vSteps);
         m_apothesis->pLattice = lattice;
       }
       else
       {
-        FCC *lattice = new FCC(m_apothesis);
+        FCC *lattice = m_arena->create<FCC>(m_apothesis);
         m_apothesis->pLattice = lattice;
         m_lattice->setType("FCC");
         break;
@@ -126,13 +247,13 @@ void TxtReader::initializeLattice(){
     {
       if (m_bSteps)
       {
-        BCC *lattice = new BCC(m_apothesis, true, m_vSteps);
+        BCC *lattice = m_arena->create<BCC>(m_apothesis, true, m_vSteps);
         m_apothesis->pLattice = lattice;
 
       }
       else
       {
-        BCC *lattice = new BCC(m_apothesis);
+        BCC *lattice = m_arena->create<BCC>(m_apothesis);
         m_apothesis->pLattice = lattice;
       }
       m_lattice->setType("BCC");
@@ -156,11 +277,16 @@ void TxtReader::initializeLattice(){
 }
 
 vector<string> TxtReader::inputFileLines()
+{
+  return inputLines(m_inputFile);
+}
+
+vector<string> TxtReader::inputLines(istream &input)
 {
 
   string line;
   vector<string> lines;
-  while (getline(m_inputFile, line))
+  while (getline(input, line))
   {
 
     // Remove any tabs, weird spaces etc.
@@ -277,8 +403,12 @@ void TxtReader::m_fidentifyProcess(string processKey, int id){
     vector<double> energetics= m_fprocEnergetics(process[1]);
     vector<double> stoichiometry;
 
+    // A term placed on a neighbour (e.g. B*@E) makes this a multi-site reaction
     string procName;
-    if(m_bisAdsorption(reactants)){
+    if(contains(process[0],"@")){
+        procName="Reaction"+to_string(id);
+        m_mProcTerms.insert({procName,{reactants,products}});
+    }else if(m_bisAdsorption(reactants)){
         procName="Adsorption"+to_string(id);
     }else if(m_bisDesorption(products)){
         procName="Desorption"+to_string(id);
@@ -287,9 +417,39 @@ void TxtReader::m_fidentifyProcess(string processKey, int id){
     }else{
         procName="Reaction"+to_string(id);
         stoichiometry=m_fprocStoichiometry(reactants,products);
+        m_mProcTerms.insert({procName,{reactants,products}});
 
     }
     m_fsetProcInfo(procName,species,energetics,stoichiometry);
+
+    // Optional settings follow the energetics: ..., simple <values>[, deposit][, rate <expression>]
+    // The rate law comes last as its expression may hold commas (e.g. min(a, b)).
+    size_t first = processKey.find(",");
+    size_t second = first == string::npos ? string::npos : processKey.find(",", first + 1);
+    while (second != string::npos){
+        string option = processKey.substr(second + 1);
+        option.erase(0, option.find_first_not_of(" \t"));
+
+        size_t next = processKey.find(",", second + 1);
+        string word = processKey.substr(second + 1, next == string::npos ? string::npos : next - second - 1);
+        word.erase(0, word.find_first_not_of(" \t"));
+        word.erase(word.find_last_not_of(" \t\r") + 1);
+
+        if (word == "deposit"){
+            m_sProcDeposits.insert(procName);
+            second = next;
+        }
+        else if (option.compare(0, 4, "rate") == 0){
+            option.erase(0, 4);
+            option.erase(0, option.find_first_not_of(" \t"));
+            m_mProcRates[procName] = option;
+            break;
+        }
+        else{
+            m_errorHandler->error_simple_msg("Could not read the settings of " + process[0] + ". Is it , deposit or , rate <expression>?");
+            EXIT;
+        }
+    }
 }
 
 void TxtReader::m_fsetProcInfo(string procName, vector<string> species, vector<double> energetics, vector<double> stoichiometry){
@@ -480,6 +640,255 @@ void TxtReader::m_fsetDebugMode(string debugMode){
     }
 }
 
+void TxtReader::m_fsetEngine(string engine){
+    if (contains(engine,"bkl", Insensitive) || contains(engine,"nrm", Insensitive) || contains(engine,"tree", Insensitive))
+    {
+      m_sEngine=engine;
+      cout << "Engine: "<< engine<< endl;
+    }
+    else
+    {
+      m_errorHandler->error_simple_msg("Could not read engine. Supported engines are bkl, nrm and tree.");
+      EXIT;
+    }
+}
+
+void TxtReader::m_fsetBoundaryLayer(vector<string> vsTokens){
+    if (vsTokens.size() >= 5 && isNumber(vsTokens[1]) && isNumber(vsTokens[2]) && isNumber(vsTokens[3]) && isNumber(vsTokens[4]))
+    {
+      // The molecular weight of the carrier gas [g/mol] is optional (N2 by default)
+      double carrier = 28.0134;
+      if (vsTokens.size() >= 6)
+      {
+        if (!isNumber(vsTokens[5]) || toDouble(vsTokens[5]) <= 0)
+        {
+          m_errorHandler->error_simple_msg("Could not read boundary layer. The carrier gas molecular weight must be a positive number.");
+          EXIT;
+        }
+        carrier = toDouble(vsTokens[5]);
+      }
+
+      m_vBoundaryLayer={toDouble(vsTokens[1]), toDouble(vsTokens[2]), toDouble(vsTokens[3]), toDouble(vsTokens[4]), carrier};
+      cout << "Boundary layer: "<< vsTokens[1] << " m, " << vsTokens[2] << " nodes, "
+           << vsTokens[3] << " m2/s, coupling every " << vsTokens[4] << " s, carrier gas " << carrier << " g/mol" << endl;
+    }
+    else
+    {
+      m_errorHandler->error_simple_msg("Could not read boundary layer. Usage: boundary_layer thickness nodes diffusivity interval [carrier molecular weight]");
+      EXIT;
+    }
+}
+
+void TxtReader::m_fsetObservables(string interval){
+    if (isNumber(interval) && toDouble(interval) > 0)
+    {
+      m_dObservablesInterval=toDouble(interval);
+      cout << "Observables every "<< interval << " s" << endl;
+    }
+    else
+    {
+      m_errorHandler->error_simple_msg("Could not read the sampling interval of the observables. Is it a positive number?");
+      EXIT;
+    }
+}
+
+void TxtReader::m_fsetEventLog(string eventLog){
+    if (contains(eventLog,"on", Insensitive) || contains(eventLog,"off", Insensitive))
+    {
+      m_bEventLog=contains(eventLog,"on", Insensitive);
+      cout << "Event log: "<< eventLog << endl;
+    }
+    else
+    {
+      m_errorHandler->error_simple_msg("Could not read event log. Is it On or Off?");
+      EXIT;
+    }
+}
+
+void TxtReader::m_fsetMorphology(string interval){
+    if (isNumber(interval) && toDouble(interval) > 0)
+    {
+      m_dMorphologyInterval=toDouble(interval);
+      cout << "Morphology every "<< interval << " s" << endl;
+    }
+    else
+    {
+      m_errorHandler->error_simple_msg("Could not read the sampling interval of the morphology. Is it a positive number?");
+      EXIT;
+    }
+}
+
+void TxtReader::m_fsetTopologyCache(string directory){
+    if (exists(directory))
+    {
+      m_sTopologyCache=directory;
+      cout << "Lattice topology cache: "<< directory << endl;
+    }
+    else
+    {
+      m_errorHandler->error_simple_msg("Could not find the directory of the lattice topology cache.");
+      EXIT;
+    }
+}
+
+void TxtReader::m_fsetVoxelLattice(string voxelLattice){
+    if (contains(voxelLattice,"on", Insensitive) || contains(voxelLattice,"off", Insensitive))
+    {
+      m_bVoxelLattice=contains(voxelLattice,"on", Insensitive);
+      cout << "Voxel lattice: "<< voxelLattice << endl;
+    }
+    else
+    {
+      m_errorHandler->error_simple_msg("Could not read voxel lattice. Is it On or Off?");
+      EXIT;
+    }
+}
+
+void TxtReader::m_faddLateral(vector<string> tokens){
+    if (tokens.size() >= 4 && isNumber(tokens[3]))
+    {
+      m_vLateral.push_back(make_tuple(tokens[1], tokens[2], toDouble(tokens[3])));
+      cout << "Lateral interaction "<< tokens[1] << "-" << tokens[2] << ": " << tokens[3] << " J/mol" << endl;
+    }
+    else
+    {
+      m_errorHandler->error_simple_msg("Could not read the lateral interaction. Is it lateral <species> <species> <energy>?");
+      EXIT;
+    }
+}
+
+void TxtReader::m_fsetMetrics(vector<string> tokens){
+    // The period is optional (10 s by default)
+    if (tokens.size() == 2 || (tokens.size() >= 3 && isNumber(tokens[2]) && toDouble(tokens[2]) > 0))
+    {
+      m_sMetricsFile=tokens[1];
+      m_dMetricsPeriod=tokens.size() >= 3 ? toDouble(tokens[2]) : 10;
+      cout << "Metrics: "<< m_sMetricsFile << " every " << m_dMetricsPeriod << " s" << endl;
+    }
+    else
+    {
+      m_errorHandler->error_simple_msg("Could not read the metrics. Is it metrics <file> <period>?");
+      EXIT;
+    }
+}
+
+void TxtReader::m_fsetSnapshots(vector<string> tokens){
+    if (tokens.size() >= 2)
+    {
+      m_sSnapshotsFile=tokens[1];
+      cout << "Snapshots: "<< m_sSnapshotsFile << endl;
+    }
+    else
+    {
+      m_errorHandler->error_simple_msg("Could not read the snapshots. Is it snapshots <file>?");
+      EXIT;
+    }
+}
+
+void TxtReader::m_fsetTauLeaping(string epsilon){
+    if (isNumber(epsilon) && toDouble(epsilon) > 0 && toDouble(epsilon) < 1)
+    {
+      m_dTauLeaping=toDouble(epsilon);
+      cout << "Tau leaping with tolerance "<< epsilon << endl;
+    }
+    else
+    {
+      m_errorHandler->error_simple_msg("Could not read the tolerance of the tau leaping. Is it a number between 0 and 1?");
+      EXIT;
+    }
+}
+
+void TxtReader::m_faddObservation(vector<string> tokens){
+    vector<string> observers = {"roughness", "heights", "coverage", "morphology"};
+    if (tokens.size() < 4 || find(observers.begin(), observers.end(), tokens[1]) == observers.end())
+    {
+      m_errorHandler->error_simple_msg("Could not read the observation. Is it observe <roughness|heights|coverage|morphology> <linear|log|times> <values>?");
+      EXIT;
+    }
+
+    vector<double> values;
+    for (int i = 3; i < (int)tokens.size(); i++)
+    {
+      if (!isNumber(tokens[i]) || toDouble(tokens[i]) < 0)
+      {
+        m_errorHandler->error_simple_msg("Could not read the times of the observation. Are they non negative numbers?");
+        EXIT;
+      }
+      values.push_back(toDouble(tokens[i]));
+    }
+
+    // linear <interval>, log <first time> <points per decade> or times <t1> <t2> ...
+    bool valid = false;
+    if (tokens[2].compare("linear") == 0)
+      valid = values.size() == 1 && values[0] > 0;
+    else if (tokens[2].compare("log") == 0)
+      valid = values.size() == 2 && values[0] > 0 && values[1] > 0;
+    else if (tokens[2].compare("times") == 0)
+      valid = true;
+
+    if (!valid)
+    {
+      m_errorHandler->error_simple_msg("Could not read the grid of the observation. Is it linear <interval>, log <first time> <points per decade> or times <t1> <t2> ...?");
+      EXIT;
+    }
+
+    m_vObservations.push_back(make_tuple(tokens[1], tokens[2], values));
+    cout << "Observe "<< tokens[1] << " on a " << tokens[2] << " grid" << endl;
+}
+
+void TxtReader::m_fsetEventStream(vector<string> tokens){
+    // The keyframe interval is optional (100000 events by default)
+    if (tokens.size() == 2 || (tokens.size() >= 3 && isNumber(tokens[2]) && toInt(tokens[2]) > 0))
+    {
+      m_sEventStreamFile=tokens[1];
+      if (tokens.size() >= 3)
+        m_lKeyframeInterval=toInt(tokens[2]);
+      cout << "Event stream: "<< m_sEventStreamFile << " with a keyframe every " << m_lKeyframeInterval << " events" << endl;
+    }
+    else
+    {
+      m_errorHandler->error_simple_msg("Could not read the event stream. Is it event_stream <file> [keyframe interval]?");
+      EXIT;
+    }
+}
+
+void TxtReader::m_fsetPerfCounters(vector<string> tokens){
+    // The counters are read in one step in every 100 by default
+    if (tokens.size() == 1 || (isNumber(tokens[1]) && toInt(tokens[1]) > 0))
+    {
+      m_iPerfCounters = tokens.size() == 1 ? 100 : toInt(tokens[1]);
+      cout << "Performance counters in one step in every " << m_iPerfCounters << endl;
+    }
+    else
+    {
+      m_errorHandler->error_simple_msg("Could not read the performance counters. Is it perf_counters [every]?");
+      EXIT;
+    }
+}
+
+void TxtReader::m_faddPlugin(vector<string> tokens){
+    // The name of the process in the factory and its numeric parameters
+    if (tokens.size() < 2)
+    {
+      m_errorHandler->error_simple_msg("Could not read the plugin. Is it plugin <name> [parameters]?");
+      EXIT;
+    }
+
+    vector<double> parameters;
+    for (size_t i = 2; i < tokens.size(); i++)
+    {
+      if (!isNumber(tokens[i]))
+      {
+        m_errorHandler->error_simple_msg("The parameters of the plugin " + tokens[1] + " must be numbers.");
+        EXIT;
+      }
+      parameters.push_back(toDouble(tokens[i]));
+    }
+
+    m_vPlugins.push_back(make_pair(tokens[1], parameters));
+    cout << "Plugin process " << tokens[1] << " with " << parameters.size() << " parameters" << endl;
+}
+
 string TxtReader::simplified(string str)
 {
   string s;
@@ -717,6 +1126,83 @@ string TxtReader::getDebugMode(){
     return m_sDebugMode;
 }
 
+string TxtReader::getEngine(){
+    return m_sEngine;
+}
+
+vector<double> TxtReader::getBoundaryLayer(){
+    return m_vBoundaryLayer;
+}
+
+double TxtReader::getObservablesInterval(){
+    return m_dObservablesInterval;
+}
+
+bool TxtReader::getEventLog(){
+    return m_bEventLog;
+}
+
+double TxtReader::getMorphologyInterval(){
+    return m_dMorphologyInterval;
+}
+
+string TxtReader::getLatticeFile(){
+    return m_sLatticeFile;
+}
+
+string TxtReader::getTopologyCache(){
+    return m_sTopologyCache;
+}
+
+bool TxtReader::getVoxelLattice(){
+    return m_bVoxelLattice;
+}
+
+vector<tuple<string,string,double>> TxtReader::getLateralInteractions(){
+    return m_vLateral;
+}
+
+string TxtReader::getMetricsFile(){
+    return m_sMetricsFile;
+}
+
+double TxtReader::getMetricsPeriod(){
+    return m_dMetricsPeriod;
+}
+
+string TxtReader::getSnapshotsFile(){
+    return m_sSnapshotsFile;
+}
+
+double TxtReader::getTauLeaping(){
+    return m_dTauLeaping;
+}
+
+vector<tuple<string,string,vector<double>>> TxtReader::getObservations(){
+    return m_vObservations;
+}
+
+string TxtReader::getEventStreamFile(){
+    return m_sEventStreamFile;
+}
+
+long TxtReader::getKeyframeInterval(){
+    return m_lKeyframeInterval;
+}
+
+int TxtReader::getPerfCounters(){
+    return m_iPerfCounters;
+}
+
+vector<pair<string,vector<double>>> TxtReader::getPlugins(){
+    return m_vPlugins;
+}
+
+bool TxtReader::exists(const string& s){
+    ifstream file(s);
+    return file.good();
+}
+
 map<string,double> TxtReader::getSpecies(){
     return m_mSpecies;
 }
@@ -735,3 +1221,15 @@ map<string,vector<double>> TxtReader::getProcStoichiometry(){
     return m_mProcStoichiometry;
 }
 
+map<string,pair<vector<string>,vector<string>>> TxtReader::getProcTerms(){
+    return m_mProcTerms;
+}
+
+map<string,string> TxtReader::getProcRates(){
+    return m_mProcRates;
+}
+
+set<string> TxtReader::getProcDeposits(){
+    return m_sProcDeposits;
+}
+
@@ -7,7 +7,9 @@
 #include <string>
 #include <fstream>
 #include <map>
+#include <set>
 #include <algorithm>
+#include <tuple>
 
 #include "lattice.h"
 #include "FCC.h"
@@ -27,8 +29,11 @@ class TxtReader: public Pointers
 public:
     enum CASE{ Sensitive, Insensitive };
 
+    /// Where the input comes from: a file or the text of the input itself (embedded use).
+    enum SOURCE{ File, Text };
+
     TxtReader();
-    explicit TxtReader(Apothesis *apothesis, string inputPath);
+    explicit TxtReader(Apothesis *apothesis, string inputPath, SOURCE source = File);
     void parseFile();
 
     /// Opens the input file.
@@ -37,6 +42,9 @@ public:
     /// Returns input file lines without empty lines and comments.
     vector<string> inputFileLines();
 
+    /// Returns the lines of a stream without empty lines and comments.
+    vector<string> inputLines(istream &);
+
     /// Converts a string to double.
     double toDouble(string);
 
@@ -90,6 +98,60 @@ public:
     ///retunrs simulation debug mode
     string getDebugMode();
 
+    /// Returns the KMC engine (bkl, nrm or tree)
+    string getEngine();
+
+    /// Returns the boundary layer thickness, nodes, diffusivity, coupling interval and carrier gas molecular weight. Empty if not given.
+    vector<double> getBoundaryLayer();
+
+    /// Returns the sampling interval of the observables. Zero if not given.
+    double getObservablesInterval();
+
+    /// Returns false if the per event log is disabled
+    bool getEventLog();
+
+    /// Returns the sampling interval of the morphology analysis. Zero if not given.
+    double getMorphologyInterval();
+
+    /// Returns the file of the starting surface (xyz or cml). Empty if not given.
+    string getLatticeFile();
+
+    /// Returns the directory of the lattice topology cache. Empty if not given.
+    string getTopologyCache();
+
+    /// Returns true if the 3D occupancy (voxel) mode is enabled
+    bool getVoxelLattice();
+
+    /// Returns the lateral interactions: two species and their energy [J/mol]
+    vector<tuple<string,string,double>> getLateralInteractions();
+
+    /// Returns the file of the live metrics. Empty if not given.
+    string getMetricsFile();
+
+    /// Returns the period of the live metrics [s of wall clock time]
+    double getMetricsPeriod();
+
+    /// Returns the file of the asynchronous lattice snapshots. Empty if not given.
+    string getSnapshotsFile();
+
+    /// Returns the error tolerance of the tau leaping of the adsorptions. Zero if not given (exact steps only).
+    double getTauLeaping();
+
+    /// Returns the observations in simulation time: the observer, the grid (linear, log or times) and its values
+    vector<tuple<string,string,vector<double>>> getObservations();
+
+    /// Returns the file of the event stream. Empty if not given.
+    string getEventStreamFile();
+
+    /// Returns the number of events between two keyframes of the event stream
+    long getKeyframeInterval();
+
+    /// Returns the steps per measurement of the performance counters. Zero if not given.
+    int getPerfCounters();
+
+    /// Returns the processes created by the factory: their name and numeric parameters
+    vector<pair<string,vector<double>>> getPlugins();
+
     /// Returns species map species name and mw
     map<string,double> getSpecies();
 
@@ -102,6 +164,15 @@ public:
     /// Returns map of stoichiometry of process
     map<string,vector<double>> getProcStoichiometry();
 
+    /// Returns map of the reactant and product terms of the reactions
+    map<string,pair<vector<string>,vector<string>>> getProcTerms();
+
+    /// Returns map of the rate laws of the processes that give one
+    map<string,string> getProcRates();
+
+    /// Returns the processes declared as depositing (, deposit)
+    set<string> getProcDeposits();
+
 protected:
     /// Supported lattice types
     map< string, Lattice::Type> m_LatticeType;
@@ -110,9 +181,12 @@ protected:
     void initializeLattice();
 
 private:
-    ///Path of input.kmc
+    ///Path of input.kmc (or the input itself if its source is Text)
     string m_inputPath;
 
+    /// The source of the input
+    SOURCE m_source;
+
     ///Filestream for input.kmc
     ifstream m_inputFile;
 
@@ -144,6 +218,51 @@ private:
     ///  Debug mode keyword.
     string m_sDebugKey;
 
+    ///  KMC engine keyword.
+    string m_sEngineKey;
+
+    ///  Gas phase boundary layer keyword.
+    string m_sBoundaryLayerKey;
+
+    ///  Observables keyword.
+    string m_sObservablesKey;
+
+    ///  Per event log keyword.
+    string m_sEventLogKey;
+
+    ///  Morphology analysis keyword.
+    string m_sMorphologyKey;
+
+    ///  Lattice topology cache keyword.
+    string m_sTopologyCacheKey;
+
+    ///  Voxel lattice keyword.
+    string m_sVoxelLatticeKey;
+
+    ///  Lateral interaction keyword.
+    string m_sLateralKey;
+
+    ///  Live metrics keyword.
+    string m_sMetricsKey;
+
+    ///  Lattice snapshots keyword.
+    string m_sSnapshotsKey;
+
+    ///  Tau leaping keyword.
+    string m_sTauLeapingKey;
+
+    ///  Observation keyword.
+    string m_sObserveKey;
+
+    ///  Event stream keyword.
+    string m_sEventStreamKey;
+
+    ///  Performance counters keyword.
+    string m_sPerfCountersKey;
+
+    ///  Plugin process keyword.
+    string m_sPluginKey;
+
     /// Reaction site key
     string m_ssiteKey;
 
@@ -163,6 +282,56 @@ private:
     /// Debug mode
     string m_sDebugMode;
 
+    /// KMC engine: bkl (default), nrm for the next reaction method or tree for the hierarchical BKL selection
+    string m_sEngine;
+
+    /// Boundary layer: thickness [m], nodes, diffusivity [m2/s], coupling interval [s], carrier gas molecular weight [g/mol]
+    vector<double> m_vBoundaryLayer;
+
+    /// Sampling interval of the observables [s]
+    double m_dObservablesInterval;
+
+    /// Per event log
+    bool m_bEventLog;
+
+    /// Sampling interval of the morphology analysis [s]
+    double m_dMorphologyInterval;
+
+    /// The file of the starting surface
+    string m_sLatticeFile;
+
+    /// The directory of the lattice topology cache
+    string m_sTopologyCache;
+
+    /// 3D occupancy (voxel) mode
+    bool m_bVoxelLattice;
+
+    /// Lateral interactions
+    vector<tuple<string,string,double>> m_vLateral;
+
+    /// The file and the period [s] of the live metrics
+    string m_sMetricsFile;
+    double m_dMetricsPeriod;
+
+    /// The file of the lattice snapshots
+    string m_sSnapshotsFile;
+
+    /// The error tolerance of the tau leaping
+    double m_dTauLeaping;
+
+    /// The observations in simulation time
+    vector<tuple<string,string,vector<double>>> m_vObservations;
+
+    /// The file of the event stream and the events between two keyframes
+    string m_sEventStreamFile;
+    long m_lKeyframeInterval;
+
+    /// The performance counters are read in one step in every m_iPerfCounters
+    int m_iPerfCounters;
+
+    /// The processes created by the factory
+    vector<pair<string,vector<double>>> m_vPlugins;
+
     /// Species representation in a map species name key and mw as value
     map<string,double> m_mSpecies;
 
@@ -170,6 +339,9 @@ private:
     map<string,vector<string>> m_mProcSpecies;
     map<string,vector<double>> m_mProcEnergetics;
     map<string,vector<double>> m_mProcStoichiometry;
+    map<string,pair<vector<string>,vector<string>>> m_mProcTerms;
+    map<string,string> m_mProcRates;
+    set<string> m_sProcDeposits;
 
     /// Lattice
     /// The type of lattice
@@ -208,6 +380,51 @@ private:
     /// Set debug mode
     void m_fsetDebugMode(string);
 
+    /// Set the KMC engine
+    void m_fsetEngine(string);
+
+    /// Set the boundary layer
+    void m_fsetBoundaryLayer(vector<string>);
+
+    /// Set the sampling interval of the observables
+    void m_fsetObservables(string);
+
+    /// Set the per event log
+    void m_fsetEventLog(string);
+
+    /// Set the sampling interval of the morphology analysis
+    void m_fsetMorphology(string);
+
+    /// Set the directory of the lattice topology cache
+    void m_fsetTopologyCache(string);
+
+    /// Set the 3D occupancy (voxel) mode
+    void m_fsetVoxelLattice(string);
+
+    /// Add a lateral interaction
+    void m_faddLateral(vector<string>);
+
+    /// Set the file and the period of the live metrics
+    void m_fsetMetrics(vector<string>);
+
+    /// Set the file of the lattice snapshots
+    void m_fsetSnapshots(vector<string>);
+
+    /// Set the error tolerance of the tau leaping
+    void m_fsetTauLeaping(string);
+
+    /// Add an observation in simulation time
+    void m_faddObservation(vector<string>);
+
+    /// Set the file and the keyframe interval of the event stream
+    void m_fsetEventStream(vector<string>);
+
+    /// Set the steps per measurement of the performance counters
+    void m_fsetPerfCounters(vector<string>);
+
+    /// Add a process created by the factory
+    void m_faddPlugin(vector<string>);
+
     /// Get left part of process keyword and identify the type of process
     void m_fidentifyProcess(string,int);
 
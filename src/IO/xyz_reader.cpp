@@ -1,3 +1,58 @@
 #include "xyz_reader.h"
+#include "mapped_file.h"
+#include "errorhandler.h"
 
-XyzReader::XyzReader(string xyzPath){}
+using namespace Utils;
+
+XyzReader::XyzReader(Apothesis* apothesis, string xyzPath):LatticeReader(apothesis, xyzPath){}
+
+void XyzReader::read(int nx, int ny)
+{
+    MappedFile file(m_path);
+    if (!file.isOpen())
+    {
+      m_errorHandler->error_simple_msg("Cannot open file " + m_path);
+      EXIT;
+    }
+
+    mf_init(nx, ny);
+
+    Tokenizer tok(file.begin(), file.end());
+
+    double atoms = 0;
+    if (!tok.nextNumber(atoms))
+    {
+      m_errorHandler->error_simple_msg("The first line of " + m_path + " must be the number of atoms.");
+      EXIT;
+    }
+
+    // The rest of the first line and the comment line
+    tok.skipLine();
+    tok.skipLine();
+
+    const char* symbolBegin;
+    const char* symbolEnd;
+    double x, y, z;
+    for (long n = 0; n < (long)atoms && !tok.atEnd(); n++)
+    {
+      if (!tok.nextWord(symbolBegin, symbolEnd))
+      {
+        // Empty line
+        tok.skipLine();
+        n--;
+        continue;
+      }
+
+      if (!tok.nextNumber(x) || !tok.nextNumber(y) || !tok.nextNumber(z))
+      {
+        m_errorHandler->error_simple_msg("Could not read the coordinates of atom " + to_string(n + 1) + " in " + m_path);
+        EXIT;
+      }
+
+      mf_addAtom(symbolBegin, symbolEnd, x, y, z);
+      tok.skipLine();
+    }
+
+    if (m_lAtoms != (long)atoms)
+      m_errorHandler->warningSimple_msg("Expected " + to_string((long)atoms) + " atoms in " + m_path + " but found " + to_string(m_lAtoms));
+}
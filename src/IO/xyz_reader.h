@@ -5,15 +5,20 @@
 #include <iostream>
 #include <string>
 
+#include "lattice_reader.h"
+
 using namespace std;
 
-class XyzReader
-{
-public:
-    explicit XyzReader(string xyzPath);
+/** Reads a starting surface in xyz format:
+ * the number of atoms, a comment line and then one "symbol x y z" line per atom. */
 
+class XyzReader: public LatticeReader
+{
 public:
+    explicit XyzReader(Apothesis* apothesis, string xyzPath);
 
+    /// Parses the file for a lattice of nx x ny sites.
+    void read(int nx, int ny);
 };
 
 #endif // XYZREADER_H
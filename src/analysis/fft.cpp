@@ -0,0 +1,183 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "fft.h"
+
+#include <cmath>
+
+namespace Utils
+{
+
+/// Iterative radix-2 transform. n must be a power of two.
+static void radix2( vector< complex< double > >& data, bool inverse )
+{
+  int n = data.size();
+  double sign = inverse ? 1.0 : -1.0;
+
+  // Bit reversal permutation
+  for ( int i = 1, j = 0; i < n; i++ ){
+    int bit = n >> 1;
+    for ( ; j & bit; bit >>= 1 )
+      j ^= bit;
+    j ^= bit;
+    if ( i < j )
+      swap( data[ i ], data[ j ] );
+  }
+
+  for ( int len = 2; len <= n; len <<= 1 ){
+    complex< double > w = polar( 1.0, sign*2.0*M_PI/len );
+    for ( int i = 0; i < n; i += len ){
+      complex< double > wk( 1, 0 );
+      for ( int j = 0; j < len/2; j++ ){
+        complex< double > u = data[ i + j ];
+        complex< double > v = data[ i + j + len/2 ]*wk;
+        data[ i + j ] = u + v;
+        data[ i + j + len/2 ] = u - v;
+        wk *= w;
+      }
+    }
+  }
+}
+
+/// Bluestein transform of any length. With jk = ( j^2 + k^2 - (k - j)^2 )/2 the DFT becomes
+/// X_k = w_k sum_j ( x_j w_j ) conj( w_(k-j) ) with the chirp w_k = exp( sign i pi k^2/n ),
+/// a convolution that is done with radix-2 transforms of length m >= 2n - 1.
+static void bluestein( vector< complex< double > >& data, bool inverse )
+{
+  int n = data.size();
+  double sign = inverse ? 1.0 : -1.0;
+
+  int m = 1;
+  while ( m < 2*n - 1 )
+    m <<= 1;
+
+  // k^2 is reduced modulo 2n to keep the phase accurate for large k
+  vector< complex< double > > chirp( n );
+  for ( int k = 0; k < n; k++ )
+    chirp[ k ] = polar( 1.0, sign*M_PI*( (long)k*k % ( 2L*n ) )/n );
+
+  vector< complex< double > > a( m, 0.0 ), b( m, 0.0 );
+  for ( int k = 0; k < n; k++ )
+    a[ k ] = data[ k ]*chirp[ k ];
+
+  // The kernel is even so negative lags wrap to the end of the buffer
+  b[ 0 ] = conj( chirp[ 0 ] );
+  for ( int k = 1; k < n; k++ )
+    b[ k ] = b[ m - k ] = conj( chirp[ k ] );
+
+  radix2( a, false );
+  radix2( b, false );
+  for ( int k = 0; k < m; k++ )
+    a[ k ] *= b[ k ];
+  radix2( a, true );
+
+  for ( int k = 0; k < n; k++ )
+    data[ k ] = chirp[ k ]*a[ k ]/(double)m;
+}
+
+void fft( vector< complex< double > >& data, bool inverse )
+{
+  int n = data.size();
+  if ( n <= 1 )
+    return;
+
+  if ( n & ( n - 1 ) )
+    bluestein( data, inverse );
+  else
+    radix2( data, inverse );
+}
+
+vector< complex< double > > rfft2( const vector< double >& data, int nx, int ny )
+{
+  int nh = ny/2 + 1;
+  vector< complex< double > > spectrum( nx*nh );
+
+  // Rows: two real rows x and y are transformed at once as z = x + iy. As X and Y are hermitian
+  // X_k = ( Z_k + conj( Z_n-k ) )/2 and Y_k = ( Z_k - conj( Z_n-k ) )/2i. Only the non redundant half is kept.
+  vector< complex< double > > row( ny );
+  for ( int i = 0; i < nx; i += 2 ){
+    bool pair = i + 1 < nx;
+    for ( int j = 0; j < ny; j++ )
+      row[ j ] = complex< double >( data[ i*ny + j ], pair ? data[ ( i + 1 )*ny + j ]:0.0 );
+    fft( row );
+    for ( int j = 0; j < nh; j++ ){
+      complex< double > z = row[ j ];
+      complex< double > w = conj( row[ ( ny - j ) % ny ] );
+      spectrum[ i*nh + j ] = 0.5*( z + w );
+      if ( pair )
+        spectrum[ ( i + 1 )*nh + j ] = complex< double >( 0, -0.5 )*( z - w );
+    }
+  }
+
+  // Columns: complex transform of the half spectrum
+  vector< complex< double > > col( nx );
+  for ( int j = 0; j < nh; j++ ){
+    for ( int i = 0; i < nx; i++ )
+      col[ i ] = spectrum[ i*nh + j ];
+    fft( col );
+    for ( int i = 0; i < nx; i++ )
+      spectrum[ i*nh + j ] = col[ i ];
+  }
+
+  return spectrum;
+}
+
+vector< double > irfft2( const vector< complex< double > >& spectrum, int nx, int ny )
+{
+  int nh = ny/2 + 1;
+  vector< complex< double > > half( spectrum );
+
+  // Columns first
+  vector< complex< double > > col( nx );
+  for ( int j = 0; j < nh; j++ ){
+    for ( int i = 0; i < nx; i++ )
+      col[ i ] = half[ i*nh + j ];
+    fft( col, true );
+    for ( int i = 0; i < nx; i++ )
+      half[ i*nh + j ] = col[ i ];
+  }
+
+  // Rows: rebuild the redundant half from the hermitian symmetry of a real signal. Two rows X and Y
+  // are inverted at once as Z = X + iY, whose inverse has the first row in the real part and the second
+  // in the imaginary part. The terms at 0 and n/2 are their own mirror and must be real for this.
+  vector< double > data( nx*ny );
+  vector< complex< double > > row( ny );
+  for ( int i = 0; i < nx; i += 2 ){
+    bool pair = i + 1 < nx;
+    for ( int j = 0; j < ny; j++ ){
+      complex< double > x = j < nh ? half[ i*nh + j ]:conj( half[ i*nh + ny - j ] );
+      complex< double > y = 0;
+      if ( pair )
+        y = j < nh ? half[ ( i + 1 )*nh + j ]:conj( half[ ( i + 1 )*nh + ny - j ] );
+      if ( j == 0 || 2*j == ny ){
+        x = x.real();
+        y = y.real();
+      }
+      row[ j ] = x + complex< double >( 0, 1 )*y;
+    }
+    fft( row, true );
+    for ( int j = 0; j < ny; j++ ){
+      data[ i*ny + j ] = row[ j ].real()/( (double)nx*ny );
+      if ( pair )
+        data[ ( i + 1 )*ny + j ] = row[ j ].imag()/( (double)nx*ny );
+    }
+  }
+
+  return data;
+}
+
+}
@@ -0,0 +1,47 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef FFT_H
+#define FFT_H
+
+#include <vector>
+#include <complex>
+
+using namespace std;
+
+namespace Utils{
+
+/** Discrete Fourier transforms of the height field.
+ * Lengths that are powers of two use the iterative radix-2 FFT. The rest use the Bluestein
+ * chirp-z algorithm, which writes the DFT as a convolution done with radix-2 FFTs of a padded
+ * power of two length, so every length costs O(n log n) and gives the exact DFT (no windowing). */
+
+/// In place complex transform. The inverse is not normalized.
+void fft( vector< complex< double > >& data, bool inverse = false );
+
+/// Real to complex 2D transform of a row major nx x ny buffer.
+/// Returns the nx x (ny/2 + 1) non redundant half of the spectrum (row major).
+/// Two real rows are transformed with one complex FFT of length ny.
+vector< complex< double > > rfft2( const vector< double >& data, int nx, int ny );
+
+/// Complex to real 2D inverse of rfft2. The result is normalized.
+/// Two real rows are rebuilt with one complex FFT of length ny.
+vector< double > irfft2( const vector< complex< double > >& spectrum, int nx, int ny );
+
+}
+
+#endif // FFT_H
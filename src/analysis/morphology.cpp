@@ -0,0 +1,184 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "morphology.h"
+#include "fft.h"
+#include "lattice.h"
+#include "site.h"
+#include "errorhandler.h"
+#include "trace.h"
+
+#include <cmath>
+#include <algorithm>
+
+Morphology::Morphology( Apothesis* apothesis, double interval ):Pointers( apothesis ),
+  m_dInterval( interval ),
+  m_nextTime( 0 )
+{
+  if ( m_dInterval < 0 ){
+    m_errorHandler->error_simple_msg( "The sampling interval of the morphology must not be negative." );
+    EXIT;
+  }
+}
+
+Morphology::~Morphology()
+{
+  if ( m_worker.joinable() )
+    m_worker.join();
+
+  if ( m_summary.is_open() )
+    m_summary.close();
+
+  if ( m_psd.is_open() )
+    m_psd.close();
+
+  if ( m_hhc.is_open() )
+    m_hhc.close();
+}
+
+void Morphology::init( string name )
+{
+  m_summary.open( name + ".csv", ios::out );
+  m_psd.open( name + "-psd.csv", ios::out );
+  m_hhc.open( name + "-hhc.csv", ios::out );
+  if ( !m_summary.is_open() || !m_psd.is_open() || !m_hhc.is_open() ){
+    m_errorHandler->error_simple_msg( "Cannot open the files of " + name );
+    EXIT;
+  }
+
+  m_summary << "time,mean_height,width,correlation_length\n";
+  m_psd << "time,k,psd\n";
+  m_hhc << "time,r,hhc\n";
+
+  sample( 0 );
+}
+
+void Morphology::sample( long double time )
+{
+  if ( m_dInterval == 0 || m_nextTime > time )
+    return;
+
+  mf_snapshot( m_nextTime );
+
+  // One snapshot even if the event crosses more than one sampling time
+  while ( m_nextTime <= time )
+    m_nextTime += m_dInterval;
+}
+
+void Morphology::observe( long double time )
+{
+  mf_snapshot( time );
+}
+
+void Morphology::mf_snapshot( long double time )
+{
+  int nx = m_lattice->getX();
+  int ny = m_lattice->getY();
+
+  // Same layout as IO::writeLatticeHeights
+  vector< double > heights( nx*ny );
+  for ( int i = 0; i < nx*ny; i++ )
+    heights[ i ] = m_lattice->getSite( i )->getHeight();
+
+  // Back-pressure: wait for the previous analysis
+  if ( m_worker.joinable() )
+    m_worker.join();
+
+  m_worker = thread( &Morphology::mf_analyse, this, std::move( heights ), nx, ny, (double)time );
+}
+
+void Morphology::mf_analyse( vector< double > heights, int nx, int ny, double time )
+{
+  Utils::Trace::setThreadName( "morphology" );
+  Utils::TraceScope trace( "Morphology::analyse" );
+
+  int size = nx*ny;
+
+  double mean = 0;
+  for ( int i = 0; i < size; i++ )
+    mean += heights[ i ];
+  mean /= size;
+
+  for ( int i = 0; i < size; i++ )
+    heights[ i ] -= mean;
+
+  vector< complex< double > > spectrum = Utils::rfft2( heights, nx, ny );
+
+  // Power spectrum |H(k)|^2/N. Its inverse transform is the autocorrelation C(dx, dy).
+  int nh = ny/2 + 1;
+  vector< complex< double > > power( spectrum.size() );
+  for ( int i = 0; i < (int)spectrum.size(); i++ )
+    power[ i ] = norm( spectrum[ i ] )/size;
+
+  vector< double > corr = Utils::irfft2( power, nx, ny );
+
+  // Radial bins of |r| in sites and of the physical wavenumber |q| = sqrt( (kx/nx)^2 + (ky/ny)^2 )
+  // in a common step dq = 1/L with L the longest side, so that nx != ny are averaged on the same rings
+  int l = max( nx, ny );
+  double dqx = (double)l/nx, dqy = (double)l/ny;
+  int rBins = (int)( sqrt( (double)( nx/2 )*( nx/2 ) + ( ny/2 )*( ny/2 ) ) + 0.5 ) + 1;
+  int kBins = (int)( sqrt( ( nx/2 )*dqx*( nx/2 )*dqx + ( ny/2 )*dqy*( ny/2 )*dqy ) + 0.5 ) + 1;
+  vector< double > psd( kBins, 0.0 ), psdCount( kBins, 0.0 );
+  vector< double > c( rBins, 0.0 ), cCount( rBins, 0.0 );
+
+  for ( int i = 0; i < nx; i++ ){
+    int kx = i <= nx/2 ? i : i - nx;
+    for ( int j = 0; j < nh; j++ ){
+      // The columns 0 < ky < ny/2 stand for themselves and their mirror
+      double weight = ( j == 0 || 2*j == ny ) ? 1.0 : 2.0;
+      int b = (int)( sqrt( kx*dqx*kx*dqx + j*dqy*j*dqy ) + 0.5 );
+      psd[ b ] += weight*power[ i*nh + j ].real();
+      psdCount[ b ] += weight;
+    }
+  }
+
+  for ( int i = 0; i < nx; i++ ){
+    int dx = i <= nx/2 ? i : nx - i;
+    for ( int j = 0; j < ny; j++ ){
+      int dy = j <= ny/2 ? j : ny - j;
+      int b = (int)( sqrt( (double)dx*dx + dy*dy ) + 0.5 );
+      c[ b ] += corr[ i*ny + j ];
+      cCount[ b ] += 1.0;
+    }
+  }
+
+  // The width is the autocorrelation at zero distance
+  double width2 = corr[ 0 ];
+  double width = sqrt( fmax( width2, 0.0 ) );
+
+  double correlationLength = 0;
+  for ( int b = 1; b < rBins; b++ ){
+    if ( cCount[ b ] == 0 || cCount[ b - 1 ] == 0 )
+      continue;
+
+    double c0 = c[ b - 1 ]/cCount[ b - 1 ];
+    double c1 = c[ b ]/cCount[ b ];
+    if ( width2 > 0 && c1 <= width2/M_E ){
+      correlationLength = b - 1 + ( c0 - width2/M_E )/( c0 - c1 );
+      break;
+    }
+  }
+
+  m_summary << time << "," << mean << "," << width << "," << correlationLength << "\n";
+  for ( int b = 0; b < kBins; b++ )
+    if ( psdCount[ b ] > 0 )
+      m_psd << time << "," << (double)b/l << "," << psd[ b ]/psdCount[ b ] << "\n";
+
+  for ( int b = 0; b < rBins; b++ )
+    if ( cCount[ b ] > 0 )
+      m_hhc << time << "," << b << "," << 2.0*( width2 - c[ b ]/cCount[ b ] ) << "\n";
+}
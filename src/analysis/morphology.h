@@ -0,0 +1,82 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef MORPHOLOGY_H
+#define MORPHOLOGY_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+
+#include "pointers.h"
+
+using namespace std;
+
+/** Periodic analysis of the film morphology from the heights of the lattice.
+ * At every sampling interval of simulation time the heights are copied to a flat buffer and a
+ * background thread computes, with a real to complex 2D FFT, the radially averaged power spectral
+ * density, the height-height correlation function H(r) = 2(w^2 - C(r)), the interface width w and
+ * the correlation length (where the autocorrelation C(r) drops to C(0)/e).
+ * The summary goes to <name>.csv (one row per sample). The power spectrum, binned by the wavenumber k [1/site] so that
+ * rectangular lattices are averaged correctly, goes to <name>-psd.csv and the height-height correlation, binned by
+ * the distance r [sites], to <name>-hhc.csv.
+ * Only one analysis runs at a time: a new snapshot waits for the previous one to finish. */
+
+class Morphology: public Pointers
+{
+public:
+    /// Constructor
+    /// A zero interval takes snapshots only when observed by the observation scheduler.
+    Morphology( Apothesis* apothesis, double interval );
+
+    /// Destructor. Waits for the running analysis and closes the files.
+    virtual ~Morphology();
+
+    /// Opens the files and analyses the initial heights.
+    void init( string name );
+
+    /// Takes a snapshot if a sampling time has been reached. Called before the event is
+    /// performed so the snapshot is the lattice at the sampling time.
+    void sample( long double time );
+
+    /// Takes a snapshot at time. Called by the observation scheduler.
+    void observe( long double time );
+
+private:
+    /// The sampling interval [s]
+    double m_dInterval;
+
+    /// The next sampling time
+    long double m_nextTime;
+
+    /// The summary and the radial output files
+    ofstream m_summary;
+    ofstream m_psd;
+    ofstream m_hhc;
+
+    /// The background analysis
+    thread m_worker;
+
+    /// Copies the heights and starts the analysis of the snapshot.
+    void mf_snapshot( long double time );
+
+    /// Analyses a snapshot of nx x ny heights (row major) and writes the results. Runs on the worker.
+    void mf_analyse( vector< double > heights, int nx, int ny, double time );
+};
+
+#endif // MORPHOLOGY_H
@@ -0,0 +1,96 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "apothesis_c.h"
+#include "apothesis.h"
+
+struct apothesis_s
+{
+  Apothesis* pApothesis;
+};
+
+apothesis_t* apothesis_create( const char* input )
+{
+  apothesis_t* apo = new apothesis_t;
+  apo->pApothesis = new Apothesis( string( input ) );
+  apo->pApothesis->init();
+  return apo;
+}
+
+void apothesis_destroy( apothesis_t* apo )
+{
+  if ( !apo )
+    return;
+
+  delete apo->pApothesis;
+  delete apo;
+}
+
+long apothesis_advance_until( apothesis_t* apo, double time )
+{
+  return apo->pApothesis->advanceUntil( time );
+}
+
+long apothesis_advance_events( apothesis_t* apo, long n )
+{
+  return apo->pApothesis->advanceEvents( n );
+}
+
+double apothesis_get_time( apothesis_t* apo )
+{
+  return apo->pApothesis->getTime();
+}
+
+long apothesis_get_events( apothesis_t* apo )
+{
+  return apo->pApothesis->getEvents();
+}
+
+void apothesis_set_pressure( apothesis_t* apo, double pressure )
+{
+  apo->pApothesis->setPressure( pressure );
+}
+
+double apothesis_get_pressure( apothesis_t* apo )
+{
+  return apo->pApothesis->getPressure();
+}
+
+void apothesis_set_temperature( apothesis_t* apo, double temperature )
+{
+  apo->pApothesis->setTemperature( temperature );
+}
+
+double apothesis_get_temperature( apothesis_t* apo )
+{
+  return apo->pApothesis->getTemperature();
+}
+
+int apothesis_set_mass_fraction( apothesis_t* apo, const char* species, double fraction )
+{
+  return apo->pApothesis->setMassFraction( species, fraction ) ? 0 : -1;
+}
+
+double apothesis_get_mass_fraction( apothesis_t* apo, const char* species )
+{
+  return apo->pApothesis->getMassFraction( species );
+}
+
+double apothesis_get_flux( apothesis_t* apo, const char* species )
+{
+  return apo->pApothesis->getFlux( species );
+}
@@ -0,0 +1,74 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef APOTHESIS_C_H
+#define APOTHESIS_C_H
+
+/** The C interface of libapothesis for embedding the KMC in a reactor (e.g. CFD) solver.
+ * An instance is built from the text of an input file. The host advances it in batches and exchanges
+ * the boundary conditions (pressure, temperature and mass fractions of the gas phase) and the fluxes
+ * to the surface in memory. Nothing is written in a log file. Every call is a direct call on the instance,
+ * so the cost of a coupling step is that of the events it performs. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// An instance of Apothesis
+typedef struct apothesis_s apothesis_t;
+
+/// Builds and initializes an instance from the text of an input file. Errors in the input terminate the process.
+apothesis_t* apothesis_create( const char* input );
+
+/// Destroys an instance
+void apothesis_destroy( apothesis_t* apo );
+
+/// Performs events until the simulation time reaches time [s]. Returns the number of events.
+long apothesis_advance_until( apothesis_t* apo, double time );
+
+/// Performs at least n events. Returns the number of events.
+long apothesis_advance_events( apothesis_t* apo, long n );
+
+/// Returns the simulation time [s]
+double apothesis_get_time( apothesis_t* apo );
+
+/// Returns the number of events performed
+long apothesis_get_events( apothesis_t* apo );
+
+/// Sets and returns the pressure [Pa]
+void apothesis_set_pressure( apothesis_t* apo, double pressure );
+double apothesis_get_pressure( apothesis_t* apo );
+
+/// Sets and returns the temperature [K]
+void apothesis_set_temperature( apothesis_t* apo, double temperature );
+double apothesis_get_temperature( apothesis_t* apo );
+
+/// Sets the mass fraction of an adsorbing species. Returns 0 or -1 if no adsorption has this species.
+int apothesis_set_mass_fraction( apothesis_t* apo, const char* species, double fraction );
+
+/// Returns the mass fraction of an adsorbing species or -1 if no adsorption has this species
+double apothesis_get_mass_fraction( apothesis_t* apo, const char* species );
+
+/// Returns the net flux of a species to the surface (adsorptions minus desorptions and the gas of the surface reactions) [1/(site s)]
+/// during the last advance call
+double apothesis_get_flux( apothesis_t* apo, const char* species );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APOTHESIS_C_H
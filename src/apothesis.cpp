@@ -31,7 +31,31 @@
 #include "desorption.h"
 #include "diffusion.h"
 #include "SurfaceReaction.h"
+#include "arena.h"
+#include "next_reaction.h"
+#include "hierarchical_selector.h"
+#include "process_table.h"
+#include "boundary_layer.h"
+#include "observables.h"
+#include "morphology.h"
+#include "voxel_lattice.h"
+#include "lateral_interactions.h"
+#include "metrics.h"
+#include "snapshot_writer.h"
+#include "tau_leaping.h"
+#include "observation_scheduler.h"
+#include "event_recorder.h"
+#include "event_replay.h"
+#include "xyz_reader.h"
+#include "cml_reader.h"
+#include "parallel.h"
+#include "trace.h"
+#include "perf_counters.h"
+#include "memory_report.h"
 #include <numeric>
+#include <limits>
+#include <cctype>
+#include <sstream>
 
 using namespace MicroProcesses;
 
@@ -42,16 +66,70 @@ using namespace MicroProcesses;
 //using namespace Utils;
 
 Apothesis::Apothesis(int argc, char *argv[])
+    : Apothesis(argc, argv, "", false)
+{
+}
+
+Apothesis::Apothesis(const string &input)
+    : Apothesis(0, 0, input, true)
+{
+}
+
+Apothesis::Apothesis(int argc, char *argv[], const string &input, bool embedded)
     : pLattice(0),
+      pNextReaction(0),
+      pSelector(0),
+      pTable(0),
+      pBoundaryLayer(0),
+      pObservables(0),
+      pMorphology(0),
+      pVoxels(0),
+      pInteractions(0),
+      pMetrics(0),
+      pSnapshots(0),
+      pLeaping(0),
+      pScheduler(0),
+      pRecorder(0),
+      pReplay(0),
 //      pRead(0),
       m_debugMode(false),
+      m_eventLog(true),
       m_time(0),
       m_writeFrequency(500),
-      m_iter(0)
+      m_iter(0),
+      m_bEmbedded(embedded),
+      m_bDryRun(false),
+      m_dWindowStart(0)
 {
   m_iArgc = argc;
   m_vcArgv = argv;
 
+  // Apothesis --replay <event stream> <time> ... rebuilds the lattice at the times instead of running.
+  // Apothesis --trace <file> [every] records the timeline of the phases (one step in every) and must come first.
+  // Apothesis --dry-run projects the memory of the run without building the lattice.
+  for (int i = 1; i < argc; i++)
+  {
+    if (string(argv[i]) == "--trace" && i + 1 < argc)
+    {
+      string path = argv[++i];
+      int every = 1;
+      if (i + 1 < argc && isdigit(argv[i + 1][0]))
+        every = atoi(argv[++i]);
+      Utils::Trace::enable(path, every);
+    }
+    else if (string(argv[i]) == "--replay" && i + 1 < argc)
+    {
+      m_sReplayFile = argv[++i];
+      while (i + 1 < argc)
+        m_vReplayTimes.push_back(atof(argv[++i]));
+    }
+    else if (string(argv[i]) == "--dry-run")
+      m_bDryRun = true;
+  }
+
+  // The arena must exist before anything that lives in it (lattice, sites, species, processes) is created
+  pArena = new Utils::Arena();
+
   pParameters = new Utils::Parameters(this);
 
   /* This must be constructed before the input */
@@ -61,7 +139,10 @@ Apothesis::Apothesis(int argc, char *argv[])
 
 //  pRead = new Read(this);
 
-  pTxtReader = new TxtReader(this,"./input.txt");
+  if (m_bEmbedded)
+    pTxtReader = new TxtReader(this, input, TxtReader::Text);
+  else
+    pTxtReader = new TxtReader(this,"./input.txt");
 
   pTxtReader->parseFile();
 
@@ -69,10 +150,23 @@ Apothesis::Apothesis(int argc, char *argv[])
 
   // Build the lattice. This should always follow the read input
 
-  std::cout << "Building the lattice" << std::endl;
-  pLattice->build();
-  pIO->writeLatticeHeights();
-  std::cout << "Finished building the lattice" << std::endl;
+  if (m_bEmbedded)
+  {
+    Utils::TraceScope trace("Lattice::build");
+    pLattice->build();
+  }
+  else if (m_bDryRun)
+    std::cout << "Dry run: the lattice is not built" << std::endl;
+  else
+  {
+    std::cout << "Building the lattice" << std::endl;
+    {
+      Utils::TraceScope trace("Lattice::build");
+      pLattice->build();
+    }
+    pIO->writeLatticeHeights();
+    std::cout << "Finished building the lattice" << std::endl;
+  }
 
   // initialize number of species
   m_nSpecies = 0;
@@ -83,25 +177,37 @@ Apothesis::~Apothesis()
   delete pIO;
 //  delete pRead;
   delete pTxtReader;
-  delete pLattice;
 
-  // Delete the processes created by the factory method
-  for (vector<Process *>::iterator it = m_vProcesses.begin();
-       it != m_vProcesses.end(); it++)
-  {
-    delete *it;
-  }
+  // The processes of the factory are not in the arena
+  for (Process *p : m_vPlugins)
+    delete p;
+
+  // The lattice, the sites, the species and the processes are owned by the arena.
+  // Deleting it destroys them in reverse order of creation.
+  delete pArena;
+
+  delete pParameters;
+
+  // The threads of the snapshots, the metrics and the morphology have been joined with their owners
+  if (Utils::Trace::isEnabled())
+    Utils::Trace::write();
+
+  if (Utils::PerfCounters::isEnabled())
+    Utils::PerfCounters::disable();
 }
 
 void Apothesis::init()
 {
+  Utils::TraceScope trace("Apothesis::init");
+
   cout << "Opening output file" << endl;
   /// The output file name will come from the user and will have the extenstion .log
   /// This would come as a parameter from the user from the args (also the input).
   /// Now both are hard copied.
 
-  if (!pIO->outputOpen())
-    pIO->openOutputFile("Output-700K");
+  // Embedded the log is not opened and every write to it is dropped
+  if (!pIO->outputOpen() && !m_bEmbedded)
+    pIO->openOutputFile(isReplay() ? "Replay-700K" : "Output-700K");
 
   // Processes in this case
   //vector<string> pProc = m_processes;
@@ -125,11 +231,15 @@ void Apothesis::init()
   }*/
 
   for(const auto& [key,value]:pTxtReader->getSpecies()){
-      Species *s = new Species(key, value, m_nSpecies);
+      Species *s = pArena->create<Species>(key, value, m_nSpecies);
       m_nSpecies++;
       m_species[key] = s;
       cout << key <<endl;
   }
+
+  // The species counts of the sites. The lateral interactions read them when they are initialized.
+  pLattice->initSpecies(m_nSpecies);
+
   // Initializing interactions between species
   //pIO->writeLogOutput("Reading interactions between species");
 
@@ -410,31 +520,133 @@ void Apothesis::init()
 */
   map<string,vector<double>> procEnergetics=pTxtReader->getProcEnergetics();
   map<string,vector<double>> procStoichiometry=pTxtReader->getProcStoichiometry();
+  map<string,string> rates=pTxtReader->getProcRates();
+  set<string> deposits=pTxtReader->getProcDeposits();
+  vector< pair<string, Diffusion*> > vDiffusion;
 
   for(const auto& [key,value]:pTxtReader->getProcSpecies()){
       vector<double> energetics=procEnergetics[key];
       vector<string> species=value;
       if(pTxtReader->contains(key,"Adsorption")){
           cout << key << " "<< "Adsorption" <<" " << species[0]<<  endl;
-          Adsorption *a = new Adsorption(this, species[0], m_species[species[0]], energetics[0], energetics[1], false);
+          Adsorption *a = pArena->create<Adsorption>(this, species[0], m_species[species[0]], energetics[0], energetics[1], false);
+          if (energetics.size() > 2)
+            a->setSiteDensity(energetics[2]);
           m_vProcesses.push_back(a);
+          m_vAdsorption.push_back(a);
       }
       else if(pTxtReader->contains(key,"Desorption")){
           cout << key << " "<< "Desorption" << endl;
-          Desorption *ds = new Desorption(this, species[0], m_species[species[0]], energetics[0], energetics[1]);
+          Desorption *ds = pArena->create<Desorption>(this, species[0], m_species[species[0]], energetics[0], energetics[1]);
           m_vProcesses.push_back(ds);
+          m_vDesorption.push_back(ds);
       }
       else if(pTxtReader->contains(key,"Diffusion")){
           cout << key << " "<< "Diffusion" << endl;
-          Diffusion *df = new Diffusion(this, species[0], energetics[0], energetics[1]);
+          Diffusion *df = pArena->create<Diffusion>(this, species[0], energetics[0], energetics[1]);
           m_vProcesses.push_back(df);
+          vDiffusion.push_back(make_pair(species[0], df));
       }else{
           cout << key << " "<< "Reaction" << endl;
-          //SurfaceReaction *sr = new SurfaceReaction(this, m_species[species[0]], procStoichiometry[key], energetics[0], energetics[1], false);
-          //m_vProcesses.push_back(sr);
+          pair< vector<string>, vector<string> > terms = pTxtReader->getProcTerms()[key];
+          ReactionTemplate pattern;
+          string error = pattern.parse(terms.first, terms.second, m_species);
+          if (!error.empty())
+          {
+            pErrorHandler->error_simple_msg(key + ": " + error);
+            EXIT;
+          }
+
+          SurfaceReaction *sr = pArena->create<SurfaceReaction>(this, pattern, energetics[0], energetics[1]);
+          m_vProcesses.push_back(sr);
+          m_vSurfaceReaction.push_back(sr);
+
+          if (deposits.count(key))
+          {
+            error = sr->setDeposition();
+            if (!error.empty())
+            {
+              pErrorHandler->error_simple_msg(key + ": " + error);
+              EXIT;
+            }
+          }
+      }
+
+      if (deposits.count(key) && !pTxtReader->contains(key, "Reaction"))
+      {
+        pErrorHandler->error_simple_msg(key + ": only surface reactions can deposit.");
+        EXIT;
+      }
+
+      // The rate law of the input replaces the one of the process
+      if (rates.count(key))
+      {
+        string error = m_vProcesses.back()->setRateLaw(rates[key]);
+        if (!error.empty())
+        {
+          pErrorHandler->error_simple_msg(key + ": " + error);
+          EXIT;
+        }
+        if (m_vProcesses.back()->isCoverageDependent())
+          m_vCoverageDependent.push_back(m_vProcesses.back());
       }
   }
 
+  // The processes outside of the tree are created by the factory they have registered with
+  for (const auto &[name, parameters] : pTxtReader->getPlugins())
+  {
+    Process *p = FactoryProcess::createProcess(name);
+    if (!p)
+    {
+      pErrorHandler->error_simple_msg("No process " + name + " is registered. Is it declared with REGISTER_PROCESS?");
+      EXIT;
+    }
+
+    cout << name << " " << "Plugin" << endl;
+    p->setInstance(this);
+    p->setName(name);
+    p->setParameters(parameters);
+    m_vPlugins.push_back(p);
+    m_vProcesses.push_back(p);
+  }
+
+  // The position of each process by which the outputs count its events
+  for (int i = 0; i < (int)m_vProcesses.size(); i++)
+    m_vProcesses[i]->setIndex(i);
+
+  // Link the processes of the same species. The rate classes of desorption and diffusion
+  // are kept up to date by the adsorption and desorption of that species.
+  for (vector<Desorption *>::iterator itr = m_vDesorption.begin(); itr != m_vDesorption.end(); ++itr)
+  {
+    Desorption *d = *itr;
+    Adsorption *a = findAdsorption(d->getSpeciesName());
+    if (a)
+    {
+      d->setAdsorptionPointer(a);
+      a->setDesorptionPointer(d);
+      a->setDesorption(true);
+    }
+  }
+
+  for (vector< pair<string, Diffusion*> >::iterator itr = vDiffusion.begin(); itr != vDiffusion.end(); ++itr)
+  {
+    Adsorption *a = findAdsorption(itr->first);
+    Desorption *d = findDesorption(itr->first);
+    if (!a || !d)
+    {
+      pErrorHandler->error_simple_msg("Diffusion of " + itr->first + " requires the adsorption and the desorption of the same species.");
+      EXIT;
+    }
+
+    Diffusion *df = itr->second;
+    df->setAdsorptionPointer(a);
+    df->setDesorptionPointer(d);
+    a->setDiffusion(true);
+    a->setDiffusionPointer(df);
+    d->setDiffusion(true);
+    d->setDiffusionPointer(df);
+  }
+
 /*
   // Initialize interactions between adsorption species and classes
   vector<tuple<string, string>>::iterator itr = m_interactions.begin();
@@ -469,20 +681,330 @@ void Apothesis::init()
   cout << endl;
   /// First the processes that participate in the simulation
 */
+  // The lateral interactions must exist before the rate classes are built
+  vector< tuple<string, string, double> > lateral = pTxtReader->getLateralInteractions();
+  if (!lateral.empty())
+  {
+    pInteractions = pArena->create<LateralInteractions>(this);
+    for (tuple<string, string, double> &pair : lateral)
+    {
+      if (m_species.find(get<0>(pair)) == m_species.end() || m_species.find(get<1>(pair)) == m_species.end())
+      {
+        pErrorHandler->error_simple_msg("Unknown species in the lateral interaction " + get<0>(pair) + " " + get<1>(pair) + ".");
+        EXIT;
+      }
+      pInteractions->addPair(m_species[get<0>(pair)], m_species[get<1>(pair)], get<2>(pair));
+    }
+    Utils::TraceScope trace("LateralInteractions::init");
+    pInteractions->init(m_vAdsorption, m_vDesorption);
+  }
+
   /// that were read from the file input and the I/O functionality
   //m_vProcesses[0]->setInstance( this );
-  for (vector<Process *>::iterator itr = m_vProcesses.begin(); itr != m_vProcesses.end(); ++itr)
   {
-    Process *p = *itr;
-    p->activeSites(pLattice);
+    Utils::TraceScope trace("activeSites");
+    for (vector<Process *>::iterator itr = m_vProcesses.begin(); itr != m_vProcesses.end(); ++itr)
+    {
+      Process *p = *itr;
+      p->activeSites(pLattice);
+    }
+  }
+
+  // Start from a surface read from a file. A replay starts from the keyframes of the event stream instead.
+  if (!pTxtReader->getLatticeFile().empty() && !isReplay())
+    mf_readLattice(pTxtReader->getLatticeFile());
+
+  if (pTxtReader->getVoxelLattice())
+  {
+    pVoxels = pArena->create<VoxelLattice>(this);
+    pVoxels->init();
+  }
+
+  // A replay needs none of the gas phase, the output and the engines
+  if (isReplay())
+  {
+    if (pVoxels)
+    {
+      pErrorHandler->error_simple_msg("The keyframes of an event stream do not hold the voxels. Replay is available in the solid-on-solid mode only.");
+      EXIT;
+    }
+
+    pReplay = pArena->create<EventReplay>(this, m_sReplayFile);
+    pReplay->init(m_vProcesses, m_species);
+    mf_logMemory();
+    return;
+  }
+
+  // The gas phase boundary layer that feeds the mass fractions of the adsorption processes
+  vector<double> boundaryLayer = pTxtReader->getBoundaryLayer();
+  if (!boundaryLayer.empty())
+  {
+    pIO->writeLogOutput("Coupling with the gas phase boundary layer");
+    pBoundaryLayer = pArena->create<BoundaryLayer>(this, boundaryLayer[0], (int)boundaryLayer[1], boundaryLayer[2], boundaryLayer[3], boundaryLayer[4]);
+    pBoundaryLayer->init(m_vAdsorption, m_vDesorption);
+  }
+
+  // The observables sampled in simulation time and the per event log
+  m_eventLog = pTxtReader->getEventLog() && !m_bEmbedded;
+  if (pTxtReader->getObservablesInterval() > 0)
+  {
+    pObservables = pArena->create<Observables>(this, pTxtReader->getObservablesInterval());
+    pObservables->init(m_bEmbedded ? "" : "Observables-700K", m_species, m_vProcesses);
+  }
+
+  if (pTxtReader->getMorphologyInterval() > 0)
+  {
+    pMorphology = pArena->create<Morphology>(this, pTxtReader->getMorphologyInterval());
+    pMorphology->init("Morphology-700K");
+  }
+
+  if (!pTxtReader->getMetricsFile().empty())
+  {
+    pMetrics = pArena->create<Metrics>(this, pTxtReader->getMetricsFile(), pTxtReader->getMetricsPeriod());
+    pMetrics->init(m_vProcesses, pTxtReader->getTime());
+
+    // The gauge starts from the roughness of the initial surface
+    pLattice->getRoughness();
+  }
+
+  if (!pTxtReader->getSnapshotsFile().empty())
+  {
+    vector<string> names(m_nSpecies);
+    for (auto &species : m_species)
+      if (species.second)
+        names[species.second->getId()] = species.first;
+
+    pSnapshots = pArena->create<SnapshotWriter>(this);
+    pSnapshots->init(pTxtReader->getSnapshotsFile(), names);
+    pSnapshots->snapshot(m_time, m_iter);
+  }
+
+  if (!pTxtReader->getObservations().empty())
+    mf_initObservations();
+
+  if (!pTxtReader->getEventStreamFile().empty())
+  {
+    pRecorder = pArena->create<EventRecorder>(this, pTxtReader->getEventStreamFile(), pTxtReader->getKeyframeInterval());
+    pRecorder->init(m_vProcesses);
+  }
+
+  // The events of each process for the fluxes of the embedded use
+  m_vEvents.assign(m_vProcesses.size(), 0);
+  m_vWindowEvents = m_vEvents;
+
+  // The engine that performs the KMC iterations
+  if (pTxtReader->contains(pTxtReader->getEngine(), "nrm"))
+  {
+    pIO->writeLogOutput("Using the next reaction method");
+    pNextReaction = pArena->create<NextReaction>(this);
+    pNextReaction->init(m_vProcesses, m_time);
+  }
+  else if (pTxtReader->contains(pTxtReader->getEngine(), "tree"))
+  {
+    pIO->writeLogOutput("Using the hierarchical event selection");
+    pSelector = pArena->create<HierarchicalSelector>(this);
+    pSelector->init(m_vProcesses);
+  }
+  else
+  {
+    pTable = pArena->create<ProcessTable>(this);
+    pTable->init(m_vProcesses);
+  }
+
+  // The approximate leaps of the adsorptions. The next reaction method keeps putative times that a leap would invalidate.
+  if (pTxtReader->getTauLeaping() > 0)
+  {
+    if (pNextReaction)
+      pIO->writeLogOutput("Tau leaping is not available with the next reaction method. Only exact steps are performed.");
+    else
+    {
+      pIO->writeLogOutput("Using tau leaping for the adsorptions with tolerance " + to_string(pTxtReader->getTauLeaping()));
+      pLeaping = pArena->create<TauLeaping>(this, pTxtReader->getTauLeaping());
+      pLeaping->init(m_vAdsorption, m_vProcesses);
+    }
+  }
+
+  // The hardware counters of the phases of the steps. The run goes on without them if they cannot be opened.
+  if (pTxtReader->getPerfCounters() > 0)
+  {
+    string error;
+    if (Utils::PerfCounters::enable(pTxtReader->getPerfCounters(), error))
+      pIO->writeLogOutput("Measuring the performance counters in one step in every " + to_string(pTxtReader->getPerfCounters()));
+    else
+      pIO->writeLogOutput("The performance counters are not available: " + error);
+  }
+
+  if (!m_bEmbedded)
+    mf_logMemory();
+}
+
+void Apothesis::mf_logMemory()
+{
+  Utils::MemoryReport report;
+  pLattice->accountMemory(report);
+  report.add(Utils::MemoryReport::SPECIES, m_nSpecies * sizeof(Species) + Utils::MemoryReport::heap(m_species));
+
+  for (Process *p : m_vProcesses)
+    p->accountMemory(report);
+
+  if (pVoxels)
+    pVoxels->accountMemory(report);
+  if (pInteractions)
+    pInteractions->accountMemory(report);
+  if (pNextReaction)
+    pNextReaction->accountMemory(report);
+  if (pSelector)
+    pSelector->accountMemory(report);
+  if (pTable)
+    pTable->accountMemory(report);
+  if (pLeaping)
+    pLeaping->accountMemory(report);
+  if (pObservables)
+    pObservables->accountMemory(report);
+  if (pSnapshots)
+    pSnapshots->accountMemory(report);
+  if (pRecorder)
+    pRecorder->accountMemory(report);
+  if (Utils::Trace::isEnabled())
+    Utils::Trace::accountMemory(report);
+
+  pIO->writeLogOutput("Memory after the initialization:");
+  for (const string &line : report.report())
+    pIO->writeLogOutput("  " + line);
+  pIO->writeLogOutput("  Arena: " + Utils::MemoryReport::format(pArena->getBytesUsed()) + " used of " + Utils::MemoryReport::format(pArena->getBytesReserved()) + " reserved");
+  pIO->writeLogOutput("  Resident: " + Utils::MemoryReport::format(Utils::MemoryReport::getResident()));
+}
+
+void Apothesis::estimateMemory()
+{
+  int numSpecies = pTxtReader->getSpecies().size();
+  long sites = pLattice->getSize();
+
+  Utils::MemoryReport report;
+  report.add(Utils::MemoryReport::SPECIES, numSpecies * (sizeof(Species) + Utils::MemoryReport::block(sizeof(pair<const string, Species *>) + 4 * sizeof(void *))));
+
+  // The pools are projected full (every site in every process), which bounds them from above
+  bool interactions = !pTxtReader->getLateralInteractions().empty();
+  int numProcesses = 0;
+  for (const auto &[key, value] : pTxtReader->getProcSpecies())
+  {
+    if (pTxtReader->contains(key, "Adsorption"))
+      Adsorption::estimateMemory(report, sites);
+    else if (pTxtReader->contains(key, "Desorption"))
+      Desorption::estimateMemory(report, sites, interactions);
+    else if (pTxtReader->contains(key, "Diffusion"))
+      Diffusion::estimateMemory(report, sites, interactions);
+    else
+      SurfaceReaction::estimateMemory(report, sites);
+    numProcesses++;
+  }
+  numProcesses += pTxtReader->getPlugins().size();
+
+  pLattice->estimateMemory(report, numSpecies, numProcesses);
+
+  if (pTxtReader->getVoxelLattice())
+    VoxelLattice::estimateMemory(report, sites);
+  if (interactions)
+    LateralInteractions::estimateMemory(report, sites);
+
+  // The engines hold the channels of the processes, which do not grow with the lattice
+  if (pTxtReader->contains(pTxtReader->getEngine(), "nrm"))
+    report.add(Utils::MemoryReport::ENGINE, sizeof(NextReaction));
+  else if (pTxtReader->contains(pTxtReader->getEngine(), "tree"))
+    report.add(Utils::MemoryReport::ENGINE, sizeof(HierarchicalSelector));
+  else
+    report.add(Utils::MemoryReport::ENGINE, sizeof(ProcessTable));
+  if (pTxtReader->getTauLeaping() > 0)
+    report.add(Utils::MemoryReport::ENGINE, sizeof(TauLeaping));
+
+  if (pTxtReader->getObservablesInterval() > 0)
+    report.add(Utils::MemoryReport::IO, sizeof(Observables));
+  if (!pTxtReader->getSnapshotsFile().empty())
+    SnapshotWriter::estimateMemory(report, sites, numSpecies);
+  if (!pTxtReader->getEventStreamFile().empty())
+    EventRecorder::estimateMemory(report);
+
+  cout << "Projected memory of a " << pLattice->getX() << "x" << pLattice->getY() << " lattice with " << numSpecies
+       << " species and " << numProcesses << " processes:" << endl;
+  for (const string &line : report.report())
+    cout << "  " << line << endl;
+}
+
+void Apothesis::mf_readLattice(string path)
+{
+  Utils::TraceScope trace("Apothesis::readLattice");
+
+  LatticeReader *reader;
+  if (pTxtReader->contains(path, ".cml"))
+    reader = new CmlReader(this, path);
+  else
+    reader = new XyzReader(this, path);
+
+  reader->read(pLattice->getX(), pLattice->getY());
+  pIO->writeLogOutput("Read " + to_string(reader->getNumAtoms()) + " atoms from " + path);
+
+  // The symbols that are species of the simulation
+  const vector<string> &symbols = reader->getSymbols();
+  vector<Species *> vSpecies(symbols.size(), 0);
+  for (int s = 0; s < (int)symbols.size(); ++s)
+    if (m_species.find(symbols[s]) != m_species.end())
+      vSpecies[s] = m_species[symbols[s]];
+
+  int size = pLattice->getSize();
+  vector<int> heights(size);
+  vector<vector<Species *>> species(size);
+  for (int i = 0; i < size; ++i)
+  {
+    heights[i] = reader->getHeight(i);
+
+    int s = reader->getSymbolIndex(i);
+    if (s >= 0 && vSpecies[s])
+      species[i].push_back(vSpecies[s]);
+  }
+
+  delete reader;
+
+  setSurface(heights, species);
+}
+
+void Apothesis::setSurface(const vector<int> &heights, const vector<vector<Species *>> &species)
+{
+  int size = pLattice->getSize();
+  for (int i = 0; i < size; ++i)
+  {
+    if (heights[i] >= 0)
+      pLattice->getSite(i)->setHeight(heights[i]);
   }
 
-  // Initialize species map in lattice
-  vector<Site *> sites = pLattice->getSites();
-  for (int site = 0; site < sites.size(); ++site)
+  // The neighbours depend on the heights of all the sites around
+  for (int i = 0; i < size; ++i)
+    pLattice->updateNeighbours(pLattice->getSite(i));
+
+  // The adsorption process of each species (if any)
+  map<Species *, Adsorption *> adsorption;
+  for (vector<Adsorption *>::iterator itr = m_vAdsorption.begin(); itr != m_vAdsorption.end(); ++itr)
+    if (m_species.find((*itr)->getSpeciesName()) != m_species.end())
+      adsorption[m_species[(*itr)->getSpeciesName()]] = *itr;
+
+  for (int i = 0; i < size; ++i)
   {
-    Site *pSite = sites[site];
-    pSite->initSpeciesMap(m_nSpecies);
+    if (species[i].empty())
+      continue;
+
+    Site *site = pLattice->getSite(i);
+    for (Species *s : species[i])
+    {
+      if (adsorption.count(s))
+        adsorption[s]->placeSpecies(site);
+      else
+        site->addSpecies(s);
+    }
+
+    for (vector<SurfaceReaction *>::iterator itr = m_vSurfaceReaction.begin(); itr != m_vSurfaceReaction.end(); ++itr)
+      (*itr)->update(site);
+
+    if (pInteractions)
+      pInteractions->update(site);
   }
 }
 
@@ -504,44 +1026,446 @@ void Apothesis::exec()
   /// Get list of possible processes
   while (m_time < simulationTime)
   {
-    // Increment number of iterations
-    m_iter++;
+    if (!mf_step(numeric_limits<long double>::infinity()))
+    {
+      pIO->writeLogOutput("No process can be performed at " + to_string(m_time) + " s");
+      break;
+    }
+  }
 
-    vector<Process *> processes = m_vProcesses;
-    /// Find probability of each process
-    vector<double> probabilities = calculateProbabilities(m_vProcesses);
-    /// Pick random number with 3 digits
-    double random = (double)rand() / RAND_MAX;
+  if (Utils::PerfCounters::isEnabled())
+    for (string &line : Utils::PerfCounters::report())
+      pIO->writeLogOutput(line);
 
-    /// Pick Process
-    Process *p = pickProcess(probabilities, random, processes);
+  if (pLeaping)
+    pIO->writeLogOutput("Tau leaping: " + to_string(pLeaping->getNumLeaps()) + " leaps with " + to_string(pLeaping->getNumEvents()) + " events");
+}
 
-    // Site should be picked here
-    p->selectSite();
+bool Apothesis::mf_step(long double until)
+{
+  // Increment number of iterations
+  m_iter++;
+
+  // The iterations before this step. A leap performs many events at once.
+  unsigned int previous = m_iter - 1;
+
+  // The phases of one step in every are in the timeline
+  if (Utils::Trace::isEnabled())
+    Utils::Trace::sample();
+  Utils::TraceScope trace("step", Utils::Trace::Sampled);
+
+  if (Utils::PerfCounters::isEnabled())
+    Utils::PerfCounters::sample();
+
+  if (pLeaping && pLeaping->plan() && m_time + pLeaping->getTau() <= until)
+  {
+    Utils::TraceScope leap("leap", Utils::Trace::Sampled);
+
+    /// A leap of the adsorptions. The observables are sampled with the lattice before the leap.
+    m_time += pLeaping->getTau();
+
+    if (pScheduler)
+      pScheduler->advance(m_time);
+
+    if (pObservables)
+      pObservables->sample(m_time);
+
+    if (pMorphology)
+      pMorphology->sample(m_time);
+
+    /// The step counted one event. The events of each process of the leap are counted together once they are
+    /// performed, so the metrics see the updated count. The recorder needs the site of every event.
+    m_iter--;
+    function<void(Process *)> record;
+    if (pRecorder)
+      record = [this](Process *q) { pRecorder->record(q, m_time); };
+
+    long events = pLeaping->perform([this](Process *q, long n) {
+      m_iter += n;
+      mf_countEvent(q, n);
+
+      if (pObservables)
+        pObservables->recordEvent(q, n);
+
+      if (pMetrics)
+        pMetrics->recordEvent(q->getIndex(), m_iter, m_time, n);
+    }, record);
+
+    if (m_eventLog)
+      pIO->writeLogOutput("Leap to " + to_string(m_time) + ": " + to_string(events) + " events");
+  }
+  else
+  {
+    Process *p = 0;
+    // The index of the process in the table of the BKL loop. Negative with the other engines, which
+    // keep the virtual calls since they recompute only the channels the processes report as changed.
+    int picked = -1;
+    {
+      Utils::TraceScope pick("pick", Utils::Trace::Sampled);
+
+      if (pNextReaction)
+      {
+        if (pNextReaction->getNextTime() > until)
+        {
+          m_time = until;
+          m_iter--;
+          return false;
+        }
+
+        /// The process and site of the channel that fires first. The time is advanced to its firing time.
+        Utils::PerfScope select(Utils::PerfCounters::SELECT);
+        p = pNextReaction->pickProcess(m_time);
+        if (p && m_eventLog)
+          pIO->writeLogOutput("Time step: " + to_string(m_time));
+      }
+      else if (pSelector)
+      {
+        /// The class, the process and the channel are selected in the sum trees and the time is advanced.
+        Utils::PerfScope select(Utils::PerfCounters::SELECT);
+        p = pSelector->pickProcess(m_time);
+        if (p && m_eventLog)
+          pIO->writeLogOutput("Time step: " + to_string(m_time));
+      }
+      else
+      {
+        /// Find probability of each process. The processes are called through their concrete type.
+        double total;
+        {
+          Utils::PerfScope rates(Utils::PerfCounters::RATES);
+          total = pTable->calculateProbabilities();
+        }
+
+        if (total > 0)
+        {
+          // Increment time
+          m_time += -log((double)rand() / RAND_MAX) / total;
+
+          /// Print to output
+          if (m_eventLog)
+            pIO->writeLogOutput("Time step: " + to_string(m_time));
+
+          Utils::PerfScope select(Utils::PerfCounters::SELECT);
+          /// Pick random number with 3 digits
+          double random = (double)rand() / RAND_MAX;
+
+          /// Pick Process and its site
+          picked = pTable->pickProcess(random);
+          p = pTable->getProcess(picked);
+        }
+      }
+
+      /// No process can be performed (e.g. the host set the pressure to zero). The time goes to until,
+      /// where the conditions may change. Without until the caller stops.
+      if (!p)
+      {
+        if (until < numeric_limits<long double>::infinity())
+          m_time = until;
+        m_iter--;
+        return false;
+      }
+
+      /// The event would cross until. Its waiting time is discarded and drawn again by the next step.
+      if (m_time > until)
+      {
+        m_time = until;
+        m_iter--;
+        return false;
+      }
+    }
 
     if (getDebugMode())
     {
       pIO->writeLogOutput("Current site: " + p->getSite());
     }
+
+    /// Sample the observables up to the new time. The lattice is still in the state before the event.
+    {
+      Utils::TraceScope observe("observe", Utils::Trace::Sampled);
+
+      if (pScheduler)
+        pScheduler->advance(m_time);
+
+      if (pObservables)
+        pObservables->sample(m_time);
+
+      if (pMorphology)
+        pMorphology->sample(m_time);
+    }
+
+    Utils::TraceScope perform("perform", Utils::Trace::Sampled);
+    Utils::PerfScope counters(Utils::PerfCounters::PERFORM);
+
     /// Perform process on that site
-    p->perform();
+    if (picked >= 0)
+      pTable->perform(picked);
+    else
+      p->perform();
+
+    mf_countEvent(p);
+
+    if (pObservables)
+      pObservables->recordEvent(p);
+
+    if (pMetrics)
+      pMetrics->recordEvent(p->getIndex(), m_iter, m_time);
+
+    if (pRecorder)
+      pRecorder->record(p, m_time);
+
+    if (m_eventLog)
+      pIO->writeLogOutput(p->getName() + " ");
+  }
+
+  {
+    Utils::TraceScope update("update", Utils::Trace::Sampled);
+    Utils::PerfScope counters(Utils::PerfCounters::UPDATE);
+
+    /// Exchange the surface fluxes with the gas phase. This may change the adsorption rates.
+    if (pBoundaryLayer)
+      pBoundaryLayer->couple(m_time);
+
+    /// The rate laws that read the coverages are evaluated again
+    for (Process *p : m_vCoverageDependent)
+      p->updateRates();
+
+    /// The processes of the factory do not report their channels, so all of them are recomputed
+    for (Process *p : m_vPlugins)
+      for (int c = 0; c < p->getNumChannels(); c++)
+        p->notifyChannel(c);
+
+    /// Reschedule the channels whose rate has changed
+    if (pNextReaction)
+      pNextReaction->update(m_time);
+
+    /// Recompute the channels whose rate has changed
+    if (pSelector)
+      pSelector->update();
+
+    /// The roughness of the metrics is computed here, once per period of the metrics
+    if (pMetrics && pMetrics->takeRoughnessRequest())
+      pLattice->getRoughness();
+  }
+
+  // The frequency that the various information are written in the file
+  // must befined by the user. Fix it ...
+  // The user should also check if the messages are written on the terminal or not.
+  //pIO->writeLogOutput("Roughness " + roughness);
+
+  // The observation scheduler replaces the output every m_writeFrequency events. Embedded there is none.
+  if (!pScheduler && !m_bEmbedded && m_iter / m_writeFrequency != previous / m_writeFrequency)
+  {
+    Utils::TraceScope output("output");
+    Utils::PerfScope counters(Utils::PerfCounters::OUTPUT);
+
+    mf_logProgress(m_iter);
+    if (pSnapshots)
+      pSnapshots->snapshot(m_time, m_iter);
+    else
+      pIO->writeLatticeHeights();
+  }
+  //pIO->writeLogOutput()
+
+  return true;
+}
+
+long Apothesis::advanceUntil(double time)
+{
+  mf_openWindow();
+
+  unsigned int start = m_iter;
+  while (m_time < time && mf_step(time))
+    ;
 
+  return m_iter - start;
+}
+
+long Apothesis::advanceEvents(long n)
+{
+  mf_openWindow();
 
-    // The frequency that the various information are written in the file
-    // must befined by the user. Fix it ...
-    // The user should also check if the messages are written on the terminal or not.
-    pIO->writeLogOutput(p->getName() + " ");
-    //pIO->writeLogOutput("Roughness " + roughness);
+  unsigned int start = m_iter;
+  while ((long)(m_iter - start) < n && mf_step(numeric_limits<long double>::infinity()))
+    ;
 
-    if (m_iter % m_writeFrequency == 0)
+  return m_iter - start;
+}
+
+void Apothesis::setPressure(double pressure)
+{
+  pParameters->setPressure(pressure);
+
+  // The adsorption rates are computed from the pressure on demand
+  for (Process *p : m_vProcesses)
+    p->updateRates();
+
+  mf_reschedule();
+}
+
+double Apothesis::getPressure()
+{
+  return pParameters->getPressure();
+}
+
+void Apothesis::setTemperature(double temperature)
+{
+  pParameters->setTemperature(temperature);
+
+  if (pInteractions)
+    pInteractions->updateTemperature();
+
+  for (Process *p : m_vProcesses)
+    p->updateRates();
+
+  mf_reschedule();
+}
+
+double Apothesis::getTemperature()
+{
+  return pParameters->getTemperature();
+}
+
+bool Apothesis::setMassFraction(string species, double fraction)
+{
+  for (Adsorption *a : m_vAdsorption)
+  {
+    if (a->getSpeciesName() == species)
     {
-      string iterations = std::to_string(m_iter);
-      double roughness = pLattice->getRoughness();
-      pIO->writeLogOutput("Roughness: " + std::to_string(roughness));
-      pIO->writeLogOutput("Iterations: " + iterations);
-      pIO->writeLatticeHeights(); 
+      a->setMassFraction(fraction);
+      mf_reschedule();
+      return true;
+    }
+  }
+  return false;
+}
+
+double Apothesis::getMassFraction(string species)
+{
+  for (Adsorption *a : m_vAdsorption)
+    if (a->getSpeciesName() == species)
+      return a->getMassFraction();
+  return -1;
+}
+
+double Apothesis::getFlux(string species)
+{
+  long double dt = m_time - m_dWindowStart;
+  if (dt <= 0)
+    return 0;
+
+  long net = 0;
+  for (Adsorption *a : m_vAdsorption)
+    if (a->getSpeciesName() == species)
+      net += m_vEvents[a->getIndex()] - m_vWindowEvents[a->getIndex()];
+
+  for (Desorption *d : m_vDesorption)
+    if (d->getSpeciesName() == species)
+      net -= m_vEvents[d->getIndex()] - m_vWindowEvents[d->getIndex()];
+
+  // The gas the surface reactions consume or release (e.g. recombinative desorption)
+  for (SurfaceReaction *s : m_vSurfaceReaction)
+    net -= s->getGasReleased(species) * (m_vEvents[s->getIndex()] - m_vWindowEvents[s->getIndex()]);
+
+  return net / (dt * pLattice->getSize());
+}
+
+void Apothesis::mf_countEvent(Process *p, long events)
+{
+  m_vEvents[p->getIndex()] += events;
+}
+
+void Apothesis::mf_openWindow()
+{
+  m_vWindowEvents = m_vEvents;
+  m_dWindowStart = m_time;
+}
+
+void Apothesis::mf_reschedule()
+{
+  if (pNextReaction)
+    pNextReaction->update(m_time);
+
+  if (pSelector)
+    pSelector->update();
+}
+
+void Apothesis::replay()
+{
+  if (m_vReplayTimes.empty())
+  {
+    pErrorHandler->error_simple_msg("No times to replay. Is it --replay <event stream> <time> ...?");
+    EXIT;
+  }
+
+  pReplay->run(m_vReplayTimes);
+}
+
+void Apothesis::mf_logProgress(unsigned int iterations)
+{
+  double roughness = pLattice->getRoughness();
+  pIO->writeLogOutput("Roughness: " + std::to_string(roughness));
+  pIO->writeLogOutput("Iterations: " + std::to_string(iterations));
+  if (pVoxels)
+    pIO->writeLogOutput("Vacancies: " + std::to_string(pVoxels->getNumVacancies()));
+}
+
+void Apothesis::mf_logTime(long double time)
+{
+  // The observation times may be much smaller than the six decimals of to_string
+  ostringstream ss;
+  ss << "Time: " << (double)time;
+  pIO->writeLogOutput(ss.str());
+}
+
+void Apothesis::mf_initObservations()
+{
+  pScheduler = pArena->create<ObservationScheduler>(this);
+
+  // The observers are called before the event that crosses their time is performed, so m_iter - 1 events are done.
+  vector<tuple<string, string, vector<double>>> observations = pTxtReader->getObservations();
+  for (int i = 0; i < (int)observations.size(); i++)
+  {
+    string observer = get<0>(observations[i]);
+    vector<long double> times = ObservationScheduler::grid(get<1>(observations[i]), get<2>(observations[i]), pTxtReader->getTime());
+    pIO->writeLogOutput("Observing " + observer + " at " + to_string(times.size()) + " times");
+
+    if (observer == "roughness")
+    {
+      pScheduler->addObserver(times, [this](long double time) {
+        mf_logTime(time);
+        mf_logProgress(m_iter - 1);
+      });
+    }
+    else if (observer == "heights")
+    {
+      pScheduler->addObserver(times, [this](long double time) {
+        if (pSnapshots)
+          pSnapshots->snapshot(time, m_iter - 1);
+        else
+        {
+          mf_logTime(time);
+          pIO->writeLatticeHeights();
+        }
+      });
+    }
+    else if (observer == "coverage")
+    {
+      // Only at the times of the scheduler if the observables are not sampled at an interval as well
+      if (!pObservables)
+      {
+        pObservables = pArena->create<Observables>(this, 0);
+        pObservables->init(m_bEmbedded ? "" : "Observables-700K", m_species, m_vProcesses);
+      }
+      pScheduler->addObserver(times, [this](long double time) { pObservables->observe(time); });
+    }
+    else if (observer == "morphology")
+    {
+      if (!pMorphology)
+      {
+        pMorphology = pArena->create<Morphology>(this, 0);
+        pMorphology->init("Morphology-700K");
+      }
+      pScheduler->addObserver(times, [this](long double time) { pMorphology->observe(time); });
     }
-    //pIO->writeLogOutput()
   }
 }
 
@@ -608,7 +1532,8 @@ vector<double> Apothesis::calculateProbabilities(vector<Process *> pProcesses)
   m_time += -log(random) / total;
 
   /// Print to output
-  pIO->writeLogOutput("Time step: " + to_string(m_time));
+  if (m_eventLog)
+    pIO->writeLogOutput("Time step: " + to_string(m_time));
 
   return probability;
 }
@@ -645,6 +1570,7 @@ Adsorption *Apothesis::findAdsorption(string species)
     // find name of adsorption species
   }
   pErrorHandler->warningSimple_msg("Warning! Could not find instance of Adsorption class for desorbed species " + species);
+  return 0;
 }
 
 Desorption *Apothesis::findDesorption(string species)
@@ -659,6 +1585,7 @@ Desorption *Apothesis::findDesorption(string species)
     // find name of adsorption species
   }
   cout << "Warning! Could not find instance of Adsorption class for desorbed species " << species << endl;
+  return 0;
 }
 
 IO *Apothesis::getIOPointer()
@@ -691,6 +1618,11 @@ vector<Adsorption *> Apothesis::getAdsorptionPointers()
   return m_vAdsorption;
 }
 
+vector<Desorption *> Apothesis::getDesorptionPointers()
+{
+  return m_vDesorption;
+}
+
 vector<SurfaceReaction *> Apothesis::getReactionPointers()
 {
   return m_vSurfaceReaction;
@@ -31,18 +31,37 @@ using namespace std;
 
 /** The basic class of the kinetic monte carlo code. */
 
-namespace Utils{ class ErrorHandler; class Parameters;}
+namespace Utils{ class ErrorHandler; class Parameters; class Arena; class MemoryReport;}
 namespace SurfaceTiles{ class Site; }
 namespace MicroProcesses { class Process; class Adsorption; class Desorption; class Diffusion; class SurfaceReaction;}
 class Lattice;
 class IO;
 //class Read;
 class TxtReader;
+class NextReaction;
+class HierarchicalSelector;
+class ProcessTable;
+class BoundaryLayer;
+class Observables;
+class Morphology;
+class VoxelLattice;
+class LateralInteractions;
+class Metrics;
+class SnapshotWriter;
+class TauLeaping;
+class ObservationScheduler;
+class EventRecorder;
+class EventReplay;
 
 class Apothesis
 {
 public:
     Apothesis( int argc, char* argv[] );
+
+    /// Embedded use (libapothesis): the input is given as text instead of ./input.txt.
+    /// Nothing is written in a log file and the heights are not written during the steps.
+    explicit Apothesis( const string& input );
+
     virtual ~Apothesis();
 
     /// Pointers to the classes that will share the common space i.e. the "pointer"
@@ -65,6 +84,51 @@ public:
     /// Pointer to the paramters class
     Utils::Parameters* pParameters;
 
+    /// Pointer to the arena that owns the lattice, the sites, the species and the processes
+    Utils::Arena* pArena;
+
+    /// Pointer to the next reaction method engine. Null if the BKL loop is used.
+    NextReaction* pNextReaction;
+
+    /// Pointer to the hierarchical event selection (engine tree). Null otherwise.
+    HierarchicalSelector* pSelector;
+
+    /// Pointer to the processes of the BKL loop grouped by their type (engine bkl). Null if another engine is used.
+    ProcessTable* pTable;
+
+    /// Pointer to the gas phase boundary layer. Null if the mass fractions are fixed.
+    BoundaryLayer* pBoundaryLayer;
+
+    /// Pointer to the observables sampled in simulation time. Null if not requested.
+    Observables* pObservables;
+
+    /// Pointer to the morphology analysis (PSD, correlation). Null if not requested.
+    Morphology* pMorphology;
+
+    /// Pointer to the 3D occupancy of the lattice. Null in the solid-on-solid mode.
+    VoxelLattice* pVoxels;
+
+    /// Pointer to the lateral interactions between adsorbed species. Null if there are none.
+    LateralInteractions* pInteractions;
+
+    /// Pointer to the live metrics of the run. Null if not requested.
+    Metrics* pMetrics;
+
+    /// Pointer to the asynchronous lattice snapshots. Null if the heights are written in the log.
+    SnapshotWriter* pSnapshots;
+
+    /// Pointer to the tau leaping of the adsorptions. Null if only exact steps are performed.
+    TauLeaping* pLeaping;
+
+    /// Pointer to the observations at given simulation times. Null if the output follows the number of events.
+    ObservationScheduler* pScheduler;
+
+    /// Pointer to the recorder of the event stream. Null if not requested.
+    EventRecorder* pRecorder;
+
+    /// Pointer to the replay of an event stream (--replay). Null in a simulation.
+    EventReplay* pReplay;
+
     /// Intialization of the KMC method. For example here the processes to be performed
     /// as these are written in the input file are constcucted through the factory method
     void init();
@@ -72,6 +136,62 @@ public:
     /// Perform the KMC iteratios
     void exec();
 
+    /// Perform events until the simulation time reaches time. The waiting time of the event
+    /// that would cross it is discarded, which is exact since it is memoryless. If no process can be performed
+    /// the time is set to time. Returns the number of events.
+    long advanceUntil( double time );
+
+    /// Perform at least n events (a leap may perform more) or stop when no process can be performed.
+    /// Returns the number of events.
+    long advanceEvents( long n );
+
+    /// Returns the simulation time [s]
+    inline double getTime(){ return m_time; }
+
+    /// Returns the number of events performed
+    inline long getEvents(){ return m_iter; }
+
+    /// Set the pressure [Pa] and reschedule the processes
+    void setPressure( double pressure );
+
+    /// Returns the pressure [Pa]
+    double getPressure();
+
+    /// Set the temperature [K] and recompute the rates of the processes
+    void setTemperature( double temperature );
+
+    /// Returns the temperature [K]
+    double getTemperature();
+
+    /// Set the mass fraction of the gas phase of an adsorbing species. False if no adsorption has this species.
+    /// Overwritten by the boundary layer if there is one.
+    bool setMassFraction( string species, double fraction );
+
+    /// Returns the mass fraction of an adsorbing species or -1 if no adsorption has this species
+    double getMassFraction( string species );
+
+    /// Returns the net flux of a species to the surface (adsorptions minus desorptions, with the gas the
+    /// surface reactions consume or release) [1/(site s)]
+    /// during the last advanceUntil or advanceEvents.
+    double getFlux( string species );
+
+    /// Rebuild the lattice at the times given with --replay from the event stream
+    void replay();
+
+    /// Returns true if the lattice is rebuilt from an event stream instead of simulated
+    inline bool isReplay(){ return !m_sReplayFile.empty(); }
+
+    /// Returns true if only the memory of the run is projected (--dry-run). The lattice is not built.
+    inline bool isDryRun(){ return m_bDryRun; }
+
+    /// Write the projected memory of the run from the dimensions of the lattice and the species and the
+    /// processes of the input. Nothing is allocated for the sites.
+    void estimateMemory();
+
+    /// Set the heights (negative ones are kept) and the species of the sites of the initialized lattice
+    /// and add the sites to the processes of the species. Used for a surface read from a file and the keyframes of a replay.
+    void setSurface(const vector<int> &heights, const vector<vector<Species *>> &species);
+
     /// Add a process
     void addProcess(string process);
 
@@ -107,6 +227,9 @@ public:
     /// Return access to adsorption
     vector<MicroProcesses::Adsorption*> getAdsorptionPointers();
 
+    /// Return access to desorption
+    vector<MicroProcesses::Desorption*> getDesorptionPointers();
+
     /// Return access to adsorption
     vector<MicroProcesses::SurfaceReaction*> getReactionPointers();
 
@@ -127,6 +250,12 @@ private:
 
     vector< MicroProcesses::SurfaceReaction*> m_vSurfaceReaction;
 
+    /// The processes created by the factory (plugin keyword). They are owned by Apothesis, not the arena.
+    vector< MicroProcesses::Process*> m_vPlugins;
+
+    /// The processes whose rate law reads the coverages. They are updated after every event.
+    vector< MicroProcesses::Process*> m_vCoverageDependent;
+
     vector <reference_wrapper<MicroProcesses::SurfaceReaction>> m_refSurfaceReaction;
 
     /// Vector holding the name of the processes (string)
@@ -147,6 +276,9 @@ private:
     // Set debug mode
     bool m_debugMode;
 
+    /// Write every event (time step and process) in the log
+    bool m_eventLog;
+
     /// number of species
     int m_nSpecies;
 
@@ -158,6 +290,55 @@ private:
 
     /// Write frequency
     int m_writeFrequency;
+
+    /// The event stream and the times to replay (--replay)
+    string m_sReplayFile;
+    vector<double> m_vReplayTimes;
+
+    /// Embedded use (no log file and no output during the steps)
+    bool m_bEmbedded;
+
+    /// Only the memory of the run is projected (--dry-run)
+    bool m_bDryRun;
+
+    /// The events of each process and their number at the start of the last advance call
+    vector< long > m_vEvents;
+    vector< long > m_vWindowEvents;
+
+    /// The time at the start of the last advance call
+    long double m_dWindowStart;
+
+    /// Both public constructors: the input is ./input.txt unless embedded
+    Apothesis( int argc, char* argv[], const string& input, bool embedded );
+
+    /// Perform a step (a leap or an event) that does not cross until. If the next event would cross it,
+    /// the time is set to until and false is returned. The same if no process can be performed (the time is
+    /// kept if until is infinite).
+    bool mf_step( long double until );
+
+    /// Count an event (or the events of a leap) of a process
+    void mf_countEvent( MicroProcesses::Process* p, long events = 1 );
+
+    /// Start the window of the fluxes at the current time
+    void mf_openWindow();
+
+    /// Reschedule the engines after the rates have changed outside of an event
+    void mf_reschedule();
+
+    /// Set the heights and the species of the sites from a file (read_lattice)
+    void mf_readLattice(string path);
+
+    /// Write the roughness, the iterations and the vacancies in the log
+    void mf_logProgress(unsigned int iterations);
+
+    /// Write an observation time in the log
+    void mf_logTime(long double time);
+
+    /// Register the observations of the input at given simulation times
+    void mf_initObservations();
+
+    /// Write the memory of each subsystem in the log
+    void mf_logMemory();
 };
 
 #endif // KMC_H
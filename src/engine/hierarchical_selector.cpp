@@ -0,0 +1,141 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "hierarchical_selector.h"
+#include "adsorption.h"
+#include "desorption.h"
+#include "diffusion.h"
+#include "memory_report.h"
+
+#include <cmath>
+
+using namespace MicroProcesses;
+
+HierarchicalSelector::HierarchicalSelector( Apothesis* apothesis ):Pointers( apothesis ){;}
+
+HierarchicalSelector::~HierarchicalSelector(){;}
+
+void HierarchicalSelector::init( vector< Process* > processes )
+{
+  m_vProcesses = processes;
+  m_vClass.resize( m_vProcesses.size() );
+  m_vPos.resize( m_vProcesses.size() );
+  m_vChannels.resize( m_vProcesses.size() );
+  m_vIsChanged.resize( m_vProcesses.size() );
+
+  for ( int i = 0; i < (int)m_vProcesses.size(); i++ ){
+    Process* p = m_vProcesses[ i ];
+
+    int c = REACTION;
+    if ( dynamic_cast< Adsorption* >( p ) )
+      c = ADSORPTION;
+    else if ( dynamic_cast< Desorption* >( p ) )
+      c = DESORPTION;
+    else if ( dynamic_cast< Diffusion* >( p ) )
+      c = DIFFUSION;
+
+    m_vClass[ i ] = c;
+    m_vPos[ i ] = m_vClassProcesses[ c ].size();
+    m_vClassProcesses[ c ].push_back( i );
+    m_mIndex[ p ] = i;
+
+    m_vChannels[ i ].init( p->getNumChannels() );
+    m_vIsChanged[ i ].assign( p->getNumChannels(), 0 );
+  }
+
+  m_classes.init( NUM_CLASSES );
+  for ( int c = 0; c < NUM_CLASSES; c++ )
+    m_processes[ c ].init( m_vClassProcesses[ c ].size() );
+
+  for ( int i = 0; i < (int)m_vProcesses.size(); i++ ){
+    for ( int k = 0; k < m_vProcesses[ i ]->getNumChannels(); k++ )
+      mf_update( i, k );
+
+    m_vProcesses[ i ]->setListener( this );
+  }
+}
+
+Process* HierarchicalSelector::pickProcess( long double& time )
+{
+  double total = m_classes.getTotal();
+  if ( total <= 0 )
+    return 0;
+
+  // One random number walks down the three levels
+  double value = (double)rand()/( (double)RAND_MAX + 1.0 )*total;
+  int c = m_classes.find( value );
+  int i = m_vClassProcesses[ c ][ m_processes[ c ].find( value ) ];
+  int channel = m_vChannels[ i ].find( value );
+
+  Process* p = m_vProcesses[ i ];
+  p->selectChannelSite( channel );
+
+  // Uniform in (0, 1] so that the log is finite
+  double random = ( (double)rand() + 1.0 )/( (double)RAND_MAX + 1.0 );
+  time += -log( random )/total;
+
+  return p;
+}
+
+void HierarchicalSelector::update()
+{
+  for ( size_t k = 0; k < m_vChanged.size(); k++ ){
+    int i = m_vChanged[ k ].first;
+    int channel = m_vChanged[ k ].second;
+    m_vIsChanged[ i ][ channel ] = 0;
+    mf_update( i, channel );
+  }
+  m_vChanged.clear();
+}
+
+void HierarchicalSelector::channelChanged( Process* p, int channel )
+{
+  int i = m_mIndex[ p ];
+  if ( m_vIsChanged[ i ][ channel ] )
+    return;
+
+  m_vIsChanged[ i ][ channel ] = 1;
+  m_vChanged.push_back( make_pair( i, channel ) );
+}
+
+void HierarchicalSelector::mf_update( int process, int channel )
+{
+  Utils::SumTree& channels = m_vChannels[ process ];
+  channels.update( channel, m_vProcesses[ process ]->getChannelProbability( channel ) );
+
+  int c = m_vClass[ process ];
+  m_processes[ c ].update( m_vPos[ process ], channels.getTotal() );
+  m_classes.update( c, m_processes[ c ].getTotal() );
+}
+
+void HierarchicalSelector::accountMemory( Utils::MemoryReport& report )
+{
+  size_t bytes = sizeof( HierarchicalSelector ) + Utils::MemoryReport::heap( m_vProcesses ) + Utils::MemoryReport::heap( m_vClass )
+               + Utils::MemoryReport::heap( m_vPos ) + Utils::MemoryReport::heap( m_mIndex ) + Utils::MemoryReport::heap( m_vChannels )
+               + Utils::MemoryReport::heap( m_vChanged ) + Utils::MemoryReport::heap( m_vIsChanged );
+  for ( int c = 0; c < NUM_CLASSES; c++ )
+    bytes += Utils::MemoryReport::heap( m_vClassProcesses[ c ] );
+  for ( vector< char >& flags : m_vIsChanged )
+    bytes += Utils::MemoryReport::heap( flags );
+  report.add( Utils::MemoryReport::ENGINE, bytes );
+
+  m_classes.accountMemory( report );
+  for ( int c = 0; c < NUM_CLASSES; c++ )
+    m_processes[ c ].accountMemory( report );
+  for ( Utils::SumTree& channels : m_vChannels )
+    channels.accountMemory( report );
+}
@@ -0,0 +1,95 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef HIERARCHICAL_SELECTOR_H
+#define HIERARCHICAL_SELECTOR_H
+
+#include <map>
+#include <vector>
+
+#include "pointers.h"
+#include "process.h"
+#include "sum_tree.h"
+
+using namespace std;
+
+/** Hierarchical event selection of the BKL method (engine tree).
+ * The processes are grouped in four classes (adsorption, desorption, diffusion and reactions).
+ * An event is selected in three levels, each a sum tree: the class by its total rate, the process
+ * (i.e. the species) within the class and the channel (the rate class i.e. the site group) within the
+ * process. The site is then picked in O(1) by the process. The processes notify the selector of the
+ * channels whose probability may have changed (see ChannelListener) and only these are recomputed after
+ * an event, so both the selection and the update are logarithmic in the number of processes and channels. */
+
+class HierarchicalSelector: public Pointers, public MicroProcesses::ChannelListener
+{
+public:
+    /// The classes of processes
+    enum Class{ ADSORPTION, DESORPTION, DIFFUSION, REACTION, NUM_CLASSES };
+
+    /// Constructor
+    HierarchicalSelector( Apothesis* apothesis );
+
+    /// Destructor
+    virtual ~HierarchicalSelector();
+
+    /// Groups the processes in classes, builds the trees and listens to the changes of their channels.
+    void init( vector< MicroProcesses::Process* > processes );
+
+    /// Returns the selected process with its site selected. The time is advanced by the exponential time step.
+    /// Null if the total rate is zero.
+    MicroProcesses::Process* pickProcess( long double& time );
+
+    /// Recomputes the channels that have changed since the last update.
+    void update();
+
+    /// Marks a channel as changed. Called by the processes.
+    void channelChanged( MicroProcesses::Process* p, int channel );
+
+    /// Adds the engine and its trees to the memory report.
+    void accountMemory( Utils::MemoryReport& report );
+
+private:
+    /// The processes, their class and their position in the tree of their class
+    vector< MicroProcesses::Process* > m_vProcesses;
+    vector< int > m_vClass;
+    vector< int > m_vPos;
+
+    /// The index of each process in m_vProcesses
+    map< MicroProcesses::Process*, int > m_mIndex;
+
+    /// The processes (their index) of each class in the order of their tree
+    vector< int > m_vClassProcesses[ NUM_CLASSES ];
+
+    /// Level 1: the total rate of each class
+    Utils::SumTree m_classes;
+
+    /// Level 2: the total rate of each process of a class
+    Utils::SumTree m_processes[ NUM_CLASSES ];
+
+    /// Level 3: the rate of each channel of a process
+    vector< Utils::SumTree > m_vChannels;
+
+    /// The channels that have changed since the last update and a flag per channel to list each once
+    vector< pair< int, int > > m_vChanged;
+    vector< vector< char > > m_vIsChanged;
+
+    /// Recomputes a channel and the sums above it.
+    void mf_update( int process, int channel );
+};
+
+#endif // HIERARCHICAL_SELECTOR_H
@@ -0,0 +1,104 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "indexed_heap.h"
+#include "memory_report.h"
+
+namespace Utils
+{
+
+IndexedHeap::IndexedHeap(){;}
+
+IndexedHeap::~IndexedHeap(){;}
+
+void IndexedHeap::init( const vector<double>& keys )
+{
+  m_vKeys = keys;
+  m_vHeap.resize( keys.size() );
+  m_vPos.resize( keys.size() );
+
+  for ( int i = 0; i < (int)keys.size(); i++ ){
+    m_vHeap[ i ] = i;
+    m_vPos[ i ] = i;
+  }
+
+  // Heapify bottom up
+  for ( int i = (int)keys.size()/2 - 1; i >= 0; i-- )
+    mf_siftDown( i );
+}
+
+void IndexedHeap::update( int item, double key )
+{
+  double old = m_vKeys[ item ];
+  m_vKeys[ item ] = key;
+
+  if ( key < old )
+    mf_siftUp( m_vPos[ item ] );
+  else
+    mf_siftDown( m_vPos[ item ] );
+}
+
+void IndexedHeap::mf_swap( int i, int j )
+{
+  int a = m_vHeap[ i ];
+  int b = m_vHeap[ j ];
+
+  m_vHeap[ i ] = b;
+  m_vHeap[ j ] = a;
+  m_vPos[ b ] = i;
+  m_vPos[ a ] = j;
+}
+
+void IndexedHeap::mf_siftUp( int i )
+{
+  while ( i > 0 ){
+    int parent = ( i - 1 )/2;
+    if ( m_vKeys[ m_vHeap[ parent ] ] <= m_vKeys[ m_vHeap[ i ] ] )
+      break;
+
+    mf_swap( i, parent );
+    i = parent;
+  }
+}
+
+void IndexedHeap::mf_siftDown( int i )
+{
+  int size = m_vHeap.size();
+  while ( true ){
+    int smallest = i;
+    int left = 2*i + 1;
+    int right = 2*i + 2;
+
+    if ( left < size && m_vKeys[ m_vHeap[ left ] ] < m_vKeys[ m_vHeap[ smallest ] ] )
+      smallest = left;
+    if ( right < size && m_vKeys[ m_vHeap[ right ] ] < m_vKeys[ m_vHeap[ smallest ] ] )
+      smallest = right;
+
+    if ( smallest == i )
+      break;
+
+    mf_swap( i, smallest );
+    i = smallest;
+  }
+}
+
+void IndexedHeap::accountMemory( MemoryReport& report )
+{
+  report.add( MemoryReport::ENGINE, MemoryReport::heap( m_vHeap ) + MemoryReport::heap( m_vPos ) + MemoryReport::heap( m_vKeys ) );
+}
+
+}
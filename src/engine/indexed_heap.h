@@ -0,0 +1,83 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef INDEXED_HEAP_H
+#define INDEXED_HEAP_H
+
+#include <vector>
+
+using namespace std;
+
+namespace Utils{
+
+class MemoryReport;
+
+/** A binary min-heap over a fixed set of items 0..n-1, each with a key.
+ * Every item knows its position in the heap so the key of any item can be
+ * changed in O(log n) and the item with the smallest key is found in O(1).
+ * This is the indexed priority queue of the next reaction method (Gibson and Bruck). */
+
+class IndexedHeap
+{
+public:
+    /// Constructor
+    IndexedHeap();
+
+    /// Destructor
+    virtual ~IndexedHeap();
+
+    /// Builds the heap for the items 0..keys.size()-1 with the given keys.
+    void init( const vector<double>& keys );
+
+    /// Changes the key of an item and restores the heap order.
+    void update( int item, double key );
+
+    /// Returns the item with the smallest key or -1 if the heap is empty.
+    inline int top() { return m_vHeap.empty() ? -1 : m_vHeap[ 0 ]; }
+
+    /// Returns the key of an item.
+    inline double getKey( int item ) { return m_vKeys[ item ]; }
+
+    /// Returns the number of items.
+    inline int getSize() { return m_vHeap.size(); }
+
+    /// Adds the heap and the keys (not the object, which is part of its owner) to the memory report.
+    void accountMemory( Utils::MemoryReport& report );
+
+private:
+    /// The items in heap order.
+    vector< int > m_vHeap;
+
+    /// The position of each item in m_vHeap.
+    vector< int > m_vPos;
+
+    /// The key of each item.
+    vector< double > m_vKeys;
+
+    /// Swaps the items at positions i and j of the heap.
+    void mf_swap( int i, int j );
+
+    /// Moves the item at position i up until its parent has a smaller key.
+    void mf_siftUp( int i );
+
+    /// Moves the item at position i down until its children have larger keys.
+    void mf_siftDown( int i );
+};
+
+}
+
+#endif // INDEXED_HEAP_H
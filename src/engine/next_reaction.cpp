@@ -0,0 +1,161 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "next_reaction.h"
+#include "process.h"
+#include "memory_report.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace MicroProcesses;
+
+NextReaction::NextReaction( Apothesis* apothesis ):Pointers( apothesis ),
+  m_iFired( -1 )
+{;}
+
+NextReaction::~NextReaction(){;}
+
+void NextReaction::init( vector< Process* > processes, long double time )
+{
+  m_vProcesses.clear();
+  m_vChannels.clear();
+  m_vRates.clear();
+
+  for ( vector< Process* >::iterator itr = processes.begin(); itr != processes.end(); ++itr ){
+    Process* p = *itr;
+    m_mFirst[ p ] = m_vRates.size();
+    for ( int c = 0; c < p->getNumChannels(); c++ ){
+      m_vProcesses.push_back( p );
+      m_vChannels.push_back( c );
+      m_vRates.push_back( p->getChannelProbability( c ) );
+    }
+  }
+
+  m_vRemaining.assign( m_vRates.size(), -1.0 );
+  m_vIsChanged.assign( m_vRates.size(), 0 );
+  m_vChanged.clear();
+  m_iFired = -1;
+
+  vector< double > times;
+  for ( int i = 0; i < (int)m_vRates.size(); i++ )
+    times.push_back( mf_firingTime( time, m_vRates[ i ], mf_exponential() ) );
+
+  m_heap.init( times );
+
+  for ( Process* p : processes )
+    p->setListener( this );
+}
+
+Process* NextReaction::pickProcess( long double& time )
+{
+  // No channel or none with a positive rate
+  if ( std::isinf( getNextTime() ) )
+    return 0;
+
+  m_iFired = m_heap.top();
+
+  time = m_heap.getKey( m_iFired );
+
+  Process* p = m_vProcesses[ m_iFired ];
+  p->selectChannelSite( m_vChannels[ m_iFired ] );
+  return p;
+}
+
+void NextReaction::update( long double time )
+{
+  // The channel that fired draws a new random number even if its rate has not changed
+  if ( m_iFired >= 0 && !m_vIsChanged[ m_iFired ] ){
+    m_vIsChanged[ m_iFired ] = 1;
+    m_vChanged.push_back( m_iFired );
+  }
+
+  // In the order of the channels so that the random numbers are drawn in the same order in every run
+  sort( m_vChanged.begin(), m_vChanged.end() );
+  for ( int i : m_vChanged ){
+    m_vIsChanged[ i ] = 0;
+    mf_reschedule( i, time );
+  }
+  m_vChanged.clear();
+  m_iFired = -1;
+}
+
+void NextReaction::channelChanged( Process* p, int channel )
+{
+  int i = m_mFirst[ p ] + channel;
+  if ( m_vIsChanged[ i ] )
+    return;
+
+  m_vIsChanged[ i ] = 1;
+  m_vChanged.push_back( i );
+}
+
+void NextReaction::mf_reschedule( int i, long double time )
+{
+  double rate = m_vProcesses[ i ]->getChannelProbability( m_vChannels[ i ] );
+
+  // The channel that fired draws a new random number
+  if ( i == m_iFired ){
+    m_vRates[ i ] = rate;
+    m_vRemaining[ i ] = -1.0;
+    m_heap.update( i, mf_firingTime( time, rate, mf_exponential() ) );
+    return;
+  }
+
+  double old = m_vRates[ i ];
+  if ( rate == old )
+    return;
+
+  m_vRates[ i ] = rate;
+
+  if ( old > 0 && rate > 0 )
+    m_heap.update( i, time + ( old/rate )*( m_heap.getKey( i ) - time ) );
+  else if ( old > 0 ){
+    // Keep the remaining internal time for when the channel becomes active again
+    m_vRemaining[ i ] = old*( m_heap.getKey( i ) - time );
+    m_heap.update( i, numeric_limits< double >::infinity() );
+  }
+  else {
+    double tau = m_vRemaining[ i ] >= 0 ? m_vRemaining[ i ] : mf_exponential();
+    m_vRemaining[ i ] = -1.0;
+    m_heap.update( i, mf_firingTime( time, rate, tau ) );
+  }
+}
+
+double NextReaction::mf_exponential()
+{
+  // Uniform in (0, 1] so that the log is finite
+  double random = ( (double)rand() + 1.0 )/( (double)RAND_MAX + 1.0 );
+  return -log( random );
+}
+
+double NextReaction::mf_firingTime( long double time, double a, double tau )
+{
+  if ( a <= 0 )
+    return numeric_limits< double >::infinity();
+
+  return time + tau/a;
+}
+
+void NextReaction::accountMemory( Utils::MemoryReport& report )
+{
+  report.add( Utils::MemoryReport::ENGINE, sizeof( NextReaction ) + Utils::MemoryReport::heap( m_vProcesses ) + Utils::MemoryReport::heap( m_vChannels )
+              + Utils::MemoryReport::heap( m_vRates ) + Utils::MemoryReport::heap( m_vRemaining ) + Utils::MemoryReport::heap( m_mFirst )
+              + Utils::MemoryReport::heap( m_vChanged ) + Utils::MemoryReport::heap( m_vIsChanged ) );
+  m_heap.accountMemory( report );
+}
@@ -0,0 +1,107 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef NEXT_REACTION_H
+#define NEXT_REACTION_H
+
+#include <limits>
+#include <map>
+#include <vector>
+
+#include "pointers.h"
+#include "process.h"
+#include "indexed_heap.h"
+
+using namespace std;
+
+/** The next reaction method of Gibson and Bruck as an alternative to the BKL loop of Apothesis::exec.
+ * Every channel i.e. a rate class of a process (see Process::getNumChannels) has a putative firing
+ * time stored in an indexed binary heap. After each event only the channel that fired draws a new
+ * random number. The channels whose rate has changed are rescheduled by rescaling their remaining
+ * time (a_old/a_new)(tau - t) so their random numbers are reused, and the rest are not touched.
+ * The processes notify the engine of the channels whose rate may have changed (see ChannelListener),
+ * so only these (the dependants of the event) are recomputed.
+ * When a rate drops to zero the remaining internal time is kept and used once it becomes non zero again. */
+
+class NextReaction: public Pointers, public MicroProcesses::ChannelListener
+{
+public:
+    /// Constructor
+    NextReaction( Apothesis* apothesis );
+
+    /// Destructor
+    virtual ~NextReaction();
+
+    /// Builds the channels of the processes, draws their first firing times and listens to the changes of the channels.
+    void init( vector< MicroProcesses::Process* > processes, long double time );
+
+    /// Returns the process of the channel that fires first with its site selected.
+    /// The time is advanced to the firing time of the channel. Null if no channel can fire.
+    MicroProcesses::Process* pickProcess( long double& time );
+
+    /// Returns the firing time of the channel that fires first (infinity if no channel can fire).
+    inline long double getNextTime() { return m_heap.getSize() == 0 ? numeric_limits< long double >::infinity() : m_heap.getKey( m_heap.top() ); }
+
+    /// Recomputes the channel that fired and the channels that have changed since the last update and reschedules them.
+    void update( long double time );
+
+    /// Marks a channel as changed. Called by the processes.
+    void channelChanged( MicroProcesses::Process* p, int channel );
+
+    /// Returns the number of channels.
+    inline int getNumChannels() { return m_vRates.size(); }
+
+    /// Adds the engine and its queue of the channels to the memory report.
+    void accountMemory( Utils::MemoryReport& report );
+
+private:
+    /// The process of each channel.
+    vector< MicroProcesses::Process* > m_vProcesses;
+
+    /// The channel of each channel in its process.
+    vector< int > m_vChannels;
+
+    /// The current rate of each channel.
+    vector< double > m_vRates;
+
+    /// The remaining internal time of the channels with zero rate or -1 if none is stored.
+    vector< double > m_vRemaining;
+
+    /// The putative firing times.
+    Utils::IndexedHeap m_heap;
+
+    /// The channel that fired last.
+    int m_iFired;
+
+    /// The index of the first channel of each process
+    map< MicroProcesses::Process*, int > m_mFirst;
+
+    /// The channels that have changed since the last update and a flag per channel to list each once
+    vector< int > m_vChanged;
+    vector< char > m_vIsChanged;
+
+    /// Recomputes the rate of a channel and reschedules it.
+    void mf_reschedule( int i, long double time );
+
+    /// Returns an exponentially distributed random number with unit mean.
+    double mf_exponential();
+
+    /// Returns the firing time of a channel with rate a and internal time tau after time.
+    double mf_firingTime( long double time, double a, double tau );
+};
+
+#endif // NEXT_REACTION_H
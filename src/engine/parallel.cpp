@@ -0,0 +1,38 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "parallel.h"
+
+namespace Utils
+{
+
+int getNumThreads()
+{
+  static int threads = thread::hardware_concurrency() > 0 ? thread::hardware_concurrency() : 1;
+  return threads;
+}
+
+int getNumChunks( long begin, long end )
+{
+  long chunks = ( end - begin )/PARALLEL_GRAIN;
+  if ( chunks > getNumThreads() )
+    chunks = getNumThreads();
+
+  return chunks > 1 ? chunks : 1;
+}
+
+}
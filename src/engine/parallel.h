@@ -0,0 +1,71 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace Utils {
+
+/// The number of threads used by parallelFor (the hardware threads).
+int getNumThreads();
+
+/// The number of chunks parallelFor splits [begin, end) into. Ranges smaller than
+/// PARALLEL_GRAIN sites per thread are not split.
+int getNumChunks( long begin, long end );
+
+/// The smallest chunk worth a thread
+const long PARALLEL_GRAIN = 16384;
+
+/** Calls f( chunk, lo, hi ) for contiguous chunks [lo, hi) of [begin, end), each on its own thread
+ * (the first one on the calling thread), and returns when all of them are done. The chunks are numbered
+ * in the order of the range so results gathered per chunk can be merged in that order, which keeps the
+ * outcome identical to a serial loop. f must only write to the elements of its own chunk. */
+template< class F >
+void parallelFor( long begin, long end, F f )
+{
+  int chunks = getNumChunks( begin, end );
+  if ( chunks <= 1 ){
+    if ( end > begin )
+      f( 0, begin, end );
+    return;
+  }
+
+  long size = ( end - begin + chunks - 1 )/chunks;
+
+  vector< thread > workers;
+  for ( int c = 1; c < chunks; c++ ){
+    long lo = begin + c*size;
+    long hi = lo + size < end ? lo + size : end;
+    if ( lo >= hi )
+      break;
+    workers.push_back( thread( f, c, lo, hi ) );
+  }
+
+  f( 0, begin, begin + size );
+
+  for ( thread& t : workers )
+    t.join();
+}
+
+}
+
+#endif // PARALLEL_H
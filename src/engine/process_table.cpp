@@ -0,0 +1,148 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "process_table.h"
+#include "adsorption.h"
+#include "desorption.h"
+#include "diffusion.h"
+#include "SurfaceReaction.h"
+#include "memory_report.h"
+
+using namespace MicroProcesses;
+
+ProcessTable::ProcessTable( Apothesis* apothesis ):Pointers( apothesis ),
+  m_dTotal( 0 )
+{;}
+
+ProcessTable::~ProcessTable(){;}
+
+void ProcessTable::init( vector< Process* > processes )
+{
+  m_vProcesses = processes;
+  m_vKind.resize( m_vProcesses.size() );
+  m_vIndex.resize( m_vProcesses.size() );
+  m_vProbabilities.assign( m_vProcesses.size(), 0.0 );
+  m_vCumulative.assign( m_vProcesses.size(), 0.0 );
+
+  // The kinds are resolved once here and never again in the loop
+  for ( int i = 0; i < (int)m_vProcesses.size(); i++ ){
+    Process* p = m_vProcesses[ i ];
+
+    int k;
+    if ( Adsorption* a = dynamic_cast< Adsorption* >( p ) ){
+      k = ADSORPTION;
+      m_vIndex[ i ] = m_vAdsorption.size();
+      m_vAdsorption.push_back( a );
+    }
+    else if ( Desorption* d = dynamic_cast< Desorption* >( p ) ){
+      k = DESORPTION;
+      m_vIndex[ i ] = m_vDesorption.size();
+      m_vDesorption.push_back( d );
+    }
+    else if ( Diffusion* df = dynamic_cast< Diffusion* >( p ) ){
+      k = DIFFUSION;
+      m_vIndex[ i ] = m_vDiffusion.size();
+      m_vDiffusion.push_back( df );
+    }
+    else if ( SurfaceReaction* r = dynamic_cast< SurfaceReaction* >( p ) ){
+      k = REACTION;
+      m_vIndex[ i ] = m_vReaction.size();
+      m_vReaction.push_back( r );
+    }
+    else {
+      k = PLUGIN;
+      m_vIndex[ i ] = m_vPlugin.size();
+      m_vPlugin.push_back( p );
+    }
+
+    m_vKind[ i ] = k;
+    m_vPosition[ k ].push_back( i );
+  }
+}
+
+template< class T >
+void ProcessTable::mf_probabilities( const vector< T* >& processes, const vector< int >& positions )
+{
+  for ( int i = 0; i < (int)processes.size(); i++ )
+    m_vProbabilities[ positions[ i ] ] = processes[ i ]->getProbability();
+}
+
+double ProcessTable::calculateProbabilities()
+{
+  mf_probabilities( m_vAdsorption, m_vPosition[ ADSORPTION ] );
+  mf_probabilities( m_vDesorption, m_vPosition[ DESORPTION ] );
+  mf_probabilities( m_vDiffusion, m_vPosition[ DIFFUSION ] );
+  mf_probabilities( m_vReaction, m_vPosition[ REACTION ] );
+  mf_probabilities( m_vPlugin, m_vPosition[ PLUGIN ] );
+
+  // Summed in the order of the processes as in Apothesis::calculateProbabilities
+  m_dTotal = 0;
+  for ( int i = 0; i < (int)m_vProbabilities.size(); i++ ){
+    m_vCumulative[ i ] = m_vProbabilities[ i ] + m_dTotal;
+    m_dTotal += m_vProbabilities[ i ];
+  }
+
+  return m_dTotal;
+}
+
+int ProcessTable::pickProcess( double random )
+{
+  int picked = m_vCumulative.size() - 1;
+  for ( int i = 0; i < (int)m_vCumulative.size(); i++ )
+    if ( random < m_vCumulative[ i ]/m_dTotal ){
+      picked = i;
+      break;
+    }
+
+  mf_selectSite( picked );
+  return picked;
+}
+
+void ProcessTable::mf_selectSite( int i )
+{
+  int k = m_vIndex[ i ];
+  switch ( m_vKind[ i ] ){
+    case ADSORPTION: m_vAdsorption[ k ]->selectSite(); break;
+    case DESORPTION: m_vDesorption[ k ]->selectSite(); break;
+    case DIFFUSION: m_vDiffusion[ k ]->selectSite(); break;
+    case REACTION: m_vReaction[ k ]->selectSite(); break;
+    default: m_vPlugin[ k ]->selectSite();
+  }
+}
+
+void ProcessTable::perform( int i )
+{
+  int k = m_vIndex[ i ];
+  switch ( m_vKind[ i ] ){
+    case ADSORPTION: m_vAdsorption[ k ]->perform(); break;
+    case DESORPTION: m_vDesorption[ k ]->perform(); break;
+    case DIFFUSION: m_vDiffusion[ k ]->perform(); break;
+    case REACTION: m_vReaction[ k ]->perform(); break;
+    default: m_vPlugin[ k ]->perform();
+  }
+}
+
+void ProcessTable::accountMemory( Utils::MemoryReport& report )
+{
+  size_t bytes = sizeof( ProcessTable ) + Utils::MemoryReport::heap( m_vProcesses ) + Utils::MemoryReport::heap( m_vKind )
+               + Utils::MemoryReport::heap( m_vIndex ) + Utils::MemoryReport::heap( m_vAdsorption ) + Utils::MemoryReport::heap( m_vDesorption )
+               + Utils::MemoryReport::heap( m_vDiffusion ) + Utils::MemoryReport::heap( m_vReaction ) + Utils::MemoryReport::heap( m_vPlugin )
+               + Utils::MemoryReport::heap( m_vProbabilities ) + Utils::MemoryReport::heap( m_vCumulative );
+  for ( int k = 0; k < NUM_KINDS; k++ )
+    bytes += Utils::MemoryReport::heap( m_vPosition[ k ] );
+  report.add( Utils::MemoryReport::ENGINE, bytes );
+}
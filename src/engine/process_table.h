@@ -0,0 +1,102 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef PROCESS_TABLE_H
+#define PROCESS_TABLE_H
+
+#include <vector>
+
+#include "pointers.h"
+#include "process.h"
+
+using namespace std;
+
+namespace MicroProcesses { class Adsorption; class Desorption; class Diffusion; class SurfaceReaction; }
+
+/** The processes of the BKL loop grouped by their concrete type (engine bkl).
+ * The kinds of processes of Apothesis are a closed set of final classes. Each kind is kept in its
+ * own array of pointers to its class, so the probabilities of the processes of a kind are computed
+ * in one loop whose calls are resolved at compile time (and inlined where the class defines them in
+ * its header), and the site selection and the perform of the picked process go through a switch on its
+ * kind instead of the virtual table. Any other process (an out-of-tree process created by the
+ * FactoryProcess, see the plugin keyword) is kept in an array of Process* and called virtually.
+ * The cumulative probabilities follow the order of the processes given to init, so the picked
+ * process is the same as that of calculateProbabilities and pickProcess of Apothesis. */
+
+class ProcessTable: public Pointers
+{
+public:
+    /// The kinds of processes
+    enum Kind{ ADSORPTION, DESORPTION, DIFFUSION, REACTION, PLUGIN, NUM_KINDS };
+
+    /// Constructor
+    ProcessTable( Apothesis* apothesis );
+
+    /// Destructor
+    virtual ~ProcessTable();
+
+    /// Groups the processes by their kind. Their order is the order of the cumulative probabilities.
+    void init( vector< MicroProcesses::Process* > processes );
+
+    /// Computes the probability of every process and returns their sum.
+    double calculateProbabilities();
+
+    /// Returns the index of the process where random (in [0, 1)) falls in the cumulative probabilities
+    /// of the last calculateProbabilities, with its site selected.
+    int pickProcess( double random );
+
+    /// Performs the process of an index.
+    void perform( int i );
+
+    /// Returns the process of an index.
+    inline MicroProcesses::Process* getProcess( int i ) { return m_vProcesses[ i ]; }
+
+    /// Adds the table to the memory report.
+    void accountMemory( Utils::MemoryReport& report );
+
+private:
+    /// The processes in the order of the cumulative probabilities, their kind and their index in the array of their kind
+    vector< MicroProcesses::Process* > m_vProcesses;
+    vector< int > m_vKind;
+    vector< int > m_vIndex;
+
+    /// The processes of each kind
+    vector< MicroProcesses::Adsorption* > m_vAdsorption;
+    vector< MicroProcesses::Desorption* > m_vDesorption;
+    vector< MicroProcesses::Diffusion* > m_vDiffusion;
+    vector< MicroProcesses::SurfaceReaction* > m_vReaction;
+    vector< MicroProcesses::Process* > m_vPlugin;
+
+    /// The index (in m_vProcesses) of the processes of each kind
+    vector< int > m_vPosition[ NUM_KINDS ];
+
+    /// The probability of each process and the cumulative probabilities
+    vector< double > m_vProbabilities;
+    vector< double > m_vCumulative;
+
+    /// The sum of the probabilities
+    double m_dTotal;
+
+    /// Computes the probabilities of the processes of a kind
+    template< class T >
+    void mf_probabilities( const vector< T* >& processes, const vector< int >& positions );
+
+    /// Selects the site of the process of an index
+    void mf_selectSite( int i );
+};
+
+#endif // PROCESS_TABLE_H
@@ -0,0 +1,72 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "sum_tree.h"
+#include "memory_report.h"
+
+namespace Utils
+{
+
+SumTree::SumTree():m_iSize( 0 ), m_iLeaves( 1 ), m_vNodes( 2, 0.0 ){;}
+
+SumTree::~SumTree(){;}
+
+void SumTree::init( int n )
+{
+  m_iSize = n;
+  m_iLeaves = 1;
+  while ( m_iLeaves < n )
+    m_iLeaves *= 2;
+
+  m_vNodes.assign( 2*m_iLeaves, 0.0 );
+}
+
+void SumTree::update( int item, double weight )
+{
+  int i = m_iLeaves + item;
+  m_vNodes[ i ] = weight;
+
+  for ( i /= 2; i >= 1; i /= 2 )
+    m_vNodes[ i ] = m_vNodes[ 2*i ] + m_vNodes[ 2*i + 1 ];
+}
+
+int SumTree::find( double& value )
+{
+  int i = 1;
+  while ( i < m_iLeaves ){
+    double left = m_vNodes[ 2*i ];
+    // Round-off may leave value just above the total: then the right child is taken if it has weight
+    if ( value < left || m_vNodes[ 2*i + 1 ] <= 0.0 )
+      i = 2*i;
+    else {
+      value -= left;
+      i = 2*i + 1;
+    }
+  }
+
+  if ( value >= m_vNodes[ i ] )
+    value = 0.0;
+
+  return i - m_iLeaves;
+}
+
+void SumTree::accountMemory( MemoryReport& report )
+{
+  report.add( MemoryReport::ENGINE, MemoryReport::heap( m_vNodes ) );
+}
+
+}
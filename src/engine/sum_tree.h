@@ -0,0 +1,78 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef SUM_TREE_H
+#define SUM_TREE_H
+
+#include <vector>
+
+using namespace std;
+
+namespace Utils{
+
+class MemoryReport;
+
+/** A complete binary tree over the weights of the items 0..n-1 where every node holds the sum of its children.
+ * Changing a weight recomputes the sums on the path to the root and finding the item where a cumulative value
+ * falls walks from the root down, so both are O(log n). The sums are recomputed from the children (not
+ * incremented) so round-off does not accumulate over the updates. */
+
+class SumTree
+{
+public:
+    /// Constructor
+    SumTree();
+
+    /// Destructor
+    virtual ~SumTree();
+
+    /// Builds the tree for n items with zero weight.
+    void init( int n );
+
+    /// Changes the weight of an item.
+    void update( int item, double weight );
+
+    /// Returns the weight of an item.
+    inline double getWeight( int item ) { return m_vNodes[ m_iLeaves + item ]; }
+
+    /// Returns the sum of the weights.
+    inline double getTotal() { return m_vNodes[ 1 ]; }
+
+    /// Returns the number of items.
+    inline int getSize() { return m_iSize; }
+
+    /// Returns the item where value (in [0, total)) falls in the cumulative weights and subtracts from value
+    /// the weights before the item, so value is then in [0, weight of the item). Items of zero weight are never returned.
+    int find( double& value );
+
+    /// Adds the nodes (not the object, which is part of its owner) to the memory report.
+    void accountMemory( Utils::MemoryReport& report );
+
+private:
+    /// The number of items.
+    int m_iSize;
+
+    /// The number of leaves (a power of two).
+    int m_iLeaves;
+
+    /// The nodes: the root is 1, the children of node i are 2i and 2i+1 and the leaves start at m_iLeaves.
+    vector< double > m_vNodes;
+};
+
+}
+
+#endif // SUM_TREE_H
@@ -0,0 +1,164 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "tau_leaping.h"
+#include "adsorption.h"
+#include "memory_report.h"
+
+#include <algorithm>
+
+using namespace MicroProcesses;
+
+TauLeaping::TauLeaping( Apothesis* apothesis, double epsilon ):Pointers( apothesis ),
+  m_dEpsilon( epsilon ),
+  m_dTau( 0 ),
+  m_iExactSteps( 0 ),
+  m_lLeaps( 0 ),
+  m_lEvents( 0 )
+{;}
+
+TauLeaping::~TauLeaping(){;}
+
+void TauLeaping::init( vector< Adsorption* > adsorptions, vector< Process* > processes )
+{
+  m_vAdsorption = adsorptions;
+  m_vCounts.assign( m_vAdsorption.size(), 0 );
+
+  for ( Process* p:processes )
+    if ( find( m_vAdsorption.begin(), m_vAdsorption.end(), p ) == m_vAdsorption.end() )
+      m_vOthers.push_back( p );
+  m_vOtherCounts.assign( m_vOthers.size(), 0 );
+
+  m_generator.seed( rand() );
+}
+
+bool TauLeaping::plan()
+{
+  if ( m_iExactSteps > 0 ){
+    m_iExactSteps--;
+    return false;
+  }
+
+  // The total rate of the adsorptions and the largest rate per site
+  double adsorption = 0;
+  double maxFlux = 0;
+  for ( Adsorption* a:m_vAdsorption ){
+    if ( a->getNumSites() == 0 )
+      continue;
+
+    double rate = a->getProbability();
+    adsorption += rate;
+    maxFlux = max( maxFlux, rate/a->getNumSites() );
+  }
+
+  vector< double > rates( m_vOthers.size() );
+  double others = 0;
+  for ( int i = 0; i < (int)m_vOthers.size(); i++ ){
+    rates[ i ] = m_vOthers[ i ]->getProbability();
+    others += rates[ i ];
+  }
+
+  // The adsorptions must dominate, otherwise the rest would change the rates too much within a leap
+  if ( adsorption <= 0 || others > m_dEpsilon*( adsorption + others ) ){
+    m_iExactSteps = EXACT_STEPS;
+    return false;
+  }
+
+  m_dTau = m_dEpsilon/maxFlux;
+  if ( adsorption*m_dTau < MIN_EVENTS ){
+    m_iExactSteps = EXACT_STEPS;
+    return false;
+  }
+
+  for ( int i = 0; i < (int)m_vAdsorption.size(); i++ ){
+    double mean = 0;
+    if ( m_vAdsorption[ i ]->getNumSites() > 0 )
+      mean = m_vAdsorption[ i ]->getProbability()*m_dTau;
+
+    m_vCounts[ i ] = mean > 0 ? poisson_distribution< long >( mean )( m_generator ):0;
+  }
+
+  // The events of the rest are split over them by their rates (a multinomial, drawn as conditional binomials)
+  long left = others > 0 ? poisson_distribution< long >( others*m_dTau )( m_generator ):0;
+  for ( int i = 0; i < (int)m_vOthers.size(); i++ ){
+    m_vOtherCounts[ i ] = left > 0 && rates[ i ] > 0 ? binomial_distribution< long >( left, min( 1.0, rates[ i ]/others ) )( m_generator ):0;
+    left -= m_vOtherCounts[ i ];
+    others -= rates[ i ];
+  }
+
+  return true;
+}
+
+long TauLeaping::perform( function< void( Process*, long ) > performed, function< void( Process* ) > event )
+{
+  int adsorptions = m_vAdsorption.size();
+
+  m_vOrder.clear();
+  for ( int i = 0; i < adsorptions; i++ )
+    if ( m_vCounts[ i ] > 0 )
+      m_vOrder.push_back( i );
+  for ( int i = 0; i < (int)m_vOthers.size(); i++ )
+    if ( m_vOtherCounts[ i ] > 0 )
+      m_vOrder.push_back( adsorptions + i );
+
+  shuffle( m_vOrder.begin(), m_vOrder.end(), m_generator );
+
+  long events = 0;
+  bool conflict = false;
+  for ( int i:m_vOrder ){
+    Process* p;
+    long count, n = 0;
+    if ( i < adsorptions ){
+      Adsorption* a = m_vAdsorption[ i ];
+      p = a;
+      count = m_vCounts[ i ];
+      n = a->performBulk( count, event ? function< void() >( [&](){ event( a ); } ):nullptr );
+    }
+    else{
+      // The rest of the processes carry a fraction epsilon of the events and are performed one by one
+      p = m_vOthers[ i - adsorptions ];
+      count = m_vOtherCounts[ i - adsorptions ];
+      for ( ; n < count && p->getProbability() > 0; n++ ){
+        p->selectSite();
+        p->perform();
+        if ( event )
+          event( p );
+      }
+    }
+
+    if ( n < count )
+      conflict = true;
+    if ( n > 0 )
+      performed( p, n );
+    events += n;
+  }
+
+  // The leap was too long for the available sites. Continue with exact steps for a while.
+  if ( conflict )
+    m_iExactSteps = EXACT_STEPS;
+
+  m_lLeaps++;
+  m_lEvents += events;
+
+  return events;
+}
+
+void TauLeaping::accountMemory( Utils::MemoryReport& report )
+{
+  report.add( Utils::MemoryReport::ENGINE, sizeof( TauLeaping ) + Utils::MemoryReport::heap( m_vAdsorption ) + Utils::MemoryReport::heap( m_vOthers )
+              + Utils::MemoryReport::heap( m_vCounts ) + Utils::MemoryReport::heap( m_vOtherCounts ) + Utils::MemoryReport::heap( m_vOrder ) );
+}
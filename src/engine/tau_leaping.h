@@ -0,0 +1,109 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef TAU_LEAPING_H
+#define TAU_LEAPING_H
+
+#include <vector>
+#include <random>
+#include <functional>
+
+#include "pointers.h"
+
+using namespace std;
+
+namespace MicroProcesses { class Process; class Adsorption; }
+
+/** Approximate tau leaping of the adsorptions for high flux regimes (tau_leaping <epsilon>).
+ * When the adsorptions carry all but a fraction epsilon of the total rate, a leap of length tau fires a
+ * Poisson distributed number of events of each adsorption (mean a_i tau) and of the rest of the processes
+ * (mean a_other tau, split over them by their rates). Each adsorption removes about one of its N_i sites, so the
+ * relative change of its rate a_i = N_i f_i is f_i tau and tau = epsilon / max f_i bounds it by epsilon.
+ * The events of each process are performed in bulk, the processes in a random order, so a leap computes no rates,
+ * selects no process and counts no event one by one. The events of a leap do not conflict: each one picks its
+ * site among the sites available after the previous ones. If a process has run out of sites before its events are
+ * fired (a conflict), or the tolerance does not allow a leap, or a leap would fire too few events to pay off,
+ * exact BKL steps are performed instead. */
+
+class TauLeaping: public Pointers
+{
+public:
+    /// Constructor
+    TauLeaping( Apothesis* apothesis, double epsilon );
+
+    /// Destructor
+    virtual ~TauLeaping();
+
+    /// Sets the adsorptions that are leaped and the rest of the processes.
+    void init( vector< MicroProcesses::Adsorption* > adsorptions, vector< MicroProcesses::Process* > processes );
+
+    /// Returns true if a leap is taken from the current state. Then the leap size and the number of events are set.
+    /// Returns false if an exact step must be performed instead.
+    bool plan();
+
+    /// Returns the size of the planned leap [s]
+    inline double getTau(){ return m_dTau; }
+
+    /// Fires the events of the planned leap. performed is called after the events of each process with their number.
+    /// If given, event is called after each event with the process performed (its site is still the one of the event).
+    /// Returns the number of events performed.
+    long perform( function< void( MicroProcesses::Process*, long ) > performed, function< void( MicroProcesses::Process* ) > event = nullptr );
+
+    /// Returns the number of leaps and of the events fired in the leaps
+    inline long getNumLeaps(){ return m_lLeaps; }
+    inline long getNumEvents(){ return m_lEvents; }
+
+    /// Adds the leaping and its counts to the memory report.
+    void accountMemory( Utils::MemoryReport& report );
+
+private:
+    /// The error tolerance on the relative change of the rates
+    double m_dEpsilon;
+
+    /// The adsorptions and the rest of the processes
+    vector< MicroProcesses::Adsorption* > m_vAdsorption;
+    vector< MicroProcesses::Process* > m_vOthers;
+
+    /// The size of the planned leap
+    double m_dTau;
+
+    /// The number of events of each adsorption and of each of the rest of the processes in the planned leap
+    vector< long > m_vCounts;
+    vector< long > m_vOtherCounts;
+
+    /// The processes of a leap in the order they are fired: the index of the adsorption, or the index of
+    /// one of the rest of the processes after the adsorptions
+    vector< int > m_vOrder;
+
+    /// The exact steps left before a leap is tried again
+    int m_iExactSteps;
+
+    /// Statistics
+    long m_lLeaps;
+    long m_lEvents;
+
+    /// The generator of the Poisson numbers and of the order of the processes. It is seeded by rand().
+    mt19937 m_generator;
+
+    /// Below this expected number of events an exact step is cheaper and more accurate than a leap
+    static const int MIN_EVENTS = 10;
+
+    /// The exact steps performed after a leap is rejected
+    static const int EXACT_STEPS = 100;
+};
+
+#endif // TAU_LEAPING_H
@@ -0,0 +1,152 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "boundary_layer.h"
+#include "adsorption.h"
+#include "desorption.h"
+#include "parameters.h"
+#include "errorhandler.h"
+#include "lattice.h"
+#include "io.h"
+#include "species.h"
+
+using namespace MicroProcesses;
+
+BoundaryLayer::BoundaryLayer( Apothesis* apothesis, double thickness, int nodes, double diffusivity, double interval, double carrierMW ):
+  Pointers( apothesis ),
+  m_dThickness( thickness ),
+  m_iNodes( nodes ),
+  m_dDiffusivity( diffusivity ),
+  m_dInterval( interval ),
+  m_dCarrierMW( carrierMW/1000. ),
+  m_lastTime( 0 )
+{
+  if ( m_iNodes < 2 || m_dThickness <= 0 || m_dDiffusivity <= 0 || m_dInterval <= 0 || m_dCarrierMW <= 0 ){
+    m_errorHandler->error_simple_msg( "The boundary layer needs at least 2 nodes and positive thickness, diffusivity, coupling interval and carrier gas molecular weight." );
+    EXIT;
+  }
+}
+
+BoundaryLayer::~BoundaryLayer(){;}
+
+void BoundaryLayer::init( vector< Adsorption* > adsorption, vector< Desorption* > desorption )
+{
+  m_vAdsorption = adsorption;
+
+  for ( int i = 0; i < (int)m_vAdsorption.size(); i++ ){
+    Adsorption* a = m_vAdsorption[ i ];
+
+    Desorption* d = 0;
+    for ( int j = 0; j < (int)desorption.size(); j++ )
+      if ( !a->getSpeciesName().compare( desorption[ j ]->getSpeciesName() ) )
+        d = desorption[ j ];
+
+    m_vDesorption.push_back( d );
+    m_vBulk.push_back( a->getMassFraction() );
+    m_vProfiles.push_back( vector< double >( m_iNodes, a->getMassFraction() ) );
+    m_vLastAds.push_back( a->getPerformed() );
+    m_vLastDes.push_back( d ? d->getPerformed() : 0 );
+  }
+}
+
+void BoundaryLayer::couple( long double time )
+{
+  double dt = time - m_lastTime;
+  if ( dt < m_dInterval )
+    return;
+
+  // The density is taken from the surface composition at the start of the interval
+  double density = mf_density();
+
+  for ( int i = 0; i < (int)m_vAdsorption.size(); i++ ){
+    Adsorption* a = m_vAdsorption[ i ];
+    Desorption* d = m_vDesorption[ i ];
+
+    // The surface area of the lattice with the site density of the adsorption flux
+    double area = m_lattice->getSize()/a->getSiteDensity();
+
+    long ads = a->getPerformed() - m_vLastAds[ i ];
+    long des = d ? d->getPerformed() - m_vLastDes[ i ] : 0;
+    m_vLastAds[ i ] = a->getPerformed();
+    m_vLastDes[ i ] = d ? d->getPerformed() : 0;
+
+    // Net consumption flux of the species at the surface [mol/m2/s]
+    double flux = ( ads - des )/( m_parameters->dAvogadroNum*area*dt );
+
+    // Mass consumption flux [kg/m2/s] with the molecular weight of the species [kg/mol]
+    double mw = a->getSpecies()->getMW()/1000.;
+
+    mf_step( m_vProfiles[ i ], m_vBulk[ i ], flux*mw, density, dt );
+    a->setMassFraction( m_vProfiles[ i ][ 0 ] );
+
+    m_io->writeLogOutput( "Boundary layer " + a->getSpeciesName() + " surface mass fraction: " + to_string( m_vProfiles[ i ][ 0 ] ) );
+  }
+
+  m_lastTime = time;
+}
+
+double BoundaryLayer::mf_density()
+{
+  // Mixture molecular weight: 1/W = sum_k y_k/W_k + (1 - sum_k y_k)/W_carrier
+  double sum = 0.0, inv = 0.0;
+  for ( int i = 0; i < (int)m_vAdsorption.size(); i++ ){
+    sum += m_vProfiles[ i ][ 0 ];
+    inv += m_vProfiles[ i ][ 0 ]/( m_vAdsorption[ i ]->getSpecies()->getMW()/1000. );
+  }
+
+  if ( sum < 1.0 )
+    inv += ( 1.0 - sum )/m_dCarrierMW;
+
+  // Ideal gas: rho = P W/(R T)
+  return m_parameters->getPressure()/( inv*m_parameters->dR*m_parameters->getTemperature() );
+}
+
+void BoundaryLayer::mf_step( vector< double >& y, double bulk, double flux, double density, double dt )
+{
+  int n = m_iNodes;
+  double h = m_dThickness/( n - 1 );
+  double r = m_dDiffusivity*dt/( h*h );
+
+  // Tridiagonal system: a[i] y[i-1] + b[i] y[i] + c[i] y[i+1] = rhs[i]
+  vector< double > a( n, -r ), b( n, 1.0 + 2.0*r ), c( n, -r ), rhs( y );
+
+  // Surface: half cell balance (h/2) dy0/dt = D (y1 - y0)/h - flux/rho
+  a[ 0 ] = 0.0;
+  c[ 0 ] = -2.0*r;
+  rhs[ 0 ] = y[ 0 ] - 2.0*dt*flux/( density*h );
+
+  // Bulk: fixed value
+  a[ n - 1 ] = 0.0;
+  b[ n - 1 ] = 1.0;
+  rhs[ n - 1 ] = bulk;
+
+  // Thomas algorithm
+  for ( int i = 1; i < n; i++ ){
+    double m = a[ i ]/b[ i - 1 ];
+    b[ i ] -= m*c[ i - 1 ];
+    rhs[ i ] -= m*rhs[ i - 1 ];
+  }
+
+  y[ n - 1 ] = rhs[ n - 1 ]/b[ n - 1 ];
+  for ( int i = n - 2; i >= 0; i-- )
+    y[ i ] = ( rhs[ i ] - c[ i ]*y[ i + 1 ] )/b[ i ];
+
+  // The surface cannot consume more than what is there
+  for ( int i = 0; i < n; i++ )
+    if ( y[ i ] < 0 )
+      y[ i ] = 0;
+}
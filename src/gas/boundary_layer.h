@@ -0,0 +1,100 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef BOUNDARY_LAYER_H
+#define BOUNDARY_LAYER_H
+
+#include <vector>
+
+#include "pointers.h"
+
+using namespace std;
+
+namespace MicroProcesses { class Adsorption; class Desorption; }
+
+/** A mean field 1D gas phase boundary layer above the surface.
+ * For every adsorbing species the mass fraction y(z) obeys dy/dt = D d2y/dz2 between the surface (z = 0)
+ * and the bulk (z = thickness) where it is fixed to the mass fraction given in the input.
+ * At the surface the net consumption flux comes from the adsorption and desorption events performed
+ * by the KMC since the last coupling, converted to a mass fraction flux with the molecular weight of the species
+ * and the density of the gas mixture (the rest of the gas is the carrier). Every coupling interval of KMC time the profile is advanced with
+ * an implicit (backward Euler) step and the surface value is passed back to the adsorption process. */
+
+class BoundaryLayer: public Pointers
+{
+public:
+    /// Constructor
+    BoundaryLayer( Apothesis* apothesis, double thickness, int nodes, double diffusivity, double interval, double carrierMW );
+
+    /// Destructor
+    virtual ~BoundaryLayer();
+
+    /// Builds a profile for every adsorption process equal to its mass fraction.
+    /// The desorption of the same species (if any) contributes to the surface flux.
+    void init( vector< MicroProcesses::Adsorption* > adsorption, vector< MicroProcesses::Desorption* > desorption );
+
+    /// Advances the boundary layer to time if at least one coupling interval has passed
+    /// and updates the mass fractions of the adsorption processes.
+    void couple( long double time );
+
+    /// Returns the mass fraction of species i at the surface.
+    inline double getSurfaceFraction( int i ) { return m_vProfiles[ i ][ 0 ]; }
+
+private:
+    /// Thickness of the boundary layer [m]
+    double m_dThickness;
+
+    /// Number of grid nodes including the surface and the bulk
+    int m_iNodes;
+
+    /// Diffusivity of the species in the gas [m2/s]
+    double m_dDiffusivity;
+
+    /// Coupling interval in KMC time [s]
+    double m_dInterval;
+
+    /// Molecular weight of the carrier gas [kg/mol]
+    double m_dCarrierMW;
+
+    /// Time of the last coupling
+    long double m_lastTime;
+
+    /// The adsorption process of each species
+    vector< MicroProcesses::Adsorption* > m_vAdsorption;
+
+    /// The desorption process of each species or null
+    vector< MicroProcesses::Desorption* > m_vDesorption;
+
+    /// The mass fraction profile of each species. Index 0 is the surface.
+    vector< vector< double > > m_vProfiles;
+
+    /// The bulk mass fraction of each species
+    vector< double > m_vBulk;
+
+    /// The number of adsorption and desorption events at the last coupling
+    vector< long > m_vLastAds;
+    vector< long > m_vLastDes;
+
+    /// Returns the density of the gas mixture at the surface [kg/m3] from the surface mass fractions.
+    double mf_density();
+
+    /// Performs one backward Euler step of length dt with net mass consumption flux [kg/m2/s] at the surface
+    /// and gas density [kg/m3].
+    void mf_step( vector< double >& y, double bulk, double flux, double density, double dt );
+};
+
+#endif // BOUNDARY_LAYER_H
@@ -17,6 +17,8 @@
 
 #include "BCC.h"
 #include "read.h"
+#include "arena.h"
+#include "parallel.h"
 
 BCC::BCC(Apothesis *apothesis) : Lattice(apothesis)
 {
@@ -52,37 +54,36 @@ void BCC::build()
 		m_errorHandler->warningSimple_msg("The lattice initial height is too small.Consider revising.");
 	}
 
-	// The sites of the lattice.
+	// The sites of the lattice. They are placed contiguously in the arena which also owns them.
+	// Every site is set up independently of the others so the sites are split over the threads.
 	m_vSites.resize(getSize());
-	for (int i = 0; i < m_vSites.size(); i++)
-		m_vSites[i] = new Site(this);
+	m_vHeights.assign(getSize(), 0);
+	Site *sites = m_arena->createArray<Site>(getSize(), this);
 
 	//  m_pSites = new Site[ m_iSizeX*m_iSizeY];
 
 // if m_iSizeX = 120
-	for (int i = 0; i < m_iSizeX; i++)
-	{
-		// m_iSizeY = 160
-		for (int j = i * m_iSizeY; j < (m_iSizeY + i * m_iSizeY); j++)
+	parallelFor(0, getSize(), [&](int, long lo, long hi) {
+		for (int j = lo; j < hi; j++)
 		{
+			m_vSites[j] = sites + j;
 			m_vSites[j]->setID(j);
-			m_vSites[j]->setIID(i);
+			m_vSites[j]->setIID(j / m_iSizeY);
 			m_vSites[j]->setJID(j%m_iSizeY);
 			m_vSites[j]->setHeight(m_iHeight - 1);
 			m_vSites[j]->setLatticeType(Site::LatticeType::BCC);
 		}
-	}
+	});
 
 	if (m_hasSteps)
 		mf_buildSteps();
 
-	mf_neigh();
+	mf_buildTopology(m_hasSteps, m_stepInfo);
 }
 
 BCC::~BCC()
 {
-	for (int i = 0; i < getSize(); i++)
-		delete m_vSites[i];
+	// The sites are owned by the arena.
 }
 
 void BCC::setSteps(bool hasSteps)
@@ -165,12 +166,12 @@ void BCC::mf_buildSteps()
 
 void BCC::mf_neigh()
 {
-	/* All except the boundaries */
-	for (int i = 0; i < m_iSizeY; i++)
-	{
-		for (int j = 0; j < m_iSizeX; j++)
+	/* All except the boundaries. Every site only sets its own neighbours so the sites are split over the threads. */
+	parallelFor(0, getSize(), [&](int, long lo, long hi) {
+		for (int currentIndex = lo; currentIndex < hi; currentIndex++)
 		{
-			int currentIndex = i * m_iSizeX + j;
+			int i = currentIndex / m_iSizeX;
+			int j = currentIndex % m_iSizeX;
 			int currentHeight = m_vSites[currentIndex]->getHeight();
 			int southIndex = (i - 1) * m_iSizeX + j;
 			if (i == 0)
@@ -209,7 +210,7 @@ void BCC::mf_neigh()
 				cout<<"No neighbours"<<endl;
 			}
 		}
-	}
+	});
 
 	/*	int iCount = 0;
 	int pos = 0;
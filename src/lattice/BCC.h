@@ -60,6 +60,9 @@ public:
   /// Returns the size of the lattice.
   inline int getSize() { return m_iSizeX * m_iSizeY; }
 
+  /// Returns the number of neighbours of a site at the same level.
+  inline int getNumNeighbours() { return 4; }
+
   /// Returns a site with a specific id.
   Site *getSite(int id);
 
@@ -86,7 +89,7 @@ protected:
   void mf_buildNeighbours();
 
 private:
-  bool m_hasSteps;
+  bool m_hasSteps = false;
 
   vector<int> m_stepInfo;
 };
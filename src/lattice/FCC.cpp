@@ -17,6 +17,8 @@
 
 #include "FCC.h"
 #include "read.h"
+#include "arena.h"
+#include "parallel.h"
 
 FCC::FCC(Apothesis *apothesis) : Lattice(apothesis)
 {
@@ -52,58 +54,45 @@ void FCC::build()
     m_errorHandler->warningSimple_msg("The lattice initial height is too small.Consider revising.");
   }
 
-  // The sites of the lattice.
+  // The sites of the lattice. They are placed contiguously in the arena which also owns them.
+  // Every site is set up independently of the others so the sites are split over the threads.
   m_vSites.resize(getSize());
-  for (int i = 0; i < m_vSites.size(); i++)
-    m_vSites[i] = new Site(this);
+  m_vHeights.assign(getSize(), 0);
+  Site *sites = m_arena->createArray<Site>(getSize(), this);
 
   //  m_pSites = new Site[ m_iSizeX*m_iSizeY];
 
-  for (int i = 0; i < m_iSizeX; i++)
-  {
-    if (i % 2 == 0)
-      for (int j = i * m_iSizeY; j < (m_iSizeY + i * m_iSizeY); j++)
-        if (j % 2 == 0)
-        {
-          m_vSites[j]->setID(j);
-          m_vSites[j]->setHeight(m_iHeight - 1);
-        }
-        else
-        {
-          m_vSites[j]->setID(j);
-          m_vSites[j]->setHeight(m_iHeight);
-        }
-    else
-      for (int j = i * m_iSizeY; j < (m_iSizeY + i * m_iSizeY); j++)
-        if (j % 2 == 0)
-        {
-          m_vSites[j]->setID(j);
-          m_vSites[j]->setHeight(m_iHeight);
-        }
-        else
-        {
-          m_vSites[j]->setID(j);
-          m_vSites[j]->setHeight(m_iHeight - 1);
-        }
-  }
+  parallelFor(0, getSize(), [&](int, long lo, long hi) {
+    for (int j = lo; j < hi; j++)
+    {
+      int i = j / m_iSizeY;
+      m_vSites[j] = sites + j;
+      m_vSites[j]->setID(j);
+      if ((i % 2 == 0) == (j % 2 == 0))
+        m_vSites[j]->setHeight(m_iHeight - 1);
+      else
+        m_vSites[j]->setHeight(m_iHeight);
+    }
+  });
 
-  mf_neigh();
+  mf_buildTopology(m_hasSteps, m_stepInfo);
 }
 
 FCC::~FCC()
 {
-  for (int i = 0; i < getSize(); i++)
-    delete m_vSites[i];
+  // The sites are owned by the arena.
 }
 
 void FCC::mf_neigh()
 {
 
-  /* All except the boundaries */
-  for (int i = 2; i < m_iSizeX - 2; i++)
-  {
-    for (int j = (i * m_iSizeY + 2); j < (i * m_iSizeY + m_iSizeY - 2); j++)
+  /* All except the boundaries. Every site only sets its own neighbours so the rows are split over the threads. */
+  parallelFor(2 * m_iSizeY, (m_iSizeX - 2) * m_iSizeY, [&](int, long lo, long hi) {
+    for (int j = lo; j < hi; j++)
     {
+      if (j % m_iSizeY < 2 || j % m_iSizeY >= m_iSizeY - 2)
+        continue;
+
       m_vSites[j]->setNeigh(m_vSites[j - 2]);
       m_vSites[j]->setNeighPosition(m_vSites[j - 2], Site::EAST);
 
@@ -131,7 +120,7 @@ void FCC::mf_neigh()
       m_vSites[j]->setNeighPosition(m_vSites[j - 2 * m_iSizeY], Site::NORTH);
       m_vSites[j]->setNeighPosition(m_vSites[j + 2 * m_iSizeY], Site::SOUTH);
     }
-  }
+  });
 
   /* First row */
   for (int i = 0; i < m_iSizeY; i++)
@@ -54,6 +54,9 @@ class FCC: public Lattice
     /// Returns the size of the lattice.
     inline int getSize(){return  m_iSizeX*m_iSizeY;}
 
+    /// Returns the number of neighbours of a site at the same level.
+    inline int getNumNeighbours(){return 6;}
+
     /// Returns a site with a specific id.
     Site* getSite( int id);
 
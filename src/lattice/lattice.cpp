@@ -17,8 +17,14 @@
 
 #include "lattice.h"
 #include "read.h"
-
-Lattice::Lattice(Apothesis *apothesis) : Pointers(apothesis)
+#include "txt_reader.h"
+#include "topology_cache.h"
+#include "parallel.h"
+#include "memory_report.h"
+
+Lattice::Lattice(Apothesis *apothesis) : Pointers(apothesis),
+                                          m_iNumSpecies(0),
+                                          m_lastRoughness(0)
 {
   //Document input =
 }
@@ -44,6 +50,34 @@ Lattice::~Lattice()
 {
 }
 
+void Lattice::mf_buildTopology(bool hasSteps, vector<int> stepInfo)
+{
+  string directory = m_txtReader->getTopologyCache();
+  if (directory.empty())
+  {
+    mf_neigh();
+    return;
+  }
+
+  string key = (m_Type == FCC ? "FCC_" : "BCC_") + to_string(m_iSizeX) + "x" + to_string(m_iSizeY) + "_h" + to_string(m_iHeight);
+  if (hasSteps)
+    for (int step : stepInfo)
+      key += "_s" + to_string(step);
+
+  TopologyCache cache(directory, key);
+  if (cache.load(m_vSites))
+  {
+    cout << "Lattice topology read from " << cache.getPath() << endl;
+    return;
+  }
+
+  mf_neigh();
+  if (cache.save(m_vSites))
+    cout << "Lattice topology stored in " << cache.getPath() << endl;
+  else
+    m_errorHandler->warningSimple_msg("Could not write the lattice topology cache " + cache.getPath() + ".");
+}
+
 vector<Site *> Lattice::getSites()
 {
   return m_vSites;
@@ -81,7 +115,41 @@ double Lattice::mf_roughness()
 
 double Lattice::getRoughness()
 {
-  return mf_roughness();
+  double roughness = mf_roughness();
+  m_lastRoughness.store(roughness, memory_order_relaxed);
+  return roughness;
+}
+
+void Lattice::initSpecies(int numSpecies)
+{
+  m_iNumSpecies = numSpecies;
+  m_vSpeciesCounts.assign((long)getSize() * numSpecies, 0);
+  m_vSpeciesTotals.assign(numSpecies, 0);
+  m_vSpeciesSites.assign(numSpecies, 0);
+
+  // Every site only touches its own counts
+  Utils::parallelFor(0, m_vSites.size(), [&](int, long lo, long hi) {
+    for (long i = lo; i < hi; ++i)
+      m_vSites[i]->initSpeciesMap(numSpecies);
+  });
+}
+
+void Lattice::accountMemory(Utils::MemoryReport &report)
+{
+  report.add(Utils::MemoryReport::SITES, Utils::MemoryReport::heap(m_vSites) + Utils::MemoryReport::heap(m_vHeights));
+  report.add(Utils::MemoryReport::SPECIES, Utils::MemoryReport::heap(m_vSpeciesCounts) + Utils::MemoryReport::heap(m_vSpeciesTotals) + Utils::MemoryReport::heap(m_vSpeciesSites));
+
+  for (Site *site : m_vSites)
+    site->accountMemory(report);
+}
+
+void Lattice::estimateMemory(Utils::MemoryReport &report, int numSpecies, int numProcesses)
+{
+  long sites = getSize();
+  report.add(Utils::MemoryReport::SITES, Utils::MemoryReport::block(sites * sizeof(Site *)) + Utils::MemoryReport::block(sites * sizeof(int)));
+  report.add(Utils::MemoryReport::SPECIES, Utils::MemoryReport::block(sites * numSpecies * sizeof(int)));
+
+  Site::estimateMemory(report, sites, getNumNeighbours(), numProcesses);
 }
 
 void Lattice::check()
@@ -23,6 +23,7 @@
 #include <map>
 #include <list>
 #include <fstream>
+#include <atomic>
 
 #include "pointers.h"
 #include "site.h"
@@ -59,6 +60,9 @@ class Lattice: public Pointers
     /// Returns the size of the lattice.
     virtual int getSize() = 0;
 
+    /// Returns the number of neighbours of a site at the same level.
+    virtual int getNumNeighbours() = 0;
+
     /// Call update neighbours function;
     virtual void updateNeighbours(Site* site) = 0;
 
@@ -104,6 +108,41 @@ class Lattice: public Pointers
     /// Get the roughness (public function)
     double getRoughness();
 
+    /// The roughness when it was last computed, e.g. for the metrics thread. Zero before.
+    inline double getLastRoughness() { return m_lastRoughness.load( memory_order_relaxed ); }
+
+    /// The heights of the sites by id. The sites keep their heights here.
+    inline int* getHeights() { return m_vHeights.data(); }
+
+    /// The number of each species on the sites: the species ids of site 0, then of site 1 etc.
+    /// The sites keep their counts here.
+    inline int* getSpeciesCounts() { return m_vSpeciesCounts.data(); }
+
+    /// The number of species of the counts.
+    inline int getNumSpecies() { return m_iNumSpecies; }
+
+    /// Changes the number of a species on the whole lattice. Called by the sites as their counts change.
+    inline void changeSpeciesTotal( int id, int change ) { m_vSpeciesTotals[ id ] += change; }
+
+    /// Changes the number of sites that hold a species. Called by the sites as a count leaves or reaches zero.
+    inline void changeSpeciesSites( int id, int change ) { m_vSpeciesSites[ id ] += change; }
+
+    /// The number of sites that hold a species at least once.
+    inline long getSpeciesSites( int id ) { return m_vSpeciesSites[ id ]; }
+
+    /// The coverage of a species: its number on the lattice over the number of sites.
+    inline double getCoverage( int id ) { return (double)m_vSpeciesTotals[ id ]/m_vSites.size(); }
+
+    /// Allocates the species counts of the sites and sets them to zero.
+    void initSpecies( int numSpecies );
+
+    /// Adds the sites, their heights and their species counts to the memory report.
+    void accountMemory( Utils::MemoryReport& report );
+
+    /// Adds the projection of the built lattice with numSpecies species and numProcesses processes
+    /// to the memory report. Only the dimensions are needed: nothing is built.
+    void estimateMemory( Utils::MemoryReport& report, int numSpecies, int numProcesses );
+
   protected:
     /// The size of the lattice in the x-dimension.
     int m_iSizeX;
@@ -120,9 +159,28 @@ class Lattice: public Pointers
     /// The sites that consist the lattice.
     vector<Site* > m_vSites;
 
+    /// The flat storage of the heights and of the species counts of the sites. Allocated once,
+    /// the heights by build and the counts by initSpecies, so that the sites can point to them.
+    vector<int> m_vHeights;
+    vector<int> m_vSpeciesCounts;
+    int m_iNumSpecies;
+
+    /// The number of each species on the lattice (the sum of the counts of the sites)
+    vector<long> m_vSpeciesTotals;
+
+    /// The number of sites that hold each species
+    vector<long> m_vSpeciesSites;
+
+    /// The last computed roughness. Read by other threads.
+    atomic<double> m_lastRoughness;
+
     /// The neighbours for the FCC lattice.
     virtual void mf_neigh() = 0;
 
+    /// Set the neighbours from the topology cache (topology_cache keyword) if a cache of this
+    /// geometry exists, otherwise build them with mf_neigh and store them in the cache.
+    void mf_buildTopology( bool hasSteps, vector<int> stepInfo );
+
     /// True if the lattice has steps (comes from the input file if the Step keyword is found).
     bool m_hasSteps = false;
 
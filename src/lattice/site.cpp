@@ -19,13 +19,23 @@
 #define SITE_CPP
 
 #include "site.h"
+#include "lattice.h"
+#include "perf_counters.h"
+#include "memory_report.h"
 
 namespace SurfaceTiles
 {
 
-  Site::Site(Lattice *lattice) : m_phantom(false),
+  Site::Site(Lattice *lattice) : m_pHeight(0),
+                                 m_pSpeciesCount(0),
+                                 m_phantom(false),
                                  m_lattice(lattice)
   {
+    for (int i = 0; i < 8; i++)
+    {
+      m_aNeigh[i] = 0;
+      m_aAct[i] = 0;
+    }
   }
 
   Site::~Site() { ; }
@@ -43,6 +53,7 @@ namespace SurfaceTiles
   void Site::setID(int id)
   {
     m_iID = id;
+    m_pHeight = m_lattice->getHeights() + id;
   }
 
   void Site::setIID(int IID)
@@ -72,17 +83,17 @@ namespace SurfaceTiles
 
   void Site::setHeight(int h)
   {
-    m_iHeight = h;
+    *m_pHeight = h;
   }
 
   int Site::getHeight()
   {
-    return m_iHeight;
+    return *m_pHeight;
   }
 
   void Site::increaseHeight(int height)
   {
-    m_iHeight += height;
+    *m_pHeight += height;
   }
 
   void Site::setLatticeType(LatticeType type)
@@ -97,28 +108,30 @@ namespace SurfaceTiles
 
   void Site::setNeighPosition(Site *s, NeighPoisition np)
   {
-    m_mapNeigh[np] = s;
+    m_aNeigh[np] = s;
   }
 
   Site *Site::getNeighPosition(NeighPoisition np)
   {
-    return m_mapNeigh[np];
+    return m_aNeigh[np];
   }
 
   void Site::storeActivationSite(Site *s, ActivationSite as)
   {
-    m_mapAct[as] = s;
+    m_aAct[as] = s;
   }
 
   Site *Site::getActivationSite(ActivationSite as)
   {
-    return m_mapAct[as];
+    return m_aAct[as];
   }
 
   void Site::addSpecies(Species *s)
   {
     m_species.push_back(s);
-    m_mapSpecies[s->getId()]++;
+    if (m_pSpeciesCount[s->getId()]++ == 0)
+      m_lattice->changeSpeciesSites(s->getId(), 1);
+    m_lattice->changeSpeciesTotal(s->getId(), 1);
   }
 
   void Site::m_addSite(Site* site)
@@ -135,7 +148,7 @@ namespace SurfaceTiles
     int numIter = 0;
     int m_species_prevSize = m_species.size();
 
-    int numOfSpecies = m_mapSpecies[s->getId()];
+    int numOfSpecies = m_pSpeciesCount[s->getId()];
 
     if (numOfSpecies > 0)
     {
@@ -149,7 +162,9 @@ namespace SurfaceTiles
         ++numIter;
       }
       // Decrement number of said species
-      m_mapSpecies[s->getId()]--;
+      if (--m_pSpeciesCount[s->getId()] == 0)
+        m_lattice->changeSpeciesSites(s->getId(), -1);
+      m_lattice->changeSpeciesTotal(s->getId(), -1);
     }
 
     // Output warning message if we didn't remove anything
@@ -206,11 +221,20 @@ namespace SurfaceTiles
 
   map<int, int> Site::getSpeciesMap()
   {
-    return m_mapSpecies;
+    map<int, int> species;
+    for (int i = 0; i < m_lattice->getNumSpecies(); ++i)
+      species[i] = m_pSpeciesCount[i];
+    return species;
+  }
+
+  int Site::getSpeciesCount(int id)
+  {
+    return m_pSpeciesCount[id];
   }
 
   void Site::m_updateNeighbours()
   {
+    Utils::PerfScope counters(Utils::PerfCounters::NEIGHBOURS);
     m_lattice->updateNeighbours(this);
   }
 
@@ -226,12 +250,30 @@ namespace SurfaceTiles
 
   void Site::initSpeciesMap(int numSpecies)
   {
+    m_pSpeciesCount = m_lattice->getSpeciesCounts() + m_iID * numSpecies;
     for (int i = 0; i < numSpecies; ++i)
     {
-      m_mapSpecies[i] = 0;
+      m_pSpeciesCount[i] = 0;
     }
   }
 
+  void Site::accountMemory(Utils::MemoryReport &report)
+  {
+    report.add(Utils::MemoryReport::SITES, sizeof(Site) - sizeof(m_aNeigh) - sizeof(m_aAct) + Utils::MemoryReport::heap(m_lProcs) + Utils::MemoryReport::heap(activeSites));
+    report.add(Utils::MemoryReport::NEIGHBOURS, sizeof(m_aNeigh) + sizeof(m_aAct) + Utils::MemoryReport::heap(m_vNeigh));
+    report.add(Utils::MemoryReport::SPECIES, Utils::MemoryReport::heap(m_species));
+  }
+
+  void Site::estimateMemory(Utils::MemoryReport &report, long sites, int neighbours, int processes)
+  {
+    // The processes register with every other site (odd ids). Every site is assumed to hold a species.
+    size_t links = sizeof(m_aNeigh) + sizeof(m_aAct);
+    size_t procs = processes*Utils::MemoryReport::block(sizeof(Process *) + 2*sizeof(void *));
+    report.add(Utils::MemoryReport::SITES, sites*(sizeof(Site) - links) + (sites/2)*procs);
+    report.add(Utils::MemoryReport::NEIGHBOURS, sites*(links + Utils::MemoryReport::block(Utils::MemoryReport::capacity(neighbours)*sizeof(Site *))));
+    report.add(Utils::MemoryReport::SPECIES, sites*Utils::MemoryReport::block(sizeof(Species *)));
+  }
+
 } // namespace SurfaceTiles
 
 #endif
@@ -29,6 +29,8 @@
 using namespace std;
 using namespace MicroProcesses;
 
+namespace Utils { class MemoryReport; }
+
 /**  The site is where a process will be performed. The lattice is
  * a series of sites put together in space with certain symmetry. */
 
@@ -88,7 +90,7 @@ namespace SurfaceTiles
     /// Set the neigbours.
     void setNeigh(Site *);
 
-    /// Initialize map
+    /// Initialize the species counts. The counts of the lattice must be allocated (Lattice::initSpecies).
     void initSpeciesMap(int numSpecies);
 
     /// Get the neigbours at the same level.
@@ -140,6 +142,15 @@ namespace SurfaceTiles
 
     vector<Species *> getSpecies();
 
+    /// The number of species on the site.
+    inline int getNumSpecies() { return m_species.size(); }
+
+    /// The i-th species on the site.
+    inline Species *getSpeciesAt(int i) { return m_species[i]; }
+
+    /// The number of species with this id on the site.
+    int getSpeciesCount(int id);
+
     vector<string> getSpeciesName();
 
     /// Add a processes in the list of processes that this site can participate in.
@@ -174,6 +185,13 @@ namespace SurfaceTiles
 
     void m_addSite(Site *site);
 
+    /// Adds the site and its containers to the memory report (the neighbours and the species separately).
+    void accountMemory(Utils::MemoryReport &report);
+
+    /// Adds the projection of sites sites with neighbours neighbours each that take part in processes
+    /// processes to the memory report. Nothing is allocated.
+    static void estimateMemory(Utils::MemoryReport &report, long sites, int neighbours, int processes);
+
   protected:
     //The lattice type that this site belongs to
     LatticeType m_LatticeType;
@@ -185,8 +203,8 @@ namespace SurfaceTiles
     int m_iIIndex;
     int m_iJIndex;
 
-    /// The height in the particular position.
-    int m_iHeight;
+    /// The height in the particular position. It is kept in the flat heights of the lattice.
+    int *m_pHeight;
 
     /// The neighbours at the same level - We do not need this because we have the map (see below).
     vector<Site *> m_vNeigh;
@@ -194,18 +212,18 @@ namespace SurfaceTiles
     /// Holds the number of the neighbours of the particular site according to each height/
     int m_iNumNeighs;
 
-    //TODO: get rid of map?
-    /// A map that holds the neighbour sites according to their orientation.
-    map<NeighPoisition, Site *> m_mapNeigh;
+    /// The neighbour sites indexed by their orientation (NeighPoisition). Null if not set.
+    Site *m_aNeigh[8];
 
-    /// A map that hold the sites that this site can activate if it has all the its neighbours occupied.
-    map<ActivationSite, Site *> m_mapAct;
+    /// The sites that this site can activate if it has all the its neighbours occupied,
+    /// indexed by ActivationSite. Null if not set.
+    Site *m_aAct[8];
 
     /// A list of active sites for each process
     map<Process *, vector<Site *>> activeSites;
 
-    /// A map counting the species that are present
-    map<int, int> m_mapSpecies;
+    /// The number of each species (by id) that is present. It is kept in the flat species counts of the lattice.
+    int *m_pSpeciesCount;
 
     /// To check if a site is occupied or not.
     bool m_bIsOccupied;
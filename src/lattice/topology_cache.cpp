@@ -0,0 +1,161 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "topology_cache.h"
+#include "mapped_file.h"
+#include "parallel.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace SurfaceTiles
+{
+
+static const char TOPOLOGY_MAGIC[ 8 ] = { 'A', 'P', 'O', 'T', 'O', 'P', 'O', '\0' };
+
+static const int TOPOLOGY_VERSION = 1;
+
+/// The number of neighbour (and activation) slots of each site
+static const int TOPOLOGY_SLOTS = 8;
+
+TopologyCache::TopologyCache( string directory, string key )
+{
+    if ( !directory.empty() && directory.back() != '/' )
+        directory += '/';
+    m_sPath = directory + key + ".topo";
+}
+
+TopologyCache::~TopologyCache()
+{
+}
+
+bool TopologyCache::load( vector<Site*>& sites )
+{
+    Utils::MappedFile file( m_sPath );
+    if ( !file.isOpen() || file.getSize() < sizeof( Header ) )
+        return false;
+
+    Header header;
+    memcpy( &header, file.begin(), sizeof( Header ) );
+    if ( memcmp( header.magic, TOPOLOGY_MAGIC, sizeof( TOPOLOGY_MAGIC ) ) != 0 ||
+         header.version != TOPOLOGY_VERSION ||
+         header.sites != (int)sites.size() ||
+         header.entries < 0 )
+        return false;
+
+    size_t n = sites.size();
+    size_t count = 2*TOPOLOGY_SLOTS*n + ( n + 1 ) + header.entries;
+    if ( file.getSize() != sizeof( Header ) + count*sizeof( int ) )
+        return false;
+
+    // The arrays follow the header which keeps them aligned to int.
+    const int* neigh = reinterpret_cast<const int*>( file.begin() + sizeof( Header ) );
+    const int* act = neigh + TOPOLOGY_SLOTS*n;
+    const int* offsets = act + TOPOLOGY_SLOTS*n;
+    const int* list = offsets + n + 1;
+
+    for ( size_t i = 0; i < n + 1; i++ )
+        if ( offsets[ i ] < 0 || offsets[ i ] > header.entries || ( i > 0 && offsets[ i ] < offsets[ i - 1 ] ) )
+            return false;
+
+    for ( size_t k = 0; k < 2*TOPOLOGY_SLOTS*n; k++ )
+        if ( neigh[ k ] < -1 || neigh[ k ] >= (int)n )
+            return false;
+
+    for ( long long k = 0; k < header.entries; k++ )
+        if ( list[ k ] < 0 || list[ k ] >= (int)n )
+            return false;
+
+    // Every site only sets its own neighbours
+    Utils::parallelFor( 0, n, [ & ]( int, long lo, long hi ){
+        for ( long i = lo; i < hi; i++ )
+        {
+            for ( int k = 0; k < TOPOLOGY_SLOTS; k++ )
+            {
+                int id = neigh[ TOPOLOGY_SLOTS*i + k ];
+                if ( id >= 0 )
+                    sites[ i ]->setNeighPosition( sites[ id ], (Site::NeighPoisition)k );
+
+                id = act[ TOPOLOGY_SLOTS*i + k ];
+                if ( id >= 0 )
+                    sites[ i ]->storeActivationSite( sites[ id ], (Site::ActivationSite)k );
+            }
+
+            for ( int k = offsets[ i ]; k < offsets[ i + 1 ]; k++ )
+                sites[ i ]->setNeigh( sites[ list[ k ] ] );
+        }
+    } );
+
+    return true;
+}
+
+bool TopologyCache::save( vector<Site*>& sites )
+{
+    size_t n = sites.size();
+    vector<int> neigh( TOPOLOGY_SLOTS*n, -1 );
+    vector<int> act( TOPOLOGY_SLOTS*n, -1 );
+    vector<int> offsets( n + 1, 0 );
+    vector<int> list;
+
+    for ( size_t i = 0; i < n; i++ )
+    {
+        for ( int k = 0; k < TOPOLOGY_SLOTS; k++ )
+        {
+            Site* s = sites[ i ]->getNeighPosition( (Site::NeighPoisition)k );
+            if ( s )
+                neigh[ TOPOLOGY_SLOTS*i + k ] = s->getID();
+
+            s = sites[ i ]->getActivationSite( (Site::ActivationSite)k );
+            if ( s )
+                act[ TOPOLOGY_SLOTS*i + k ] = s->getID();
+        }
+
+        for ( Site* s : sites[ i ]->getNeighs() )
+            list.push_back( s->getID() );
+        offsets[ i + 1 ] = list.size();
+    }
+
+    Header header;
+    memcpy( header.magic, TOPOLOGY_MAGIC, sizeof( TOPOLOGY_MAGIC ) );
+    header.version = TOPOLOGY_VERSION;
+    header.sites = n;
+    header.entries = list.size();
+
+    // Write to a temporary file first so that concurrent runs never map a partial cache.
+    string tmp = m_sPath + ".tmp";
+    ofstream out( tmp, ios::binary );
+    if ( !out.is_open() )
+        return false;
+
+    out.write( reinterpret_cast<const char*>( &header ), sizeof( Header ) );
+    out.write( reinterpret_cast<const char*>( neigh.data() ), neigh.size()*sizeof( int ) );
+    out.write( reinterpret_cast<const char*>( act.data() ), act.size()*sizeof( int ) );
+    out.write( reinterpret_cast<const char*>( offsets.data() ), offsets.size()*sizeof( int ) );
+    out.write( reinterpret_cast<const char*>( list.data() ), list.size()*sizeof( int ) );
+    out.close();
+
+    if ( out.fail() || rename( tmp.c_str(), m_sPath.c_str() ) != 0 )
+    {
+        remove( tmp.c_str() );
+        return false;
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,71 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef TOPOLOGY_CACHE_H
+#define TOPOLOGY_CACHE_H
+
+#include <string>
+#include <vector>
+
+#include "site.h"
+
+using namespace std;
+
+namespace SurfaceTiles
+{
+
+/** An on-disk cache of the neighbour topology of a lattice. The neighbours of each
+ * site are stored as index arrays (one slot per NeighPoisition and ActivationSite, -1
+ * if not set, followed by the same level neighbour lists) in a binary file which is
+ * memory mapped on the next run so that the neighbour construction can be skipped.
+ * The file name is the key of the topology (lattice type, dimensions, height and steps). */
+
+class TopologyCache
+{
+public:
+    /// Constructor. The cache file is directory/key.topo.
+    TopologyCache( string directory, string key );
+
+    /// Destructor.
+    virtual ~TopologyCache();
+
+    /// Set the neighbours of the sites from the cache. Returns false if there is no valid cache file.
+    bool load( vector<Site*>& sites );
+
+    /// Store the neighbours of the sites in the cache file. Returns false if the file cannot be written.
+    bool save( vector<Site*>& sites );
+
+    /// The path of the cache file.
+    inline string getPath() { return m_sPath; }
+
+private:
+    /// The path of the cache file
+    string m_sPath;
+
+    /// The header of the cache file
+    struct Header
+    {
+        char magic[ 8 ];
+        int version;
+        int sites;
+        long long entries;
+    };
+};
+
+}
+
+#endif // TOPOLOGY_CACHE_H
@@ -0,0 +1,216 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "voxel_lattice.h"
+#include "lattice.h"
+#include "site.h"
+#include "memory_report.h"
+
+#include <algorithm>
+
+namespace SurfaceTiles
+{
+
+VoxelColumn::VoxelColumn()
+{
+}
+
+VoxelColumn::~VoxelColumn()
+{
+}
+
+void VoxelColumn::fill( int top )
+{
+    m_vRuns.clear();
+    if ( top > 0 )
+        m_vRuns = { 0, top };
+}
+
+int VoxelColumn::mf_find( int layer )
+{
+    int k = 0;
+    while ( 2*k < (int)m_vRuns.size() && m_vRuns[ 2*k + 1 ] < layer )
+        k++;
+    return k;
+}
+
+bool VoxelColumn::isOccupied( int layer )
+{
+    int k = mf_find( layer );
+    return 2*k < (int)m_vRuns.size() && m_vRuns[ 2*k ] <= layer && layer < m_vRuns[ 2*k + 1 ];
+}
+
+void VoxelColumn::occupy( int layer )
+{
+    int k = mf_find( layer );
+    int n = m_vRuns.size()/2;
+
+    if ( k < n && m_vRuns[ 2*k ] <= layer )
+    {
+        if ( layer < m_vRuns[ 2*k + 1 ] )
+            return;
+
+        // Extend the run upwards and merge it with the next one if they touch
+        m_vRuns[ 2*k + 1 ] = layer + 1;
+        if ( k + 1 < n && m_vRuns[ 2*k + 2 ] == layer + 1 )
+        {
+            m_vRuns[ 2*k + 1 ] = m_vRuns[ 2*k + 3 ];
+            m_vRuns.erase( m_vRuns.begin() + 2*k + 2, m_vRuns.begin() + 2*k + 4 );
+        }
+    }
+    else if ( k < n && m_vRuns[ 2*k ] == layer + 1 )
+        m_vRuns[ 2*k ] = layer;
+    else
+        m_vRuns.insert( m_vRuns.begin() + 2*k, { layer, layer + 1 } );
+}
+
+void VoxelColumn::vacate( int layer )
+{
+    int k = mf_find( layer );
+    if ( 2*k >= (int)m_vRuns.size() || layer < m_vRuns[ 2*k ] || layer >= m_vRuns[ 2*k + 1 ] )
+        return;
+
+    int start = m_vRuns[ 2*k ];
+    int end = m_vRuns[ 2*k + 1 ];
+    if ( start == layer && end == layer + 1 )
+        m_vRuns.erase( m_vRuns.begin() + 2*k, m_vRuns.begin() + 2*k + 2 );
+    else if ( start == layer )
+        m_vRuns[ 2*k ]++;
+    else if ( end == layer + 1 )
+        m_vRuns[ 2*k + 1 ]--;
+    else
+    {
+        m_vRuns[ 2*k + 1 ] = layer;
+        m_vRuns.insert( m_vRuns.begin() + 2*k + 2, { layer + 1, end } );
+    }
+}
+
+int VoxelColumn::getNumVoxels()
+{
+    int voxels = 0;
+    for ( int k = 0; k < (int)m_vRuns.size(); k += 2 )
+        voxels += m_vRuns[ k + 1 ] - m_vRuns[ k ];
+    return voxels;
+}
+
+void VoxelColumn::accountMemory( Utils::MemoryReport& report )
+{
+    report.add( Utils::MemoryReport::SITES, Utils::MemoryReport::heap( m_vRuns ) );
+}
+
+}
+
+using namespace SurfaceTiles;
+
+VoxelLattice::VoxelLattice( Apothesis* apothesis ):Pointers( apothesis )
+{
+}
+
+VoxelLattice::~VoxelLattice()
+{
+}
+
+int VoxelLattice::mf_layer( int height )
+{
+    // Floor division so that the parity is 0 or 1 for negative heights as well
+    return height >= 0 ? height/2 : -( ( 1 - height )/2 );
+}
+
+void VoxelLattice::init()
+{
+    int size = m_lattice->getSize();
+    m_vColumns.assign( size, VoxelColumn() );
+    m_vTop.resize( size );
+    m_vParity.resize( size );
+
+    for ( int i = 0; i < size; i++ )
+    {
+        int height = m_lattice->getSite( i )->getHeight();
+        int layer = mf_layer( height );
+        m_vParity[ i ] = height - 2*layer;
+        m_vTop[ i ] = layer + 1;
+        m_vColumns[ i ].fill( m_vTop[ i ] );
+    }
+
+    cout << "Voxel lattice: " << getNumVoxels() << " voxels in " << getNumRuns() << " runs" << endl;
+}
+
+int VoxelLattice::deposit( Site* site )
+{
+    int id = site->getID();
+    int layer = m_vTop[ id ];
+
+    // The particle falls along the column and sticks at the first layer that touches a neighbour column
+    Site::NeighPoisition lateral[] = { Site::EAST, Site::WEST, Site::NORTH, Site::SOUTH };
+    for ( Site::NeighPoisition np : lateral )
+    {
+        Site* neigh = site->getNeighPosition( np );
+        if ( neigh )
+            layer = max( layer, m_vTop[ neigh->getID() ] - 1 );
+    }
+
+    m_vColumns[ id ].occupy( layer );
+    m_vTop[ id ] = layer + 1;
+    return 2*layer + m_vParity[ id ];
+}
+
+int VoxelLattice::remove( Site* site )
+{
+    int id = site->getID();
+    m_vColumns[ id ].vacate( m_vTop[ id ] - 1 );
+
+    // A void below the removed layer is now exposed
+    m_vTop[ id ] = m_vColumns[ id ].getTop();
+    return 2*( m_vTop[ id ] - 1 ) + m_vParity[ id ];
+}
+
+long VoxelLattice::getNumVoxels()
+{
+    long voxels = 0;
+    for ( VoxelColumn& column : m_vColumns )
+        voxels += column.getNumVoxels();
+    return voxels;
+}
+
+long VoxelLattice::getNumVacancies()
+{
+    long vacancies = 0;
+    for ( int i = 0; i < (int)m_vColumns.size(); i++ )
+        vacancies += m_vTop[ i ] - m_vColumns[ i ].getNumVoxels();
+    return vacancies;
+}
+
+long VoxelLattice::getNumRuns()
+{
+    long runs = 0;
+    for ( VoxelColumn& column : m_vColumns )
+        runs += column.getNumRuns();
+    return runs;
+}
+
+void VoxelLattice::accountMemory( Utils::MemoryReport& report )
+{
+    report.add( Utils::MemoryReport::SITES, sizeof( VoxelLattice ) + Utils::MemoryReport::heap( m_vColumns ) + Utils::MemoryReport::heap( m_vTop ) + Utils::MemoryReport::heap( m_vParity ) );
+    for ( VoxelColumn& column : m_vColumns )
+        column.accountMemory( report );
+}
+
+void VoxelLattice::estimateMemory( Utils::MemoryReport& report, long sites )
+{
+    report.add( Utils::MemoryReport::SITES, sizeof( VoxelLattice ) + Utils::MemoryReport::block( sites*sizeof( VoxelColumn ) )
+                + 2*Utils::MemoryReport::block( sites*sizeof( int ) ) + sites*Utils::MemoryReport::block( 2*sizeof( int ) ) );
+}
@@ -0,0 +1,141 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef VOXEL_LATTICE_H
+#define VOXEL_LATTICE_H
+
+#include <vector>
+
+#include "pointers.h"
+
+using namespace std;
+
+namespace SurfaceTiles
+{
+
+class Site;
+
+/** The occupancy of a column of the lattice stored as runs of occupied layers.
+ * A compact film is a single run whatever its thickness. Every void (vacancy or the
+ * space below an overhang) splits a run in two. */
+
+class VoxelColumn
+{
+public:
+    /// Constructor. An empty column.
+    VoxelColumn();
+
+    /// Destructor.
+    virtual ~VoxelColumn();
+
+    /// Occupies the layers [0, top).
+    void fill( int top );
+
+    /// True if the layer is occupied.
+    bool isOccupied( int layer );
+
+    /// Occupies a layer merging it with the adjacent runs.
+    void occupy( int layer );
+
+    /// Empties a layer splitting its run if needed.
+    void vacate( int layer );
+
+    /// One past the highest occupied layer. Zero if the column is empty.
+    inline int getTop() { return m_vRuns.empty() ? 0 : m_vRuns.back(); }
+
+    /// The number of runs of occupied layers.
+    inline int getNumRuns() { return m_vRuns.size()/2; }
+
+    /// The number of occupied layers.
+    int getNumVoxels();
+
+    /// Adds the runs to the memory report (not the column, which is part of the lattice).
+    void accountMemory( Utils::MemoryReport& report );
+
+private:
+    /// The runs as [start, end) pairs, sorted and never adjacent.
+    vector<int> m_vRuns;
+
+    /// The first run whose end is not below layer.
+    int mf_find( int layer );
+};
+
+}
+
+/** A 3D occupancy (voxel) mode on top of the solid-on-solid lattice. Every site keeps
+ * a run length encoded column of its occupied layers, while the growth front (the top of
+ * each column) is kept in a dense array that the deposition rule reads. A particle that
+ * arrives at a site sticks at the first contact with the columns of its NESW neighbours
+ * (ballistic deposition), so a particle landing next to a taller column leaves a void below
+ * it. The height of the site is the height of the top layer of its column.
+ * A layer is two height units, as the processes change the heights by two. */
+
+class VoxelLattice: public Pointers
+{
+public:
+    /// Constructor
+    VoxelLattice( Apothesis* apothesis );
+
+    /// Destructor
+    virtual ~VoxelLattice();
+
+    /// Fills the column of every site up to its current height.
+    void init();
+
+    /// Adds a layer to the column of the site where the arriving particle sticks
+    /// and returns the new height of the site.
+    int deposit( SurfaceTiles::Site* site );
+
+    /// Removes the top layer of the column of the site and returns the new height of the site.
+    int remove( SurfaceTiles::Site* site );
+
+    /// True if the layer of the column of site id is occupied.
+    inline bool isOccupied( int id, int layer ) { return m_vColumns[ id ].isOccupied( layer ); }
+
+    /// Returns the column of site id.
+    inline SurfaceTiles::VoxelColumn& getColumn( int id ) { return m_vColumns[ id ]; }
+
+    /// The number of occupied voxels.
+    long getNumVoxels();
+
+    /// The number of empty voxels below the growth front.
+    long getNumVacancies();
+
+    /// The number of runs in all the columns.
+    long getNumRuns();
+
+    /// Adds the columns and the growth front to the memory report.
+    void accountMemory( Utils::MemoryReport& report );
+
+    /// Adds the projection of a compact film (a run per column) on a lattice with sites sites to the memory report.
+    static void estimateMemory( Utils::MemoryReport& report, long sites );
+
+private:
+    /// The run length encoded columns
+    vector< SurfaceTiles::VoxelColumn > m_vColumns;
+
+    /// The growth front: one past the top layer of each column
+    vector<int> m_vTop;
+
+    /// The parity of the height of each site which the processes preserve
+    vector<int> m_vParity;
+
+    /// The layer of a height
+    int mf_layer( int height );
+};
+
+#endif // VOXEL_LATTICE_H
@@ -0,0 +1,9 @@
+# libapothesis: Apothesis without main.cpp for embedding the KMC in other codes
+# (the C++ API in apothesis.h and the C API in api/apothesis_c.h)
+
+include(Apothesis.pro)
+
+TEMPLATE = lib
+TARGET = apothesis
+CONFIG += staticlib
+SOURCES -= main.cpp
@@ -53,14 +53,24 @@ int main( int argc, char* argv[] )
 
     Apothesis* apothesis = new Apothesis( argc, argv );
 
-
+    if ( apothesis->isDryRun() ){
+      apothesis->estimateMemory();
+      delete apothesis;
+      return 0;
+    }
 
 
     cout << "Initiating Apothesis" << endl;
     apothesis->init();
 
-    cout << "Executing Apothesis" << endl;
-    apothesis->exec();
+    if ( apothesis->isReplay() ){
+      cout << "Replaying the event stream" << endl;
+      apothesis->replay();
+    }
+    else {
+      cout << "Executing Apothesis" << endl;
+      apothesis->exec();
+    }
 
     if ( apothesis )
       delete apothesis;
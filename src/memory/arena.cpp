@@ -0,0 +1,109 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "arena.h"
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace Utils
+{
+
+Arena::Arena( size_t blockSize ):
+  m_iBlockSize( blockSize ),
+  m_pCurrent( 0 ),
+  m_iRemaining( 0 ),
+  m_iUsed( 0 )
+{
+  ;
+}
+
+Arena::~Arena()
+{
+  clear();
+}
+
+void Arena::mf_newBlock( size_t size )
+{
+  if ( size < m_iBlockSize )
+    size = m_iBlockSize;
+
+  char* data = static_cast<char*>( malloc( size ) );
+  if ( !data )
+    throw bad_alloc();
+
+  m_vBlocks.push_back( { data, size } );
+  m_pCurrent = data;
+  m_iRemaining = size;
+}
+
+void* Arena::allocate( size_t size, size_t align )
+{
+  uintptr_t current = reinterpret_cast<uintptr_t>( m_pCurrent );
+  size_t padding = ( align - current % align ) % align;
+
+  if ( !m_pCurrent || padding + size > m_iRemaining )
+  {
+    mf_newBlock( size + align );
+    current = reinterpret_cast<uintptr_t>( m_pCurrent );
+    padding = ( align - current % align ) % align;
+  }
+
+  char* p = m_pCurrent + padding;
+  m_pCurrent = p + size;
+  m_iRemaining -= padding + size;
+  m_iUsed += size;
+
+  return p;
+}
+
+void Arena::reserve( size_t bytes )
+{
+  // Alignment padding between the objects is taken into account by reserving a bit more.
+  if ( bytes + 64 > m_iRemaining )
+    mf_newBlock( bytes + 64 );
+}
+
+void Arena::clear()
+{
+  for ( vector< Destructor >::reverse_iterator it = m_vDestructors.rbegin(); it != m_vDestructors.rend(); ++it )
+    it->destroy( it->object, it->count );
+  m_vDestructors.clear();
+
+  for ( size_t i = 0; i < m_vBlocks.size(); i++ )
+    free( m_vBlocks[ i ].data );
+  m_vBlocks.clear();
+
+  m_pCurrent = 0;
+  m_iRemaining = 0;
+  m_iUsed = 0;
+}
+
+size_t Arena::getBytesUsed()
+{
+  return m_iUsed;
+}
+
+size_t Arena::getBytesReserved()
+{
+  size_t total = 0;
+  for ( size_t i = 0; i < m_vBlocks.size(); i++ )
+    total += m_vBlocks[ i ].size;
+  return total;
+}
+
+}
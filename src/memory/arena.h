@@ -0,0 +1,140 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "parallel.h"
+
+using namespace std;
+
+namespace Utils {
+
+/** A simulation-scoped arena. Everything that lives as long as the simulation
+ * (the lattice, its sites, the species and the processes) is placed here one after
+ * the other in large blocks instead of being new-ed individually.
+ * The arena owns these objects. They must never be deleted by hand: they are destroyed
+ * in reverse order of creation when the arena is destroyed and the blocks are then
+ * released at once. Objects that are trivially destructible cost nothing at teardown. */
+
+class Arena
+  {
+  public:
+    /// Constructor. The size of each block is given in bytes.
+    Arena( size_t blockSize = 1 << 20 );
+
+    /// Destructor. Destroys all the objects of the arena.
+    virtual ~Arena();
+
+    /// Constructs an object of type T in the arena and returns a pointer to it.
+    template< class T, class... Args >
+    T* create( Args&&... args )
+    {
+      void* p = allocate( sizeof( T ), alignof( T ) );
+      T* obj = new ( p ) T( std::forward<Args>( args )... );
+      if ( !is_trivially_destructible<T>::value )
+        m_vDestructors.push_back( { obj, 1, &mf_destroy<T> } );
+      return obj;
+    }
+
+    /// Constructs n objects of type T one after the other in the arena with the same arguments and
+    /// returns a pointer to the first. The objects are constructed in parallel (which also spreads
+    /// the first touch of the memory over the threads) and destroyed in reverse order.
+    template< class T, class... Args >
+    T* createArray( size_t n, const Args&... args )
+    {
+      T* first = static_cast<T*>( allocate( n*sizeof( T ), alignof( T ) ) );
+      parallelFor( 0, n, [ & ]( int, long lo, long hi ){
+        for ( long i = lo; i < hi; i++ )
+          new ( first + i ) T( args... );
+      } );
+      if ( !is_trivially_destructible<T>::value )
+        m_vDestructors.push_back( { first, n, &mf_destroy<T> } );
+      return first;
+    }
+
+    /// Makes sure that the next allocations of (in total) bytes will be contiguous in memory.
+    /// Call this before creating many objects that are traversed together e.g. the lattice sites.
+    void reserve( size_t bytes );
+
+    /// Returns raw memory of the requested size and alignment. Nothing is constructed.
+    void* allocate( size_t size, size_t align );
+
+    /// Destroys all the objects and releases the memory of the arena.
+    void clear();
+
+    /// Returns the bytes handed out by the arena.
+    size_t getBytesUsed();
+
+    /// Returns the bytes that the arena has requested from the system.
+    size_t getBytesReserved();
+
+  private:
+    /// The destructor of an object (or of an array of count objects) that lives in the arena.
+    struct Destructor
+    {
+      void* object;
+      size_t count;
+      void ( *destroy )( void*, size_t );
+    };
+
+    /// A block of memory.
+    struct Block
+    {
+      char* data;
+      size_t size;
+    };
+
+    /// Calls the destructor of type T on the count objects at p, last first.
+    template< class T >
+    static void mf_destroy( void* p, size_t count )
+    {
+      for ( size_t i = count; i > 0; i-- )
+        ( static_cast<T*>( p ) + i - 1 )->~T();
+    }
+
+    /// Allocates a new block of at least size bytes.
+    void mf_newBlock( size_t size );
+
+    /// The default size of a block.
+    size_t m_iBlockSize;
+
+    /// The blocks of the arena.
+    vector< Block > m_vBlocks;
+
+    /// The current position in the last block.
+    char* m_pCurrent;
+
+    /// The bytes left in the last block.
+    size_t m_iRemaining;
+
+    /// The bytes handed out so far.
+    size_t m_iUsed;
+
+    /// The destructors to be called at teardown (in reverse order).
+    vector< Destructor > m_vDestructors;
+  };
+
+}
+
+#endif // ARENA_H
@@ -0,0 +1,111 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "memory_report.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+namespace Utils
+{
+
+static const char* s_names[ MemoryReport::NUM_CATEGORIES ] = {
+  "Lattice sites", "Neighbours", "Process site pools", "Species", "Engine", "I/O buffers"
+};
+
+MemoryReport::MemoryReport()
+{
+  for ( int c = 0; c < NUM_CATEGORIES; c++ )
+    m_aBytes[ c ] = 0;
+}
+
+MemoryReport::~MemoryReport()
+{
+  ;
+}
+
+size_t MemoryReport::getTotal()
+{
+  size_t total = 0;
+  for ( int c = 0; c < NUM_CATEGORIES; c++ )
+    total += m_aBytes[ c ];
+  return total;
+}
+
+vector< string > MemoryReport::report()
+{
+  vector< string > lines;
+  for ( int c = 0; c < NUM_CATEGORIES; c++ ){
+    ostringstream line;
+    line << left << setw( 20 ) << s_names[ c ] << format( m_aBytes[ c ] );
+    lines.push_back( line.str() );
+  }
+
+  ostringstream total;
+  total << left << setw( 20 ) << "Total" << format( getTotal() );
+  lines.push_back( total.str() );
+
+  return lines;
+}
+
+string MemoryReport::format( size_t bytes )
+{
+  const char* units[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+  double value = bytes;
+  int u = 0;
+  while ( value >= 1024 && u < 4 ){
+    value /= 1024;
+    u++;
+  }
+
+  ostringstream s;
+  s << fixed << setprecision( u == 0 ? 0 : 1 ) << value << " " << units[ u ];
+  return s.str();
+}
+
+size_t MemoryReport::getResident()
+{
+  // The second field of statm is the resident set in pages
+  ifstream statm( "/proc/self/statm" );
+  long size = 0, resident = 0;
+  if ( !( statm >> size >> resident ) )
+    return 0;
+
+  return resident*sysconf( _SC_PAGESIZE );
+}
+
+size_t MemoryReport::block( size_t bytes )
+{
+  if ( bytes == 0 )
+    return 0;
+
+  // glibc: a header of a size_t and chunks of 16 bytes, 32 bytes at least
+  size_t chunk = ( bytes + sizeof( size_t ) + 15 ) & ~size_t( 15 );
+  return chunk < 32 ? 32 : chunk;
+}
+
+size_t MemoryReport::capacity( size_t n )
+{
+  size_t c = 0;
+  if ( n > 0 )
+    for ( c = 1; c < n; c *= 2 );
+  return c;
+}
+
+}
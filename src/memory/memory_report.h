@@ -0,0 +1,94 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef MEMORY_REPORT_H
+#define MEMORY_REPORT_H
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace Utils {
+
+/** The memory of a run by subsystem. Every subsystem adds the size of its objects and of the
+ * heap memory of its containers (accountMemory) to a category. The heap memory is computed from
+ * the sizes and the capacities of the containers with the layout of libstdc++ and glibc malloc
+ * (a chunk per allocation, a node per element of a list or a map), so it is close to what the
+ * allocator actually hands out without hooking it. The same functions give the projection of
+ * a dry run (--dry-run) from the sizes alone. */
+
+class MemoryReport
+  {
+  public:
+    /// The categories of the report
+    enum CATEGORY{ SITES, NEIGHBOURS, POOLS, SPECIES, ENGINE, IO, NUM_CATEGORIES };
+
+    /// Constructor. All the categories are empty.
+    MemoryReport();
+
+    /// Destructor.
+    virtual ~MemoryReport();
+
+    /// Adds bytes to a category.
+    inline void add( CATEGORY c, size_t bytes ) { m_aBytes[ c ] += bytes; }
+
+    /// Returns the bytes of a category.
+    inline size_t get( CATEGORY c ) { return m_aBytes[ c ]; }
+
+    /// Returns the bytes of all the categories.
+    size_t getTotal();
+
+    /// The lines of the report: the bytes of each category and the total.
+    vector< string > report();
+
+    /// Returns the bytes in B, KiB, MiB or GiB e.g. "12.5 MiB".
+    static string format( size_t bytes );
+
+    /// Returns the resident memory of the process in bytes. Zero if not available.
+    static size_t getResident();
+
+    /// The bytes that malloc takes for a request of size bytes. Zero for zero bytes.
+    static size_t block( size_t bytes );
+
+    /// The capacity of a vector after n elements are added one at a time (the capacity doubles).
+    static size_t capacity( size_t n );
+
+    /// The heap memory of a vector (not of its elements).
+    template< class T >
+    static size_t heap( const vector< T >& v ) { return block( v.capacity()*sizeof( T ) ); }
+
+    /// The heap memory of a list: a node with two links per element.
+    template< class T >
+    static size_t heap( const list< T >& l ) { return l.size()*block( sizeof( T ) + 2*sizeof( void* ) ); }
+
+    /// The heap memory of a map: a node with a colour and three links per element.
+    template< class K, class V >
+    static size_t heap( const map< K, V >& m ) { return m.size()*block( sizeof( pair< const K, V > ) + 4*sizeof( void* ) ); }
+
+  private:
+    /// The bytes of each category
+    size_t m_aBytes[ NUM_CATEGORIES ];
+  };
+
+}
+
+#endif // MEMORY_REPORT_H
@@ -41,7 +41,8 @@ public:
 //                        m_read(apothesis->pRead),
                         m_txtReader(apothesis->pTxtReader),
                         m_errorHandler(apothesis->pErrorHandler),
-                        m_parameters(apothesis->pParameters)
+                        m_parameters(apothesis->pParameters),
+                        m_arena(apothesis->pArena)
     {}
 
 protected:
@@ -65,6 +66,9 @@ protected:
 
     /// Pointers to the classes of kmc.cpp
     Utils::Parameters*& m_parameters;
+
+    /// Pointers to the classes of kmc.cpp
+    Utils::Arena*& m_arena;
 };
 
 #endif // POINTERS_H
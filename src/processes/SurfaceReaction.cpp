@@ -18,6 +18,12 @@
 #include "SurfaceReaction.h"
 #include "parameters.h"
 #include "register.cpp"
+#include "voxel_lattice.h"
+#include "adsorption.h"
+#include "desorption.h"
+#include "diffusion.h"
+#include "lateral_interactions.h"
+#include "memory_report.h"
 
 namespace MicroProcesses{
 
@@ -39,7 +45,11 @@ m_apothesis(instance),
 m_stoichiometry(stoichiometry),
 m_energy(energy),
 m_preExpFactor(preExpFactor),
-m_immobilized(immobilized)
+m_immobilized(immobilized),
+m_activeSites(0),
+m_bTemplate(false),
+m_bDeposition(false),
+m_iKey(-1)
 {
   // Variable to check if the input file is configured properly
   bool readPositive = false;
@@ -82,6 +92,40 @@ m_immobilized(immobilized)
 
 }
 
+SurfaceReaction::SurfaceReaction
+(
+  Apothesis* instance,
+  ReactionTemplate const& pattern,
+  double energy,
+  double preExpFactor
+)
+:
+m_sName("SurfaceReaction"),
+m_iNeighNum(0),
+m_apothesis(instance),
+m_energy(energy),
+m_preExpFactor(preExpFactor),
+m_immobilized(false),
+m_activeSites(0),
+m_bTemplate(true),
+m_bDeposition(false),
+m_template(pattern),
+m_iKey(-1)
+{
+  for (ReactionTemplate::Term& t : m_template.getReactants())
+    if (t.species)
+    {
+      m_reactants.push_back(t.species);
+      m_stoichReactants.push_back(t.count);
+    }
+
+  for (ReactionTemplate::Term& t : m_template.getProducts())
+  {
+    m_products.push_back(t.species);
+    m_stoichProducts.push_back(t.count);
+  }
+}
+
 SurfaceReaction::~SurfaceReaction(){;}
 
 void SurfaceReaction::init(){;}
@@ -91,6 +135,17 @@ string SurfaceReaction::getName(){ return m_sName; }
 
 void SurfaceReaction::activeSites( Lattice* lattice){
   m_pLattice = lattice;
+
+  if (m_bTemplate)
+  {
+    // Compile the template against the lattice and match every key once
+    m_template.compile(lattice);
+    m_vMatchIndex.assign(m_template.getNumKeys(), -1);
+    for (int key = 0; key < m_template.getNumKeys(); key++)
+      mf_rematch(key);
+    return;
+  }
+
   vector< Site* > vSites = m_pLattice->getSites();
 
   for ( int i = 0; i < m_pLattice->getSize(); i++)
@@ -101,6 +156,13 @@ void SurfaceReaction::activeSites( Lattice* lattice){
 
 void SurfaceReaction::selectSite()
 {
+  if (m_bTemplate)
+  {
+    m_iKey = m_vMatches[rand()%m_vMatches.size()];
+    m_site = m_pLattice->getSite(m_template.getAnchor(m_iKey));
+    return;
+  }
+
   /* This comes from random i.e. picking from the available list for SurfaceReaction randomly */
   int y = rand()%getActiveList().size();
   int counter = 0;
@@ -112,8 +174,41 @@ void SurfaceReaction::selectSite()
     }
 }
 
+void SurfaceReaction::replay(Site* s, int key)
+{
+  if (m_bTemplate)
+  {
+    m_iKey = key;
+    m_site = m_pLattice->getSite(m_template.getAnchor(m_iKey));
+  }
+  else
+    m_site = s;
+
+  perform();
+}
+
+void SurfaceReaction::accountMemory(Utils::MemoryReport& report)
+{
+  report.add(Utils::MemoryReport::POOLS, sizeof(SurfaceReaction) + Utils::MemoryReport::heap(m_lAdsSites) + Utils::MemoryReport::heap(m_vMatches) + Utils::MemoryReport::heap(m_vMatchIndex));
+  m_template.accountMemory(report);
+  m_rate.accountMemory(report);
+}
+
+void SurfaceReaction::estimateMemory(Utils::MemoryReport& report, long sites)
+{
+  // Every key (at most four orientations of every site) matching
+  report.add(Utils::MemoryReport::POOLS, sizeof(SurfaceReaction) + Utils::MemoryReport::block(Utils::MemoryReport::capacity(4*sites)*sizeof(int)) + Utils::MemoryReport::block(4*sites*sizeof(int)));
+  ReactionTemplate::estimateMemory(report, sites);
+}
+
 void SurfaceReaction::perform()
 { 
+  if (m_bTemplate)
+  {
+    mf_performTemplate();
+    return;
+  }
+
   // Perform surface reaction here
   vector<Species*> :: iterator rItr = m_reactants.begin();
   vector<Species*> :: iterator pItr = m_products.begin();
@@ -125,7 +220,7 @@ void SurfaceReaction::perform()
     }
   }
   
-  m_site->setHeight(m_site->getHeight()+2); //TODO generalize + clear species?
+  m_site->setHeight(m_apothesis->pVoxels ? m_apothesis->pVoxels->deposit(m_site) : m_site->getHeight()+2); //TODO generalize + clear species?
 
   // After performing, add site to adsorption list again
   vector<Adsorption*> pAds = m_apothesis->getAdsorptionPointers();
@@ -137,6 +232,7 @@ void SurfaceReaction::perform()
   if (!canReact(m_site))
   {
     m_activeSites--;
+    notifyChannel(0);
   }
   //TODO 
   //if (m_immobilized)
@@ -151,30 +247,95 @@ void SurfaceReaction::perform()
   //}
 }
 
-void SurfaceReaction::mf_removeFromList() { m_lAdsSites.remove( m_site); }
+void SurfaceReaction::mf_removeFromList() { m_lAdsSites.remove( m_site); notifyChannel(0); }
 
-void SurfaceReaction::mf_removeFromList(Site *s) { m_lAdsSites.remove(s); }
+void SurfaceReaction::mf_removeFromList(Site *s) { m_lAdsSites.remove(s); notifyChannel(0); }
 
-void SurfaceReaction::mf_addToList(Site *s) { m_lAdsSites.push_back( s); }
+void SurfaceReaction::mf_addToList(Site *s) { m_lAdsSites.push_back( s); notifyChannel(0); }
 
 
 double SurfaceReaction::getProbability()
 {
+  if (m_bTemplate)
+  {
+    return mf_getRate() * m_vMatches.size();
+  }
+
   if (m_lAdsSites.size() < 1)
   {
     return 0;
   }
 
-  Parameters* parameters = m_apothesis->pParameters;
-  double rate = m_preExpFactor * exp(-m_energy/parameters->getTemperature()/parameters->dR);
+  double rate = mf_getRate();
   return rate * m_activeSites;
 }
 
+double SurfaceReaction::mf_getRate()
+{
+  if (!m_rate.isEmpty())
+    return m_rate.evaluate();
+
+  Parameters* parameters = m_apothesis->pParameters;
+  return m_preExpFactor * exp(-m_energy/parameters->getTemperature()/parameters->dR);
+}
+
+string SurfaceReaction::setRateLaw(const string& text)
+{
+  string error = m_rate.compile(text, {"A", "E"}, {false, false}, m_apothesis);
+  if (error.empty())
+    updateRates();
+  return error;
+}
+
+void SurfaceReaction::updateRates()
+{
+  if (!m_rate.isEmpty())
+  {
+    m_rate.set(PREEXP, m_preExpFactor);
+    m_rate.set(ENERGY, m_energy);
+    m_rate.fold();
+  }
+  Process::updateRates();
+}
+
+bool SurfaceReaction::isCoverageDependent()
+{
+  return m_rate.isCoverageDependent();
+}
+
 list<Site* > SurfaceReaction::getActiveList()
 {
+  if (m_bTemplate)
+  {
+    list<Site* > sites;
+    for (int key : m_vMatches)
+      sites.push_back(m_pLattice->getSite(m_template.getAnchor(key)));
+    return sites;
+  }
+
   return m_lAdsSites;
 }
 
+int SurfaceReaction::getGasReleased(string species)
+{
+	map<string, int>& gas = m_template.getGas();
+	map<string, int>::iterator itr = gas.find(species);
+	return itr == gas.end() ? 0 : itr->second;
+}
+
+string SurfaceReaction::setDeposition()
+{
+	if (!m_bTemplate)
+		return "Only the reactions of the input can be declared as depositing.";
+
+	for (ReactionTemplate::Term& t : m_template.getProducts())
+		if (t.position == ReactionTemplate::CENTRE)
+			return "A depositing reaction cannot leave a surface species on its anchor site.";
+
+	m_bDeposition = true;
+	return "";
+}
+
 const vector<double> SurfaceReaction::getStoichiometry()
 {
   return m_stoichiometry;
@@ -209,6 +370,127 @@ bool SurfaceReaction::canReact(Site* site)
   return true;
 }
 
+void SurfaceReaction::update(Site* site)
+{
+  if (!m_bTemplate)
+  {
+    canReact(site);
+    return;
+  }
+
+  int id = site->getID();
+  for (int k = 0; k < m_template.getNumAffected(id); k++)
+    mf_rematch(m_template.getAffected(id, k));
+}
+
+void SurfaceReaction::mf_rematch(int key)
+{
+  bool matches = m_template.matches(key);
+  int index = m_vMatchIndex[key];
+
+  if (matches && index < 0)
+  {
+    m_vMatchIndex[key] = m_vMatches.size();
+    m_vMatches.push_back(key);
+    notifyChannel(0);
+  }
+  else if (!matches && index >= 0)
+  {
+    // Swap with the last match and pop
+    int last = m_vMatches.back();
+    m_vMatches[index] = last;
+    m_vMatchIndex[last] = index;
+    m_vMatches.pop_back();
+    m_vMatchIndex[key] = -1;
+    notifyChannel(0);
+  }
+}
+
+void SurfaceReaction::mf_removeSpecies(Site* s, Species* species)
+{
+  Adsorption* a = m_apothesis->findAdsorption(species->getName());
+  if (a)
+  {
+    a->takeSpecies(s);
+    return;
+  }
+
+  // A species without adsorption may still desorb
+  s->removeSpecies(species);
+  Desorption* d = m_apothesis->findDesorption(species->getName());
+  if (d && s->getSpeciesCount(species->getId()) == 0)
+    d->mf_removeFromList(s);
+}
+
+void SurfaceReaction::mf_addSpecies(Site* s, Species* species)
+{
+  Adsorption* a = m_apothesis->findAdsorption(species->getName());
+  if (a)
+    a->placeSpecies(s);
+  else
+    s->addSpecies(species);
+}
+
+void SurfaceReaction::mf_performTemplate()
+{
+  // The sites whose species change
+  vector<Site*> touched;
+
+  for (ReactionTemplate::Term& t : m_template.getReactants())
+  {
+    Site* s = m_template.getSite(m_iKey, t.position);
+    if (find(touched.begin(), touched.end(), s) == touched.end())
+      touched.push_back(s);
+
+    if (t.species)
+      for (int i = 0; i < t.count; i++)
+        mf_removeSpecies(s, t.species);
+  }
+
+  for (ReactionTemplate::Term& t : m_template.getProducts())
+  {
+    Site* s = m_template.getSite(m_iKey, t.position);
+    if (find(touched.begin(), touched.end(), s) == touched.end())
+      touched.push_back(s);
+
+    for (int i = 0; i < t.count; i++)
+      mf_addSpecies(s, t.species);
+  }
+
+  // The reactants of a depositing reaction become part of the film on the anchor. The other reactions
+  // (e.g. a hop A* + *@nb -> A*@nb + * or a recombinative desorption) only move species.
+  if (m_bDeposition)
+  {
+    m_site->setHeight(m_apothesis->pVoxels ? m_apothesis->pVoxels->deposit(m_site) : m_site->getHeight()+2);
+    m_site->m_updateNeighbours();
+    m_site->m_updateNeighbourList();
+
+    // The rate classes around the site have changed
+    vector<Adsorption*> pAds = m_apothesis->getAdsorptionPointers();
+    for (vector<Adsorption*>::iterator itr = pAds.begin(); itr != pAds.end(); ++itr)
+      (*itr)->updateRateClasses(m_site);
+  }
+
+  // The sites left empty can adsorb again
+  vector<Adsorption*> pAds = m_apothesis->getAdsorptionPointers();
+  for (Site* s : touched)
+    if (s->getNumSpecies() == 0)
+      for (vector<Adsorption*>::iterator itr = pAds.begin(); itr != pAds.end(); ++itr)
+        if (!(*itr)->isActive(s))
+          (*itr)->mf_addToList(s);
+
+  // The interaction energies around the sites that changed
+  if (m_apothesis->pInteractions)
+    for (Site* s : touched)
+      m_apothesis->pInteractions->update(s);
+
+  // Match again the keys of every reaction around the sites that changed
+  vector<SurfaceReaction*> pSR = m_apothesis->getReactionPointers();
+  for (vector<SurfaceReaction*>::iterator itr = pSR.begin(); itr != pSR.end(); ++itr)
+    for (Site* s : touched)
+      (*itr)->update(s);
+}
+
 void SurfaceReaction::setProcessMap(map< Process*, list<Site* >* >* procMap )
 {
   
@@ -22,6 +22,8 @@
 #include "apothesis.h"
 #include "adsorption.h"
 #include "site.h"
+#include "reaction_template.h"
+#include "rate_law.h"
 
 using namespace std; 
 using namespace SurfaceTiles;
@@ -29,7 +31,7 @@ using namespace SurfaceTiles;
 /* The surface reaction class. */
 namespace MicroProcesses{
 
-class SurfaceReaction: public Process
+class SurfaceReaction final: public Process
 {
 	public:
 		/// Constructor
@@ -43,6 +45,15 @@ class SurfaceReaction: public Process
 			bool immobilized
 		);
 		
+		/// Constructor of a reaction given by a multi-site template (see ReactionTemplate)
+		SurfaceReaction
+		(
+			Apothesis* apothesis,
+			ReactionTemplate const& pattern,
+			double energy,
+			double preExpFactor
+		);
+
 		/// Destructor
 		virtual ~SurfaceReaction();
 		
@@ -54,12 +65,41 @@ class SurfaceReaction: public Process
 		/// Compute the overall probabilities of this process and return it.
 		double getProbability();
 
+		/// The key of the template selected for the last perform
+		int getEventData() { return m_bTemplate ? m_iKey : 0; }
+
+		/// Performs the reaction again on the site (or the template key)
+		void replay(Site* s, int key);
+
+		/// Adds the process, its template and its matches to the memory report
+		void accountMemory(Utils::MemoryReport& report);
+
+		/// Adds the projection of the process on a lattice with sites sites to the memory report
+		static void estimateMemory(Utils::MemoryReport& report, long sites);
+
+		/// Compiles the rate law of the input over the pre-exponential factor A and the energy E [J/mol],
+		/// e.g. A*(T/300)^0.5*exp(-E/(R*T))
+		string setRateLaw(const string& text);
+
+		/// Folds the rate law at the new temperature and notifies the channels
+		void updateRates();
+
+		/// True if the rate law reads a coverage
+		bool isCoverageDependent();
+
     	/// Returns the name of the process.
     	string getName();
 		
 		/// Returns copy of m_stoichiometry
 		const vector<double> getStoichiometry();
 
+		/// The number of molecules of a gas species that an event releases (negative if it consumes them)
+		int getGasReleased(string species);
+
+		/// Declares that the reaction deposits its reactants on the anchor site, which grows by a layer.
+		/// The products must not leave a surface species on the anchor. Returns an error message, empty on success.
+		string setDeposition();
+
     	/// Set the instance of Apothesis.
     	/// This allows to have access to all other functionalities of the KMC class.
     	void setInstance( Apothesis* apothesis ){ m_apothesis = apothesis; }
@@ -86,6 +126,9 @@ class SurfaceReaction: public Process
     	/// Compares the species on a site and checks to see if it can react
     	bool canReact(Site* site);
 
+    	/// The species of the site have changed: match again the template keys that read it
+    	void update(Site* site);
+
 		/// To be deleted
 		void setProcessMap(map< Process*, list<Site* >* >* procMap );
 
@@ -149,6 +192,45 @@ class SurfaceReaction: public Process
 
 		/// Active sites
 		int m_activeSites;
+
+		/// True if the reaction is given by a multi-site template
+		bool m_bTemplate;
+
+		/// True if the reaction deposits: the anchor site grows by a layer after every event
+		bool m_bDeposition;
+
+		/// The multi-site template
+		ReactionTemplate m_template;
+
+		/// The keys of the template that match
+		vector<int> m_vMatches;
+
+		/// The position of each key in m_vMatches, -1 if it does not match
+		vector<int> m_vMatchIndex;
+
+		/// The key selected in selectSite
+		int m_iKey;
+
+		/// The variables of the rate law
+		enum RateVariable{ PREEXP, ENERGY };
+
+		/// The rate law of the input. Empty for the Arrhenius rate.
+		RateLaw m_rate;
+
+		/// Returns the rate of one site (or one match of the template)
+		double mf_getRate();
+
+		/// Adds a key to or removes it from the matches
+		void mf_rematch(int key);
+
+		/// Perform a reaction given by a template
+		void mf_performTemplate();
+
+		/// Remove a species from a site keeping the lists of its desorption and diffusion
+		void mf_removeSpecies(Site* s, Species* species);
+
+		/// Add a species to a site keeping the lists of its desorption and diffusion
+		void mf_addSpecies(Site* s, Species* species);
 };
 
 
@@ -18,6 +18,10 @@
 #include "adsorption.h"
 #include "register.cpp"
 #include "parameters.h"
+#include "voxel_lattice.h"
+#include "lateral_interactions.h"
+#include "parallel.h"
+#include "memory_report.h"
 #include <algorithm>
 
 namespace MicroProcesses
@@ -37,11 +41,16 @@ namespace MicroProcesses
         m_adsorptionSpecies(species),
         m_stickingCoeffs(stickingCoeffs),
         m_massfraction(massFraction),
+        m_dMass(32e-3 / instance->pParameters->dAvogadroNum),
+        m_dSiteDensity(1e+19),
+        m_lPerformed(0),
         m_canDesorb(false),
         m_canDiffuse(false), //TODO: Do I need to initialize m_interactions?
         m_direct(direct)
   {
-    ;
+    // The molecular weight of the species is in g/mol
+    if (species)
+      m_dMass = species->getMW() / 1000.0 / instance->pParameters->dAvogadroNum;
   }
 
   Adsorption::~Adsorption() {}
@@ -56,102 +65,150 @@ namespace MicroProcesses
     m_pLattice = lattice;
     vector<Site *> vSites = m_pLattice->getSites();
 
-    for (int i = 0; i < m_pLattice->getSize(); i++)
-      if (vSites[i]->getID() % 2 != 0)
-      {
-        m_lAdsSites.push_back(vSites[i]);
-        vSites[i]->addProcess(this);
-      }
+    // The sites are split over the threads. Each chunk gathers its own sites which are then
+    // joined in the order of the chunks, so the list is the same as that of a serial pass.
+    vector<vector<Site *>> chunks(Utils::getNumChunks(0, vSites.size()));
+    Utils::parallelFor(0, vSites.size(), [&](int c, long lo, long hi) {
+      for (long i = lo; i < hi; i++)
+        if (vSites[i]->getID() % 2 != 0)
+        {
+          chunks[c].push_back(vSites[i]);
+          vSites[i]->addProcess(this);
+        }
+    });
+
+    m_vAdsIndex.assign(vSites.size(), -1);
+    for (vector<Site *> &chunk : chunks)
+      for (Site *s : chunk)
+        mf_addToList(s);
   }
 
   void Adsorption::selectSite()
   {
     /* This comes from random i.e. picking from the available list for adsorption randomly */
-    int y = rand() % getActiveList().size();
-    int counter = 0;
-    list<Site *>::iterator site = m_lAdsSites.begin();
-    for (; site != m_lAdsSites.end(); site++)
-    {
-      if (counter == y)
-        m_site = (*site);
-      counter++;
-    }
+    m_site = m_vAdsSites[rand() % m_vAdsSites.size()];
   }
 
   void Adsorption::setProcessMap(map<Process *, list<Site *> *> *) {}
 
   void Adsorption::perform()
   {
-    if (m_direct)
+    mf_place();
+
+    // update the number of neighbours this site has and of the sites around it
+    m_site->m_updateNeighbours();
+    m_site->m_updateNeighbourList();
+
+    mf_updateProcesses(m_site);
+
+    // Check to see which other species CANNOT adsorb when this is present, and remove site from their ads lists.
+    for (Adsorption *pAds : mf_getExcluded())
+      pAds->mf_removeFromList(m_site);
+
+    /// Check if there are available sites that it can be performed
+    if (m_vAdsSites.size() == 0 && !m_direct && m_apothesis->getAdsorptionPointers().size() > 1)
     {
-      // If this is direct, simply increase the height, don't add any other parameters, update the neighbours, and return
-      int height = m_site->getHeight();
-      height = height + 2;
-      m_site->setHeight(height);
-      m_site->m_updateNeighbourList();
-      return;
+      cout << "No more " << getName() << " site is available. Exiting..." << endl;
+      m_apothesis->pErrorHandler->error_simple_msg("No " + getName() + " site is available.");
     }
-    // If you can desorb, pre-empt the desorption update by removing n neighbours from desorption list
-    if (canDesorb())
+  }
+
+  long Adsorption::performBulk(long n, function<void()> performed)
+  {
+    vector<Adsorption *> excluded = mf_getExcluded();
+
+    // Each event picks its site among the sites still available. The lattice and the rest of the processes
+    // are updated right after each event, while the site and its neighbours are still in the cache.
+    long events = 0;
+    for (; events < n && !m_vAdsSites.empty(); events++)
     {
-      int initNeighbours = m_site->getNeighboursNum();
-      getDesorption()->updateSiteCounter(initNeighbours, false);
+      selectSite();
+      mf_place();
+
+      m_site->m_updateNeighbours();
+      m_site->m_updateNeighbourList();
+
+      mf_updateProcesses(m_site);
+
+      for (Adsorption *pAds : excluded)
+        pAds->mf_removeFromList(m_site);
+
+      if (performed)
+        performed();
     }
 
-    // Set height to increase if the site is not phantom
-    // ie if this is the first molecule being added to this site
-    if (m_site->getSpecies().size() == 0)
+    return events;
+  }
+
+  void Adsorption::mf_place()
+  {
+    m_lPerformed++;
+
+    // If this is direct, simply increase the height. Otherwise the height increases with the first
+    // molecule added to the site (the site is not phantom).
+    if (m_direct || m_site->getSpecies().size() == 0)
     {
-      m_site->setPhantom(true); //TODO: exclude phantom site from diffusion, cannot adsorb more than stoich. coeff
+      if (!m_direct)
+        m_site->setPhantom(true); //TODO: exclude phantom site from diffusion, cannot adsorb more than stoich. coeff
       int height = m_site->getHeight();
-      height = height + 2;
+      height = m_apothesis->pVoxels ? m_apothesis->pVoxels->deposit(m_site) : height + 2;
       m_site->setHeight(height);
     }
 
     // Adsorb the species by adding the name to the site
-    m_site->addSpecies(m_apothesis->getSpecies(m_adsorptionSpeciesName));
-    // update the number of neighbours this site has
-    m_site->m_updateNeighbourList();
-    //m_site->setNeighboursNum(newNeighbours);
+    if (!m_direct)
+      m_site->addSpecies(m_apothesis->getSpecies(m_adsorptionSpeciesName));
+  }
+
+  void Adsorption::mf_updateProcesses(Site *s)
+  {
+    // This site and its neighbours may have moved to another rate class
+    if (m_direct)
+    {
+      updateRateClasses(s);
+      return;
+    }
 
     // Add desorption site to Desorption class
     if (canDesorb())
     {
-      // Add site as possible desorption site
-      getDesorption()->mf_addToList(m_site);
-      int neighbours = m_site->getNeighboursNum();
-
-      // Updates the list of neighbours in desorption class
-      getDesorption()->updateSiteCounter(neighbours, true);
+      // Add site as possible desorption site in the rate class of its number of neighbours
+      getDesorption()->mf_addToList(s);
 
-      getDesorption()->updateNeighbours(m_site);
+      // Updates the rate classes of the neighbours in desorption class
+      getDesorption()->updateNeighbours(s);
     }
 
     if (canDiffuse())
     {
-      // If you do not find the site on the list already, add to site
-      getDiffusion()->mf_addToList(m_site);
+      // Adds the site or moves it to its new rate class
+      getDiffusion()->mf_addToList(s);
+      getDiffusion()->updateNeighbours(s);
     }
 
+    // The interaction energies around this site have changed
+    if (m_apothesis->pInteractions)
+      m_apothesis->pInteractions->update(s);
+
     for (int i = 0; i < m_apothesis->getReactionPointers().size(); ++i)
     {
       SurfaceReaction *pSR = m_apothesis->getReactionPointers()[i];
-      pSR->canReact(m_site);
+      pSR->update(s);
     }
+  }
 
-    // Check to see which other species CANNOT adsorb when this is present, and remove site from their ads lists.
+  vector<Adsorption *> Adsorption::mf_getExcluded()
+  {
+    vector<Adsorption *> excluded;
+
+    // A direct adsorption leaves no species. With a single adsorption the sites are never removed.
     vector<Adsorption *> pAdsVectors = m_apothesis->getAdsorptionPointers();
-    vector<Adsorption *>::iterator itr = pAdsVectors.begin();
+    if (m_direct || pAdsVectors.size() == 1)
+      return excluded;
 
     // For each of the possible adsorbed molecules, check to see if current molecule needs to be removed from its site
-
-    if (pAdsVectors.size() == 1)
+    for (Adsorption *pAds : pAdsVectors)
     {
-      return;
-    }
-    for (itr; itr != pAdsVectors.end(); ++itr)
-    {
-      Adsorption *pAds = *itr;
       vector<Species *> possibleInteractions = pAds->getInteractions();
       bool found = false;
       for (int i = 0; i < possibleInteractions.size(); ++i)
@@ -163,67 +220,135 @@ namespace MicroProcesses
         }
       }
       if (found == false)
-      {
-        pAds->mf_removeFromList(m_site);
-      }
+        excluded.push_back(pAds);
     }
-    /// Check if there are available sites that it can be performed
-    if (m_lAdsSites.size() == 0)
+    return excluded;
+  }
+
+  void Adsorption::placeSpecies(Site *s)
+  {
+    s->addSpecies(m_apothesis->getSpecies(m_adsorptionSpeciesName));
+
+    if (canDesorb())
+      getDesorption()->mf_addToList(s);
+
+    if (canDiffuse())
+      getDiffusion()->mf_addToList(s);
+  }
+
+  void Adsorption::takeSpecies(Site *s)
+  {
+    s->removeSpecies(m_adsorptionSpecies);
+    if (s->getSpeciesCount(m_adsorptionSpecies->getId()) > 0)
+      return;
+
+    if (canDesorb())
+      getDesorption()->mf_removeFromList(s);
+
+    if (canDiffuse())
+      getDiffusion()->mf_removeFromList(s);
+  }
+
+  void Adsorption::updateRateClasses(Site *s, bool neighbours)
+  {
+    if (canDesorb())
     {
-      cout << "No more " << getName() << " site is available. Exiting..." << endl;
-      m_apothesis->pErrorHandler->error_simple_msg("No " + getName() + " site is available.");
+      getDesorption()->updateSiteCounter(s);
+      if (neighbours)
+        getDesorption()->updateNeighbours(s);
+    }
+    if (canDiffuse())
+    {
+      getDiffusion()->updateSiteCounter(s);
+      if (neighbours)
+        getDiffusion()->updateNeighbours(s);
     }
   }
 
   void Adsorption::mf_removeFromList(Site *s)
   {
-    m_lAdsSites.remove(s);
+    int index = m_vAdsIndex[s->getID()];
+    if (index < 0)
+      return;
+
+    // Swap with the last site and pop
+    Site *last = m_vAdsSites.back();
+    m_vAdsSites[index] = last;
+    m_vAdsIndex[last->getID()] = index;
+    m_vAdsSites.pop_back();
+    m_vAdsIndex[s->getID()] = -1;
+
+    notifyChannel(0);
   }
 
   void Adsorption::mf_removeFromList()
   {
-    m_lAdsSites.remove(m_site);
+    mf_removeFromList(m_site);
     m_site->removeProcess(this);
   }
 
-  void Adsorption::mf_addToList(Site *s) { m_lAdsSites.push_back(s); }
+  void Adsorption::mf_addToList(Site *s)
+  {
+    if (m_vAdsIndex[s->getID()] >= 0)
+      return;
+
+    m_vAdsIndex[s->getID()] = m_vAdsSites.size();
+    m_vAdsSites.push_back(s);
+
+    notifyChannel(0);
+  }
 
-  const double Adsorption::getMassFraction()
+  double Adsorption::getMassFraction()
   {
     return m_massfraction;
   }
 
+  void Adsorption::setMassFraction(double massFraction)
+  {
+    m_massfraction = massFraction;
+    notifyChannel(0);
+  }
+
   list<Site *> Adsorption::getActiveList()
   {
-    return m_lAdsSites;
+    return list<Site *>(m_vAdsSites.begin(), m_vAdsSites.end());
+  }
+
+  bool Adsorption::isActive(Site *s)
+  {
+    return m_vAdsIndex[s->getID()] >= 0;
   }
 
   void Adsorption::test()
   {
-    cout << m_lAdsSites.size() << endl;
+    cout << m_vAdsSites.size() << endl;
   }
 
   double Adsorption::getProbability()
   {
     /* These are parameters values (I/O) */
-    double dNavogadro = m_apothesis->pParameters->dAvogadroNum;
     double dPres = m_apothesis->pParameters->getPressure();
     double dTemp = m_apothesis->pParameters->getTemperature();
     double dkBoltz = m_apothesis->pParameters->dkBoltz;
 
-    //TODO: Is dmass from input file?
-    double dmass = 32e-3 / dNavogadro;
+    double dmass = m_dMass;
     double dpi = 3.14159265;
     double dstick = m_stickingCoeffs;
-    //TODO: Is dCites from input file?
-    double dCites = 1e+19;
+    double dCites = m_dSiteDensity;
     double dy = getMassFraction();
 
     /* Adsorption probability see Lam and Vlachos */
-    double dflux = dstick * dPres * dy / (dCites * sqrt(2.0 * dpi * dmass * dkBoltz * dTemp));
+    double dflux;
+    if (m_rate.isEmpty())
+      dflux = dstick * dPres * dy / (dCites * sqrt(2.0 * dpi * dmass * dkBoltz * dTemp));
+    else
+    {
+      m_rate.set(Y, dy);
+      dflux = m_rate.evaluate();
+    }
 
-    if (m_lAdsSites.size() != 0)
-      return m_lAdsSites.size() * dflux;
+    if (m_vAdsSites.size() != 0)
+      return m_vAdsSites.size() * dflux;
     else
     {
       return 0.0;
@@ -276,6 +401,52 @@ namespace MicroProcesses
     m_site = s;
   }
 
+  void Adsorption::accountMemory(Utils::MemoryReport &report)
+  {
+    report.add(Utils::MemoryReport::POOLS, sizeof(Adsorption) + Utils::MemoryReport::heap(m_vAdsSites) + Utils::MemoryReport::heap(m_vAdsIndex));
+    m_rate.accountMemory(report);
+  }
+
+  void Adsorption::setSiteDensity(double siteDensity)
+  {
+    m_dSiteDensity = siteDensity;
+  }
+
+  string Adsorption::setRateLaw(const string &text)
+  {
+    // Only the mass fraction changes between two folds (e.g. with the gas phase boundary layer)
+    string error = m_rate.compile(text, {"s0", "y", "m", "N0"}, {false, true, false, false}, m_apothesis);
+    if (error.empty())
+      mf_foldRate();
+    return error;
+  }
+
+  void Adsorption::mf_foldRate()
+  {
+    m_rate.set(S0, m_stickingCoeffs);
+    m_rate.set(MASS, m_dMass);
+    m_rate.set(N0, m_dSiteDensity);
+    m_rate.fold();
+  }
+
+  void Adsorption::updateRates()
+  {
+    if (!m_rate.isEmpty())
+      mf_foldRate();
+    Process::updateRates();
+  }
+
+  bool Adsorption::isCoverageDependent()
+  {
+    return m_rate.isCoverageDependent();
+  }
+
+  void Adsorption::estimateMemory(Utils::MemoryReport &report, long sites)
+  {
+    // Every site available
+    report.add(Utils::MemoryReport::POOLS, sizeof(Adsorption) + Utils::MemoryReport::block(Utils::MemoryReport::capacity(sites) * sizeof(Site *)) + Utils::MemoryReport::block(sites * sizeof(int)));
+  }
+
   void Adsorption::addInteraction(Species *s)
   {
     vector<Species *>::iterator itr = std::find(m_interactions.begin(), m_interactions.end(), s);
@@ -22,6 +22,7 @@
 
 #include <iostream>
 #include <list>
+#include <functional>
 #include <math.h>
 
 #include "apothesis.h"
@@ -29,6 +30,7 @@
 #include "diffusion.h"
 #include "SurfaceReaction.h"
 #include "site.h"
+#include "rate_law.h"
 
 using namespace std;
 using namespace SurfaceTiles;
@@ -38,7 +40,7 @@ namespace MicroProcesses{
 /** The adsorption class. Adsoprtion depending on the type of lattice can be performed in different sites.
 For the simplest case e.g. BCC lattices all the sites are available for deposition. */
 
-class Adsorption: public Process
+class Adsorption final: public Process
 {
   public:
     /// Constructor
@@ -82,9 +84,18 @@ class Adsorption: public Process
     /// Perform the process. This is what actually is called by the main KMC instance.
     void perform();
 
+    /// Performs n adsorptions at once (a leap of the tau leaping). Each one picks its site among the sites still
+    /// available. The adsorptions whose sites this species takes are found once for all of them.
+    /// performed is called after each event with its site selected. Returns the number of events, less than n
+    /// if the sites ran out.
+    long performBulk(long n, function<void()> performed);
+
     /// The list of active sites for adsorption.
     list<Site*> getActiveList();
 
+    /// True if the site is in the list of this adsorption
+    bool isActive(Site* s);
+
     /// Here various tests should be putted in order to check for the validity of the process e.g.
     /// the number of the particles in the active surface must be constant (mass is constant).
     void test();
@@ -107,6 +118,12 @@ class Adsorption: public Process
     /// Set site
     void setSite(Site* s);
 
+    /// Adds the process and its available sites to the memory report
+    void accountMemory(Utils::MemoryReport& report);
+
+    /// Adds the projection of the process on a lattice with sites sites to the memory report
+    static void estimateMemory(Utils::MemoryReport& report, long sites);
+
     /// Add new interaction to m_interactions list
     void addInteraction(Species* s);
 
@@ -119,6 +136,49 @@ class Adsorption: public Process
     /// Add a site to a list
     void mf_addToList(Site* s);
 
+    /// Returns the mass fraction of the adsorbing species above the surface
+    double getMassFraction();
+
+    /// Set the mass fraction above the surface e.g. from the gas phase boundary layer
+    void setMassFraction(double massFraction);
+
+    /// Set the site density [sites/m2]. 1e19 if not given.
+    void setSiteDensity(double siteDensity);
+
+    /// Returns the site density [sites/m2]
+    inline double getSiteDensity(){ return m_dSiteDensity; }
+
+    /// Returns the adsorbing species.
+    inline Species* getSpecies(){ return m_adsorptionSpecies; }
+
+    /// Compiles the rate law of the input: the flux per site over the sticking coefficient s0, the mass fraction y,
+    /// the mass of a molecule m [kg] and the site density N0, e.g. s0*P*y/(N0*sqrt(2*pi*m*kB*T))
+    string setRateLaw(const string& text);
+
+    /// Folds the rate law at the new temperature or pressure and notifies the channels
+    void updateRates();
+
+    /// True if the rate law reads a coverage
+    bool isCoverageDependent();
+
+    /// Returns the number of times this process has been performed
+    inline long getPerformed(){ return m_lPerformed; }
+
+    /// Returns the number of the sites available for adsorption
+    inline int getNumSites(){ return m_vAdsSites.size(); }
+
+    /// Puts the species on a site of a surface read from a file. The height is not changed
+    /// but the site is added to the desorption and diffusion of the species.
+    void placeSpecies(Site* s);
+
+    /// Removes the species from a site e.g. consumed by a surface reaction. If none is left the
+    /// site is removed from the desorption and diffusion of the species.
+    void takeSpecies(Site* s);
+
+    /// Moves the site and (optionally) its neighbours to the rate classes of desorption and diffusion
+    /// of their current number of neighbours e.g. after the height of the site has changed.
+    void updateRateClasses(Site* s, bool neighbours = true);
+
   protected:
     /// The kmc instance.
     Apothesis* m_apothesis;
@@ -134,8 +194,6 @@ class Adsorption: public Process
     /// adsroption in a BCC lattice.
     int mf_updateNeighNum();
 
-    const double getMassFraction();
-
     /// The value of the probability of the process is stored here
     double m_dProbability;
 
@@ -154,6 +212,13 @@ class Adsorption: public Process
     /// Mass fractions
     double m_massfraction;
 
+    /// The mass of a molecule [kg] (from the molecular weight of the species) and the site density [sites/m2]
+    double m_dMass;
+    double m_dSiteDensity;
+
+    /// The number of times this process has been performed
+    long m_lPerformed;
+
     /// Return pointer to corresponding desorption class
     Desorption* getDesorption();
 
@@ -173,8 +238,12 @@ class Adsorption: public Process
     /** The lattice of the process */
     Lattice* m_pLattice;
 
-    /// The adsorption list which hold all the available sites for adsorption
-    list<Site* > m_lAdsSites;
+    /// The available sites for adsorption. Removed by swapping with the last one
+    /// so that adding, removing and picking a site are all O(1).
+    vector<Site* > m_vAdsSites;
+
+    /// The position of each site (indexed by the site ID) in m_vAdsSites, -1 if it is not available.
+    vector<int> m_vAdsIndex;
 
     /// Pointer to associated desorption class
     Desorption* m_pDesorption;
@@ -187,6 +256,24 @@ class Adsorption: public Process
     /// Variable to see if this is a direct product species
     bool m_direct = false; 
 
+    /// The variables of the rate law
+    enum RateVariable{ S0, Y, MASS, N0 };
+
+    /// The rate law of the input. Empty for the flux of the kinetic theory.
+    RateLaw m_rate;
+
+    /// Sets the fixed variables of the rate law and folds it
+    void mf_foldRate();
+
+    /// Places the species on the selected site and updates its height. The numbers of neighbours are not updated.
+    void mf_place();
+
+    /// Updates the desorption, diffusion, reactions and interactions after the species was placed on a site
+    void mf_updateProcesses(Site* s);
+
+    /// Returns the adsorptions whose sites are taken by this species
+    vector<Adsorption*> mf_getExcluded();
+
 
   };
 }
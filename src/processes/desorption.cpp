@@ -18,6 +18,11 @@
 #include "desorption.h"
 #include "register.cpp"
 #include "parameters.h"
+#include "voxel_lattice.h"
+#include "SurfaceReaction.h"
+#include "lateral_interactions.h"
+#include "parallel.h"
+#include "memory_report.h"
 
 namespace MicroProcesses{
 
@@ -30,23 +35,27 @@ Desorption::Desorption
     double frequency
 )
 :
+m_apothesis(instance),
 m_sName("Desorption"),
 m_iNeighNum(0), 
-m_apothesis(instance),
+m_canDiffuse(false),
+m_lPerformed(0),
 m_desorptionSpeciesName(speciesName),
 m_desorptionSpecies(species),
 m_desorptionEnergy(energy),
 m_desorptionFrequency(frequency),
-m_maxNeighbours(5), //TODO: initialize maxneighbours
-m_canDiffuse(false)
+m_maxNeighbours(MAX_NEIGHBOURS), //TODO: initialize maxneighbours
+m_classes(6),
+m_iBins(1)
 {
-  // Initialize list to state number of sites with n neighbours
+  m_probabilities = generateProbabilities();
+
+  // A site without neighbours does not desorb. Class n has the rate of n neighbours.
+  m_classRates.push_back(0.0);
   for(int i = 0; i < m_maxNeighbours; ++i)
   {
-    m_numNeighbours.push_back(0);
+    m_classRates.push_back(m_probabilities[i]);
   }
-
-  m_probabilities = generateProbabilities();
 }
 
 Desorption::~Desorption(){}
@@ -63,111 +72,182 @@ void Desorption::activeSites(Lattice* lattice)
 
   m_pLattice = lattice;
   vector< Site* > vSites = m_pLattice->getSites();
+  m_classes.init(m_pLattice->getSize());
+  m_classes.setOwner(this);
 
-  for ( int i = 0; i < m_pLattice->getSize(); i++)
-    if ( vSites[ i ]->getID()%2 != 0 ) {
-      //m_lDesSites.push_back( vSites[ i ] );
-      vSites[ i ]->addProcess( this );
-      }
+  // With lateral interactions every neighbour class is split in bins of the interaction factor
+  if (m_apothesis->pInteractions)
+  {
+    m_iBins = LateralInteractions::NUM_BINS;
+    m_classes.resize((m_maxNeighbours + 1)*m_iBins);
+
+    vector<double> rates;
+    for (int c = 0; c < (int)m_classRates.size(); ++c)
+      rates.insert(rates.end(), m_iBins, m_classRates[c]);
+    m_classRates = rates;
+  }
+
+  // Every site only registers this process with itself
+  Utils::parallelFor( 0, vSites.size(), [ & ]( int, long lo, long hi ){
+    for ( long i = lo; i < hi; i++)
+      if ( vSites[ i ]->getID()%2 != 0 ) {
+        //m_lDesSites.push_back( vSites[ i ] );
+        vSites[ i ]->addProcess( this );
+        }
+  } );
 }
 
 void Desorption::selectSite()
 {
-  /* This comes from random i.e. picking from the available list for Desorption randomly */
-  int len = getActiveList().size();
-  int y = rand()%len;
-  int counter = 0;
-  list<Site* >::iterator site = m_lDesSites.begin();
-  for (; site != m_lDesSites.end(); site++ ){
-    if ( counter == y )
-      m_site = (*site);
-    counter++;
-    }
+  /* Composition-rejection: first the rate class is picked according to its total rate (rate x weight of its sites)
+   * and then a site of this class. Without lateral interactions all the sites of a class have the same rate so the
+   * rejection step always accepts and the selection is O(1) in the number of sites. */
+  double random = (double)rand()/RAND_MAX;
+  int c = m_classes.selectClass(m_classRates, random);
+  if (c == -1)
+    return;
+
+  m_site = m_classes.selectSite(c);
 }
 
 void Desorption::setProcessMap( map< Process*, list<Site* >* >* ){}
 
 void Desorption::perform()
 {
+  m_lPerformed++;
+
   if (m_site->getSpecies().size() == 1)
   {
     int height = m_site->getHeight();
-    height = height - 2;
+    height = m_apothesis->pVoxels ? m_apothesis->pVoxels->remove(m_site) : height - 2;
     m_site->setHeight( height);
   }
   
-  int numNeighbours = m_site->getNeighboursNum();
-
   m_site->removeSpecies(m_apothesis->getSpecies(m_desorptionSpeciesName));
 
-  
   // If there are no longer any species that can be desorbed, remove from list
-  if (m_apothesis->getNumSpecies() == 1)
-  {
-    return;
-  }
-  else if (m_site->getSpecies().size() == 0)
+  if (m_site->getSpecies().size() == 0)
   {
     mf_removeFromList();  
 
     // Access to diffusion class. If we have no more species, we also can't diffuse
-    getDiffusion()->mf_removeFromList(m_site);
+    if (canDiffuse())
+      getDiffusion()->mf_removeFromList(m_site);
   }
   
+  // The height has changed so the neighbours of this site and of the sites around it change
   m_site->m_updateNeighbours();
+  m_site->m_updateNeighbourList();
 
-  // Remove count from list of sites that have n number of neighbours
-  updateSiteCounter(numNeighbours, false);
-  
+  // Move this site and its neighbours to the rate class of their new number of neighbours
+  updateSiteCounter(m_site);
+  updateNeighbours(m_site);
+
+  if (canDiffuse())
+  {
+    getDiffusion()->updateSiteCounter(m_site);
+    getDiffusion()->updateNeighbours(m_site);
+  }
+
+  // The interaction energies around this site have changed
+  if (m_apothesis->pInteractions)
+    m_apothesis->pInteractions->update(m_site);
+
+  // The reactions that read this site may match (or not) now
+  vector<SurfaceReaction *> pSR = m_apothesis->getReactionPointers();
+  for (vector<SurfaceReaction *>::iterator itr = pSR.begin(); itr != pSR.end(); ++itr)
+    (*itr)->update(m_site);
 }
 
 void Desorption::mf_removeFromList() 
 { 
-  m_lDesSites.remove(m_site); 
+  m_classes.remove(m_site); 
   //TODO: Is this necessary?
   m_site->removeProcess( this ); 
 }
 
+void Desorption::mf_removeFromList(Site *s)
+{
+  m_classes.remove(s);
+}
+
 void Desorption::mf_addToList(Site *s) 
 { 
-  m_lDesSites.push_back(s); 
+  m_classes.insert(s, mf_getClass(s), mf_getWeight(s)); 
 }
 
+int Desorption::mf_getClass(Site* s)
+{
+  int neighbours = s->getNeighboursNum();
+  if (neighbours > m_maxNeighbours)
+    neighbours = m_maxNeighbours;
 
-list<Site*> Desorption::getActiveList()
+  if (m_iBins == 1)
+    return neighbours;
+  return neighbours*m_iBins + m_apothesis->pInteractions->getBin(s);
+}
+
+double Desorption::mf_getWeight(Site* s)
 {
-  return m_lDesSites;
+  return m_apothesis->pInteractions ? m_apothesis->pInteractions->getFactor(s) : 1.0;
 }
 
-void Desorption::test()
+int Desorption::getNumChannels()
 {
-  cout << m_lDesSites.size() << endl;
+  return m_classes.getNumClasses();
 }
 
+double Desorption::getChannelProbability(int channel)
+{
+  return m_classRates[channel]*m_classes.getWeight(channel);
+}
 
-double Desorption::getProbability()
+void Desorption::selectChannelSite(int channel)
 {
-  if ( m_lDesSites.size() == 0 )
-  {
-    return 0;
-  }
+  m_site = m_classes.selectSite(channel);
+}
 
-  else if (m_site->getSpeciesName().size() == 0)
-  {
-    return 0;
-  }
-  
-  double prob = 0;
+void Desorption::updateRates()
+{
+  m_probabilities = generateProbabilities();
 
-  // Calculate probability for each possible value of n
-  for (int i = 0; i < m_maxNeighbours; ++i)
-  {
-    prob += m_probabilities[i] * m_numNeighbours[i];
-  }
+  // Same layout as in the constructor, with every class split in m_iBins bins of the interactions
+  for (int c = 0; c < (int)m_classRates.size(); ++c)
+    m_classRates[c] = c < m_iBins ? 0.0 : m_probabilities[c/m_iBins - 1];
 
-  return prob;
+  Process::updateRates();
 }
 
+void Desorption::accountMemory(Utils::MemoryReport &report)
+{
+  report.add(Utils::MemoryReport::POOLS, sizeof(Desorption) + Utils::MemoryReport::heap(m_probabilities) + Utils::MemoryReport::heap(m_classRates));
+  m_rate.accountMemory(report);
+  m_classes.accountMemory(report);
+}
+
+void Desorption::estimateMemory(Utils::MemoryReport &report, long sites, bool interactions)
+{
+  // The layout of activeSites: every neighbour class is split in bins of the interaction factor
+  int classes = (MAX_NEIGHBOURS + 1) * (interactions ? LateralInteractions::NUM_BINS : 1);
+  report.add(Utils::MemoryReport::POOLS, sizeof(Desorption) + Utils::MemoryReport::block(MAX_NEIGHBOURS * sizeof(double)) + Utils::MemoryReport::block(classes * sizeof(double)));
+  RateClasses::estimateMemory(report, sites, classes);
+}
+
+list<Site*> Desorption::getActiveList()
+{
+  list<Site*> sites;
+  for (int c = 0; c < m_classes.getNumClasses(); ++c)
+    for (int i = 0; i < m_classes.getSize(c); ++i)
+      sites.push_back(m_classes.getSite(c, i));
+  return sites;
+}
+
+void Desorption::test()
+{
+  cout << m_classes.getTotal() << endl;
+}
+
+
 vector<double> Desorption::generateProbabilities()
 {
   /* These are parameters values (I/O) */
@@ -178,6 +258,21 @@ vector<double> Desorption::generateProbabilities()
   double energy = m_desorptionEnergy/m_apothesis->pParameters->dAvogadroNum;
 
   vector<double> prob;
+
+  // The rate law of the input is folded once and tabulated over the number of neighbours
+  if (!m_rate.isEmpty())
+  {
+    m_rate.set(NU, m_desorptionFrequency);
+    m_rate.set(ENERGY, m_desorptionEnergy);
+    m_rate.fold();
+    for (int n = 1; n <= m_maxNeighbours; ++n)
+    {
+      m_rate.set(NEIGHBOURS, n);
+      prob.push_back(m_rate.evaluate());
+    }
+    return prob;
+  }
+
   /* Desorption probability see Lam and Vlachos  */
   for (int n = 1; n <= m_maxNeighbours; ++n)
   {
@@ -187,6 +282,19 @@ vector<double> Desorption::generateProbabilities()
   return prob;
 }
 
+string Desorption::setRateLaw(const string& text)
+{
+  string error = m_rate.compile(text, {"nu", "E", "n"}, {false, false, true}, m_apothesis);
+  if (error.empty())
+    updateRates();
+  return error;
+}
+
+bool Desorption::isCoverageDependent()
+{
+  return m_rate.isCoverageDependent();
+}
+
 const double Desorption::getDesorptionEnergy()
 {
   return m_desorptionEnergy;
@@ -227,45 +335,20 @@ void Desorption::setDiffusion(bool canDiffuse)
   m_canDiffuse = canDiffuse;
 }
 
-void Desorption::updateSiteCounter(int neighbours, bool addOrRemove)
+void Desorption::updateSiteCounter(Site* s)
 {
-  //TODO: better bound checking 
-  if (neighbours < 1)
-  {
-    return;
-  } 
-  // Updates list of number of neighbours each possible site has
-  if (addOrRemove)
-  {
-    m_numNeighbours.at(neighbours-1)++;
-  }
-  else
-  {
-    if (m_numNeighbours[neighbours-1] > 0)
-    {
-      m_numNeighbours[neighbours-1]--;
-    }
-  }
+  // Only the sites that can desorb belong to a class
+  if (m_classes.contains(s))
+    m_classes.insert(s, mf_getClass(s), mf_getWeight(s));
 }
 
 void Desorption::updateNeighbours(Site* s)
 {
-  // For all the neighbours of this site remove num sites and update m_numNeighbours
-  vector<Site*> sites = s->getNeighs();
-  //TODO: ensure getNeighs is properly updated within site
-  for(vector<Site*> :: iterator itr = sites.begin(); itr != sites.end(); ++itr)
-  {
-    Site* site = *itr;
-    int currentNeighbours = site->getNeighboursNum();
-    if (currentNeighbours != 0)
-      updateSiteCounter(currentNeighbours, false);
-    m_site = site;
-    // Recalculate the number of sites
-    s->m_updateNeighbours();
-    int updateNeighbours = m_site->getNeighboursNum();
-    if (updateNeighbours != 0)
-      updateSiteCounter(updateNeighbours, true);
-  }
+  // The neighbour lists of the sites around s have already been updated (see Site::m_updateNeighbourList)
+  updateSiteCounter(s->getNeighPosition(Site::EAST));
+  updateSiteCounter(s->getNeighPosition(Site::WEST));
+  updateSiteCounter(s->getNeighPosition(Site::NORTH));
+  updateSiteCounter(s->getNeighPosition(Site::SOUTH));
 }
 
 void Desorption::setSite(Site* s)
@@ -28,6 +28,8 @@
 #include "adsorption.h"
 #include "diffusion.h"
 #include "site.h"
+#include "rate_classes.h"
+#include "rate_law.h"
 
 using namespace std;
 using namespace SurfaceTiles;
@@ -37,7 +39,7 @@ namespace MicroProcesses{
 /** The adsorption class. Adsoprtion depending on the type of lattice can be performed in different sites.
 For the simplest case e.g. BCC lattices all the sites are available for deposition. */
 
-class Desorption: public Process
+class Desorption final: public Process
 {
   public:
     /// Constructor
@@ -60,7 +62,8 @@ class Desorption: public Process
     void setInstance( Apothesis* apothesis ){}
     
     /// Compute the overall probabilities of this processus and return it.
-    double getProbability();
+    /// Sum over the rate classes: rate of n neighbours x number of sites with n neighbours
+    inline double getProbability(){ return m_classes.getTotalRate(m_classRates); }
 
     /// Returns the name of the process.
     string getName();
@@ -104,14 +107,48 @@ class Desorption: public Process
     /// Add a site to a list
     void mf_addToList(Site* s);
 
-    /// Update counter on number of sites with n neighbours
-    void updateSiteCounter(int neighbours, bool addOrRemove);
+    /// Remove a site from a list
+    void mf_removeFromList(Site* s);
+
+    /// Move the site to the rate class of its current number of neighbours
+    void updateSiteCounter(Site* s);
 
-    /// Update counts on neighbours
+    /// Update the rate classes of the neighbours of a site
     void updateNeighbours(Site* s);
 
+    /// Every rate class is a channel
+    int getNumChannels();
+
+    /// The rate of a class times the number of its sites
+    double getChannelProbability(int channel);
+
+    /// Select a site of a rate class uniformly
+    void selectChannelSite(int channel);
+
+    /// Rebuilds the rates of the neighbour classes at the current temperature
+    void updateRates();
+
+    /// Compiles the rate law of the input over the frequency nu, the energy E [J/mol] and the number of neighbours n,
+    /// e.g. nu*exp(-n*E/(R*T))
+    string setRateLaw(const string& text);
+
+    /// True if the rate law reads a coverage
+    bool isCoverageDependent();
+
+    /// Adds the process and its rate classes to the memory report
+    void accountMemory(Utils::MemoryReport& report);
+
+    /// Adds the projection of the process on a lattice with sites sites to the memory report
+    static void estimateMemory(Utils::MemoryReport& report, long sites, bool interactions);
+
+    /// The largest number of neighbours of a rate class
+    static const int MAX_NEIGHBOURS = 5;
+
     /// Set site
     void setSite(Site* s);
+
+    /// Returns the number of times this process has been performed
+    inline long getPerformed(){ return m_lPerformed; }
     
   protected:
     /// The kmc instance.
@@ -148,14 +185,14 @@ class Desorption: public Process
 
     bool canDiffuse();
 
+    /// The number of times this process has been performed
+    long m_lPerformed;
+
   private:
   
     /** The lattice of the process */
     Lattice* m_pLattice;
 
-    /// The desorption list which hold all the available sites for deposition
-    list<Site* > m_lDesSites;
-
     /// Species name that can desorb
     string m_desorptionSpeciesName;
 
@@ -181,12 +218,30 @@ class Desorption: public Process
     // TODO: How to initialize this as a const vector? The value should not change 
     vector<double> m_probabilities;
 
-    // Number of sites with n number of neighbours
-    vector<double> m_numNeighbours;
+    // The rate of each rate class. The class is the number of neighbours (0 has zero rate)
+    vector<double> m_classRates;
 
     // Maximum number of neighbours possible
     const int m_maxNeighbours;
 
+    // The sites that can desorb binned by their number of neighbours
+    RateClasses m_classes;
+
+    // The number of bins of the lateral interaction factor in every neighbour class (1 without interactions)
+    int m_iBins;
+
+    // Returns the rate class of a site
+    int mf_getClass(Site* s);
+
+    // Returns the factor of the rate of a site from its lateral interactions
+    double mf_getWeight(Site* s);
+
+    // The variables of the rate law
+    enum RateVariable{ NU, ENERGY, NEIGHBOURS };
+
+    // The rate law of the input. Empty for the rates of Lam and Vlachos.
+    RateLaw m_rate;
+
 };
 }
 
@@ -21,6 +21,9 @@
 #include "register.cpp"
 #include "parameters.h"
 #include "io.h"
+#include "lateral_interactions.h"
+#include "parallel.h"
+#include "memory_report.h"
 #include <cmath>
 #include <algorithm>
 
@@ -39,16 +42,23 @@ namespace MicroProcesses
         m_diffusionSpecies(species),
         m_diffusionEnergy(energy),
         m_diffusionFrequency(frequency),
+        m_migrationEnergy(4.28e4),
         m_pDesorption(0),
         m_pAdsorption(0),
-        m_maxNeighbours(5)
+        m_maxNeighbours(MAX_NEIGHBOURS),
+        m_classes(6),
+        m_iNeighbour(0),
+        m_iReplayNeighbour(-1),
+        m_iBins(1)
   {
+    m_probabilities = generateProbabilities();
+
+    // A site without neighbours does not diffuse. Class n has the rate of n neighbours.
+    m_classRates.push_back(0.0);
     for (int i = 0; i < m_maxNeighbours; ++i)
     {
-      m_numNeighbours.push_back(0);
+      m_classRates.push_back(m_probabilities[i]);
     }
-
-    m_probabilities = generateProbabilities();
   }
 
   Diffusion::~Diffusion() { ; }
@@ -61,33 +71,49 @@ namespace MicroProcesses
   {
     m_pLattice = lattice;
     vector<Site *> vSites = m_pLattice->getSites();
+    m_classes.init(m_pLattice->getSize());
+    m_classes.setOwner(this);
 
-    for (int i = 0; i < m_pLattice->getSize(); i++)
-      if (vSites[i]->getID() % 2 != 0)
-      {
-        // m_lDiffSites.push_back( vSites[ i ] );
-        vSites[i]->addProcess(this);
-      }
+    // With lateral interactions every neighbour class is split in bins of the interaction factor
+    if (m_apothesis->pInteractions)
+    {
+      m_iBins = LateralInteractions::NUM_BINS;
+      m_classes.resize((m_maxNeighbours + 1) * m_iBins);
+
+      vector<double> rates;
+      for (int c = 0; c < (int)m_classRates.size(); ++c)
+        rates.insert(rates.end(), m_iBins, m_classRates[c]);
+      m_classRates = rates;
+    }
+
+    // Every site only registers this process with itself
+    Utils::parallelFor(0, vSites.size(), [&](int, long lo, long hi) {
+      for (long i = lo; i < hi; i++)
+        if (vSites[i]->getID() % 2 != 0)
+        {
+          // m_lDiffSites.push_back( vSites[ i ] );
+          vSites[i]->addProcess(this);
+        }
+    });
   }
 
   void Diffusion::selectSite()
   {
-    /* This comes from random i.e. picking from the available list for diffusion randomly */
-    int y = rand() % (getActiveList().size());
-    int counter = 0;
-    list<Site *>::iterator site = m_lDiffSites.begin();
-    for (; site != m_lDiffSites.end(); site++)
-    {
-      if (counter == y)
-        m_site = (*site);
-      counter++;
-    }
+    /* Composition-rejection: the rate class is picked according to its total rate and then a site
+     * of this class. Without lateral interactions the sites of a class share the same rate so the rejection step always accepts. */
+    double random = (double)rand() / RAND_MAX;
+    int c = m_classes.selectClass(m_classRates, random);
+    if (c == -1)
+      return;
+
+    m_site = m_classes.selectSite(c);
   }
 
   Site *Diffusion::chooseNeighbour(vector<Site *> neighbours)
   {
     /* This comes from random i.e. picking from the available list for diffusion randomly */
-    int y = rand() % neighbours.size();
+    int y = m_iReplayNeighbour >= 0 ? m_iReplayNeighbour : rand() % neighbours.size();
+    m_iNeighbour = y;
     int counter = 0;
     vector<Site *>::iterator site = neighbours.begin();
     for (; site != neighbours.end(); ++site)
@@ -104,9 +130,6 @@ namespace MicroProcesses
     vector<Site *> neighbours = m_site->getNeighs();
     Site *diffuseTo = chooseNeighbour(neighbours);
 
-    // Get current number of neighbours
-    int currentNeighbourNum = m_site->getNeighboursNum();
-
     // Desorb, then adsorb to that neighbour
     Desorption *d = getDesorption();
     d->setSite(m_site);
@@ -116,23 +139,10 @@ namespace MicroProcesses
     a->setSite(diffuseTo);
     a->perform();
 
-    // update number of neighbours for all adjacent
-    vector<Site *> neigh = m_site->getNeighs();
-    for (vector<Site *>::iterator itr = neigh.begin(); itr != neigh.end(); ++itr)
-    {
-      // update number of possible diffusion sites
-      updateSiteCounter((*itr)->getNeighboursNum(), false);
-      int newNeighbourNum = mf_getNumNeighbours(*itr);
-      updateSiteCounter(newNeighbourNum, true);
-    }
-
-    // update number of possible diffusion sites
-    updateSiteCounter(currentNeighbourNum, false);
-    int newNeighbourNum = diffuseTo->getNeighboursNum();
-    updateSiteCounter(newNeighbourNum, true);
-
-    // get new number of neighbours
-    mf_removeFromList();
+    // The rate classes of both sites and of their neighbours have been updated by the desorption
+    // and the adsorption. Only the origin has to leave the list if nothing is left to diffuse.
+    if (m_site->getSpecies().size() == 0 && m_classes.contains(m_site))
+      mf_removeFromList();
 
     //TODO: Is this function still valid for diffusion process?
     //  mf_updateNeighNum(m_site);
@@ -146,40 +156,39 @@ namespace MicroProcesses
     }
   }
 
+  void Diffusion::replay(Site *s, int neighbour)
+  {
+    m_site = s;
+    m_iReplayNeighbour = neighbour;
+    perform();
+    m_iReplayNeighbour = -1;
+  }
+
   void Diffusion::mf_removeFromList()
   {
-    m_lDiffSites.remove(m_site);
+    m_classes.remove(m_site);
     m_site->removeProcess(this);
   }
 
   void Diffusion::mf_removeFromList(Site *s)
   {
-    m_lDiffSites.remove(s);
+    m_classes.remove(s);
     s->removeProcess(this);
   }
 
   void Diffusion::mf_addToList(Site *s)
   {
-    if (s->getNeighboursNum() == 0)
-    {
-      return;
-    }
-    //TODO: Will this be better with a hashmap/map of some kind? for now, just do a search
-    // If the site doesn't already exist, add
-    if (find(m_lDiffSites.begin(), m_lDiffSites.end(), s) == m_lDiffSites.end())
-    {
-      m_lDiffSites.push_back(s);
-      int numNeighbours = s->getNeighboursNum();
-      if (numNeighbours != 0)
-        updateSiteCounter(numNeighbours, true);
-    }
+    // Sites without neighbours are kept in class 0 (zero rate) so that they move
+    // to their class once a neighbour arrives. Insert also refreshes an existing site.
+    m_classes.insert(s, mf_getClass(s), mf_getWeight(s));
 
-    // If we are in debugging more, print neighbours of the site
+    // If we are in debugging more, print the sites that can diffuse
     if (m_apothesis->getDebugMode())
     {
       IO *pIO = m_apothesis->getIOPointer();
       string output = "Site: " + to_string(s->getID()) + " neighbours ";
-      for (list<Site *>::iterator itr = m_lDiffSites.begin(); itr != m_lDiffSites.end(); ++itr)
+      list<Site *> sites = getActiveList();
+      for (list<Site *>::iterator itr = sites.begin(); itr != sites.end(); ++itr)
       {
         output += to_string((*itr)->getID()) + ", ";
       }
@@ -187,6 +196,22 @@ namespace MicroProcesses
     }
   }
 
+  int Diffusion::mf_getClass(Site *s)
+  {
+    int neighbours = s->getNeighboursNum();
+    if (neighbours > m_maxNeighbours)
+      neighbours = m_maxNeighbours;
+
+    if (m_iBins == 1)
+      return neighbours;
+    return neighbours * m_iBins + m_apothesis->pInteractions->getBin(s);
+  }
+
+  double Diffusion::mf_getWeight(Site *s)
+  {
+    return m_apothesis->pInteractions ? m_apothesis->pInteractions->getFactor(s) : 1.0;
+  }
+
   int Diffusion::mf_getNumNeighbours(Site *site)
   {
     //TODO
@@ -202,39 +227,77 @@ namespace MicroProcesses
     // Can be removed?
   }
 
-  double Diffusion::getProbability()
+  int Diffusion::getNumChannels()
   {
-    if (m_lDiffSites.size() == 0)
-    {
-      return 0;
-    }
+    return m_classes.getNumClasses();
+  }
 
-    double prob = 0;
+  double Diffusion::getChannelProbability(int channel)
+  {
+    return m_classRates[channel] * m_classes.getWeight(channel);
+  }
 
-    // Calculate probability for each possible value of n
-    for (int i = 0; i < m_maxNeighbours; ++i)
-    {
-      prob += m_probabilities[i] * m_numNeighbours[i];
-    }
+  void Diffusion::selectChannelSite(int channel)
+  {
+    m_site = m_classes.selectSite(channel);
+  }
 
-    return prob;
+  void Diffusion::updateRates()
+  {
+    m_probabilities = generateProbabilities();
+
+    // Same layout as in the constructor, with every class split in m_iBins bins of the interactions
+    for (int c = 0; c < (int)m_classRates.size(); ++c)
+      m_classRates[c] = c < m_iBins ? 0.0 : m_probabilities[c/m_iBins - 1];
+
+    Process::updateRates();
+  }
+
+  void Diffusion::accountMemory(Utils::MemoryReport &report)
+  {
+    report.add(Utils::MemoryReport::POOLS, sizeof(Diffusion) + Utils::MemoryReport::heap(m_probabilities) + Utils::MemoryReport::heap(m_classRates));
+    m_classes.accountMemory(report);
+    m_rate.accountMemory(report);
+  }
+
+  string Diffusion::setRateLaw(const string &text)
+  {
+    string error = m_rate.compile(text, {"nu", "E", "Em", "n"}, {false, false, false, true}, m_apothesis);
+    if (error.empty())
+      updateRates();
+    return error;
+  }
+
+  bool Diffusion::isCoverageDependent()
+  {
+    return m_rate.isCoverageDependent();
+  }
+
+  void Diffusion::estimateMemory(Utils::MemoryReport &report, long sites, bool interactions)
+  {
+    // The layout of activeSites: every neighbour class is split in bins of the interaction factor
+    int classes = (MAX_NEIGHBOURS + 1) * (interactions ? LateralInteractions::NUM_BINS : 1);
+    report.add(Utils::MemoryReport::POOLS, sizeof(Diffusion) + Utils::MemoryReport::block(MAX_NEIGHBOURS * sizeof(double)) + Utils::MemoryReport::block(classes * sizeof(double)));
+    RateClasses::estimateMemory(report, sites, classes);
   }
 
   list<Site *> Diffusion::getActiveList()
   {
-    //TODO: Figure out way to keep track of this list! from adsorption and desorption sides
-    return m_lDiffSites;
+    list<Site *> sites;
+    for (int c = 0; c < m_classes.getNumClasses(); ++c)
+      for (int i = 0; i < m_classes.getSize(c); ++i)
+        sites.push_back(m_classes.getSite(c, i));
+    return sites;
   }
 
   void Diffusion::setProcessMap(map<Process *, list<Site *> *> *procMap)
   {
     m_pProcessMap = procMap;
-    (*m_pProcessMap)[this] = &m_lDiffSites;
   }
 
   void Diffusion::test()
   {
-    cout << m_lDiffSites.size() << endl;
+    cout << m_classes.getTotal() << endl;
   }
 
   vector<double> Diffusion::generateProbabilities()
@@ -247,9 +310,24 @@ namespace MicroProcesses
     //later they will be taken from the input file.
     double v0 = m_diffusionFrequency;
     double E = m_diffusionEnergy/m_apothesis->pParameters->dAvogadroNum;
-    double Em = 4.28e4/m_apothesis->pParameters->dAvogadroNum;
+    double Em = m_migrationEnergy/m_apothesis->pParameters->dAvogadroNum;
 
     vector<double> prob;
+
+    // The rate law of the input is folded once and tabulated over the number of neighbours
+    if (!m_rate.isEmpty())
+    {
+      m_rate.set(NU, m_diffusionFrequency);
+      m_rate.set(ENERGY, m_diffusionEnergy);
+      m_rate.set(MIGRATION, m_migrationEnergy);
+      m_rate.fold();
+      for (int n = 1; n <= m_maxNeighbours; ++n)
+      {
+        m_rate.set(NEIGHBOURS, n);
+        prob.push_back(m_rate.evaluate());
+      }
+      return prob;
+    }
     /* Desorption probability see Lam and Vlachos  */
     for (int n = 1; n <= m_maxNeighbours; ++n)
     {
@@ -279,22 +357,19 @@ namespace MicroProcesses
     return m_pDesorption;
   }
 
-  void Diffusion::updateSiteCounter(int neighbours, bool addOrRemove)
+  void Diffusion::updateSiteCounter(Site *s)
   {
-    if (neighbours == 0)
-      return;
-    // Updates list of number of neighbours each possible site has
-    if (addOrRemove)
-    {
-      m_numNeighbours[neighbours - 1]++;
-    }
-    else
-    {
-      if (m_numNeighbours[neighbours - 1] > 0)
-      {
-        m_numNeighbours[neighbours - 1]--;
-      }
-    }
+    // Only the sites that can diffuse belong to a class
+    if (m_classes.contains(s))
+      m_classes.insert(s, mf_getClass(s), mf_getWeight(s));
+  }
+
+  void Diffusion::updateNeighbours(Site *s)
+  {
+    updateSiteCounter(s->getNeighPosition(Site::EAST));
+    updateSiteCounter(s->getNeighPosition(Site::WEST));
+    updateSiteCounter(s->getNeighPosition(Site::NORTH));
+    updateSiteCounter(s->getNeighPosition(Site::SOUTH));
   }
 
 } // namespace MicroProcesses
@@ -19,13 +19,15 @@
 #define DIFFUSION_H
 
 #include "process.h"
+#include "rate_classes.h"
+#include "rate_law.h"
 
 /** The diffusion process. Performs the movement
  * of a particle to diffrent positions on the surface. */
 
 namespace MicroProcesses{
 
-class Diffusion: public Process
+class Diffusion final: public Process
 {
 public:
      /// Constructor
@@ -46,7 +48,8 @@ public:
     void setName(string s){ m_sName = s;}
 
     /// Compute the overall probabilities of this process and return it.
-    double getProbability();
+    /// Sum over the rate classes: rate of n neighbours x number of sites with n neighbours
+    inline double getProbability(){ return m_classes.getTotalRate(m_classRates); }
 
     /// Returns the name of the process.
     string getName();
@@ -87,7 +90,45 @@ public:
     /// Returns true if the process can be performed in the site that callls it.
     bool controltRules( Site* site );
 
-    void updateSiteCounter(int neighbours, bool addOrRemove);
+    /// Move the site to the rate class of its current number of neighbours
+    void updateSiteCounter(Site* s);
+
+    /// Update the rate classes of the neighbours of a site
+    void updateNeighbours(Site* s);
+
+    /// Every rate class is a channel
+    int getNumChannels();
+
+    /// The rate of a class times the number of its sites
+    double getChannelProbability(int channel);
+
+    /// Select a site of a rate class uniformly
+    void selectChannelSite(int channel);
+
+    /// Rebuilds the rates of the neighbour classes at the current temperature
+    void updateRates();
+
+    /// Compiles the rate law of the input over the frequency nu, the energies E and Em [J/mol] and the number of
+    /// neighbours n, e.g. nu*exp((E - Em)/(R*T))*exp(-n*E/(R*T))
+    string setRateLaw(const string& text);
+
+    /// True if the rate law reads a coverage
+    bool isCoverageDependent();
+
+    /// Adds the process and its rate classes to the memory report
+    void accountMemory(Utils::MemoryReport& report);
+
+    /// Adds the projection of the process on a lattice with sites sites to the memory report
+    static void estimateMemory(Utils::MemoryReport& report, long sites, bool interactions);
+
+    /// The largest number of neighbours of a rate class
+    static const int MAX_NEIGHBOURS = 5;
+
+    /// The neighbour chosen by the last perform
+    int getEventData(){ return m_iNeighbour; }
+
+    /// Diffuses from the site to the given neighbour
+    void replay(Site* s, int neighbour);
 
     // Set adsorption pointer
     void setAdsorptionPointer(Adsorption* a);
@@ -127,6 +168,9 @@ public:
     /// Frequency
     double m_diffusionFrequency;
 
+    /// The energy barrier of the migration [J/mol]
+    double m_migrationEnergy;
+
     // Get access to the adsorption pointer
     Adsorption* getAdsorption();
 
@@ -140,9 +184,6 @@ private:
     /** The lattice of the process */
     Lattice* m_pLattice;
 
-    /// The diffusion list which hold all the available sites for diffusion
-    list<Site* > m_lDiffSites;
-
     /** Pointer to the process map */
     map< Process*, list<Site*>* >* m_pProcessMap;
 
@@ -152,13 +193,34 @@ private:
     // Vector to hold the probabilities. Number of neighbour - 1 = index of list
     vector<double> m_probabilities;
 
-    // Number of sites with n number of neighbours
-    // TODO: How to initialize this as a const vector? The value should not change 
-    vector<double> m_numNeighbours;
+    // The rate of each rate class. The class is the number of neighbours (0 has zero rate)
+    vector<double> m_classRates;
 
     // Maximum number of neighbours possible
     const int m_maxNeighbours;
 
+    // The sites that can diffuse binned by their number of neighbours
+    RateClasses m_classes;
+
+    // The neighbour chosen by the last perform and the one to be chosen by a replay (-1 to pick at random)
+    int m_iNeighbour;
+    int m_iReplayNeighbour;
+
+    // The number of bins of the lateral interaction factor in every neighbour class (1 without interactions)
+    int m_iBins;
+
+    // Returns the rate class of a site
+    int mf_getClass(Site* s);
+
+    // Returns the factor of the rate of a site from its lateral interactions
+    double mf_getWeight(Site* s);
+
+    // The variables of the rate law
+    enum RateVariable{ NU, ENERGY, MIGRATION, NEIGHBOURS };
+
+    // The rate law of the input. Empty for the rates of Lam and Vlachos.
+    RateLaw m_rate;
+
     // Pointer to associated adsorption class
     Adsorption* m_pAdsorption;
 
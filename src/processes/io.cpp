@@ -461,7 +461,7 @@ void IO::writeLatticeHeights()
       int index = j + i * m_lattice->getY();
       m_OutFile
           << "( "
-          << m_lattice->getSites()[index]->getHeight()
+          << m_lattice->getSite(index)->getHeight()
           << ", [ ";
 
       // TODO: assign default species to each site
@@ -0,0 +1,166 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "lateral_interactions.h"
+#include "lattice.h"
+#include "site.h"
+#include "parameters.h"
+#include "adsorption.h"
+#include "desorption.h"
+#include "memory_report.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace MicroProcesses;
+
+LateralInteractions::LateralInteractions( Apothesis* apothesis ):Pointers( apothesis ),
+    m_iSpecies( apothesis->getNumSpecies() ),
+    m_vPairs( m_iSpecies*m_iSpecies, 0.0 ),
+    m_dInvRT( 0.0 )
+{
+}
+
+LateralInteractions::~LateralInteractions()
+{
+}
+
+int LateralInteractions::mf_id( Site* s )
+{
+    return s->getID();
+}
+
+void LateralInteractions::addPair( Species* a, Species* b, double energy )
+{
+    m_vPairs[ a->getId()*m_iSpecies + b->getId() ] = energy;
+    m_vPairs[ b->getId()*m_iSpecies + a->getId() ] = energy;
+
+    if ( find( m_vInteracting.begin(), m_vInteracting.end(), a ) == m_vInteracting.end() )
+        m_vInteracting.push_back( a );
+    if ( find( m_vInteracting.begin(), m_vInteracting.end(), b ) == m_vInteracting.end() )
+        m_vInteracting.push_back( b );
+}
+
+void LateralInteractions::init( vector<Adsorption*> adsorption, vector<Desorption*> desorption )
+{
+    m_vAdsorption = adsorption;
+    m_vDesorption = desorption;
+    m_dInvRT = 1.0/( m_parameters->dR*m_parameters->getTemperature() );
+
+    int size = m_lattice->getSize();
+
+    // The neighbour relation of the lattice is not always symmetric, so the sites whose energy
+    // depends on each site are stored explicitly (counted first then filled)
+    Site::NeighPoisition lateral[] = { Site::EAST, Site::WEST, Site::NORTH, Site::SOUTH };
+    m_vDependentOffsets.assign( size + 1, 0 );
+    for ( int i = 0; i < size; i++ )
+        for ( Site::NeighPoisition np : lateral )
+            if ( m_lattice->getSite( i )->getNeighPosition( np ) )
+                m_vDependentOffsets[ m_lattice->getSite( i )->getNeighPosition( np )->getID() + 1 ]++;
+
+    for ( int i = 0; i < size; i++ )
+        m_vDependentOffsets[ i + 1 ] += m_vDependentOffsets[ i ];
+
+    m_vDependents.resize( m_vDependentOffsets[ size ] );
+    vector<int> fill( m_vDependentOffsets.begin(), m_vDependentOffsets.end() - 1 );
+    for ( int i = 0; i < size; i++ )
+        for ( Site::NeighPoisition np : lateral )
+            if ( m_lattice->getSite( i )->getNeighPosition( np ) )
+                m_vDependents[ fill[ m_lattice->getSite( i )->getNeighPosition( np )->getID() ]++ ] = i;
+
+    m_vEnergy.assign( size, 0.0 );
+    m_vFactor.assign( size, 1.0 );
+    m_vBin.assign( size, NUM_BINS/2 );
+
+    for ( int i = 0; i < size; i++ )
+        mf_evaluate( m_lattice->getSite( i ) );
+}
+
+void LateralInteractions::mf_evaluate( Site* s )
+{
+    Site::NeighPoisition lateral[] = { Site::EAST, Site::WEST, Site::NORTH, Site::SOUTH };
+
+    double energy = 0.0;
+    for ( Species* a : m_vInteracting )
+    {
+        int na = s->getSpeciesCount( a->getId() );
+        if ( na == 0 )
+            continue;
+
+        for ( Site::NeighPoisition np : lateral )
+        {
+            Site* neigh = s->getNeighPosition( np );
+            if ( !neigh )
+                continue;
+
+            for ( Species* b : m_vInteracting )
+                energy += na*neigh->getSpeciesCount( b->getId() )*m_vPairs[ a->getId()*m_iSpecies + b->getId() ];
+        }
+    }
+
+    int id = s->getID();
+    m_vEnergy[ id ] = energy;
+    m_vFactor[ id ] = exp( energy*m_dInvRT );
+
+    // log2 of the factor shifted so that a factor of one is in the middle bin
+    int bin = (int)floor( energy*m_dInvRT/log( 2.0 ) ) + NUM_BINS/2;
+    m_vBin[ id ] = min( max( bin, 0 ), NUM_BINS - 1 );
+}
+
+void LateralInteractions::update( Site* s )
+{
+    mf_refresh( s );
+
+    int id = s->getID();
+    for ( int k = m_vDependentOffsets[ id ]; k < m_vDependentOffsets[ id + 1 ]; k++ )
+        mf_refresh( m_lattice->getSite( m_vDependents[ k ] ) );
+}
+
+void LateralInteractions::updateTemperature()
+{
+    m_dInvRT = 1.0/( m_parameters->dR*m_parameters->getTemperature() );
+
+    for ( int i = 0; i < m_lattice->getSize(); i++ )
+        mf_refresh( m_lattice->getSite( i ) );
+}
+
+void LateralInteractions::mf_refresh( Site* s )
+{
+    mf_evaluate( s );
+
+    // Move the site to the classes of its new factor
+    for ( Desorption* d : m_vDesorption )
+        d->updateSiteCounter( s );
+
+    for ( Adsorption* a : m_vAdsorption )
+        a->updateRateClasses( s, false );
+}
+
+void LateralInteractions::accountMemory( Utils::MemoryReport& report )
+{
+    report.add( Utils::MemoryReport::ENGINE, sizeof( LateralInteractions ) + Utils::MemoryReport::heap( m_vPairs ) + Utils::MemoryReport::heap( m_vInteracting )
+                + Utils::MemoryReport::heap( m_vDependentOffsets ) + Utils::MemoryReport::heap( m_vDependents ) + Utils::MemoryReport::heap( m_vEnergy )
+                + Utils::MemoryReport::heap( m_vFactor ) + Utils::MemoryReport::heap( m_vBin ) );
+}
+
+void LateralInteractions::estimateMemory( Utils::MemoryReport& report, long sites )
+{
+    // The energy, the factor and the bin of every site and the sites that read each of its four neighbours
+    report.add( Utils::MemoryReport::ENGINE, sizeof( LateralInteractions ) + Utils::MemoryReport::block( ( sites + 1 )*sizeof( int ) )
+                + Utils::MemoryReport::block( 4*sites*sizeof( int ) ) + 2*Utils::MemoryReport::block( sites*sizeof( double ) )
+                + Utils::MemoryReport::block( sites*sizeof( int ) ) );
+}
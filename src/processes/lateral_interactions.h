@@ -0,0 +1,122 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef LATERAL_INTERACTIONS_H
+#define LATERAL_INTERACTIONS_H
+
+#include <vector>
+
+#include "pointers.h"
+
+using namespace std;
+
+namespace SurfaceTiles { class Site; }
+namespace MicroProcesses { class Adsorption; class Desorption; }
+
+/** Pairwise lateral interactions between adsorbed species (the pair terms of a cluster expansion
+ * truncated at the NESW neighbours). The local interaction energy of a site is
+ *
+ *    E(i) = sum over the neighbours j of i and the species a on i, b on j of eps(a, b)
+ *
+ * and a positive (repulsive) energy lowers the barrier of desorption and diffusion from the site,
+ * so their rates are multiplied by exp( E(i)/RT ). The energies and factors are cached per site.
+ * When the species of a site change only the site and the sites that have it as a NESW neighbour
+ * are evaluated again and their desorption and diffusion rate classes are refreshed. The factor of a site also gives its
+ * bin (factor in [2^b, 2^(b+1))) inside the rate class so that composition-rejection accepts at least
+ * half of the attempts. */
+
+class LateralInteractions: public Pointers
+{
+public:
+    /// The number of bins of the interaction factor in every rate class
+    static const int NUM_BINS = 32;
+
+    /// Constructor
+    LateralInteractions( Apothesis* apothesis );
+
+    /// Destructor
+    virtual ~LateralInteractions();
+
+    /// Adds the interaction energy [J/mol] of species a next to species b (and b next to a).
+    void addPair( Species* a, Species* b, double energy );
+
+    /// Evaluates the energy of every site. The rate classes of the desorption and of the diffusion
+    /// (through the adsorption of the same species) are refreshed on every update.
+    void init( vector< MicroProcesses::Adsorption* > adsorption, vector< MicroProcesses::Desorption* > desorption );
+
+    /// The species of the site have changed: evaluates again the site and the sites that read it
+    /// and moves them to their new desorption and diffusion rate classes.
+    void update( SurfaceTiles::Site* s );
+
+    /// The temperature has changed: the factors of all the sites are evaluated again and the sites
+    /// are moved to their new rate classes. O(sites).
+    void updateTemperature();
+
+    /// The cached local interaction energy of a site [J/mol].
+    inline double getEnergy( SurfaceTiles::Site* s ) { return m_vEnergy[ mf_id( s ) ]; }
+
+    /// The factor exp( E/RT ) of the rates from a site.
+    inline double getFactor( SurfaceTiles::Site* s ) { return m_vFactor[ mf_id( s ) ]; }
+
+    /// The bin of the factor of a site in [0, NUM_BINS).
+    inline int getBin( SurfaceTiles::Site* s ) { return m_vBin[ mf_id( s ) ]; }
+
+    /// Adds the energies, the factors and the dependents of the sites to the memory report.
+    void accountMemory( Utils::MemoryReport& report );
+
+    /// Adds the projection of the interactions on a lattice with sites sites to the memory report.
+    static void estimateMemory( Utils::MemoryReport& report, long sites );
+
+private:
+    /// The number of species
+    int m_iSpecies;
+
+    /// The pair energies as a species x species matrix
+    vector<double> m_vPairs;
+
+    /// The species that interact with any other
+    vector<Species*> m_vInteracting;
+
+    /// The sites that have each site as a NESW neighbour in compressed rows
+    vector<int> m_vDependentOffsets;
+    vector<int> m_vDependents;
+
+    /// The cached energy, factor and bin of each site
+    vector<double> m_vEnergy;
+    vector<double> m_vFactor;
+    vector<int> m_vBin;
+
+    /// 1/RT
+    double m_dInvRT;
+
+    /// The adsorption processes
+    vector< MicroProcesses::Adsorption* > m_vAdsorption;
+
+    /// The desorption processes
+    vector< MicroProcesses::Desorption* > m_vDesorption;
+
+    /// Evaluates the energy, factor and bin of a site
+    void mf_evaluate( SurfaceTiles::Site* s );
+
+    /// Evaluates a site and moves it to its new rate classes
+    void mf_refresh( SurfaceTiles::Site* s );
+
+    /// The id of a site
+    int mf_id( SurfaceTiles::Site* s );
+};
+
+#endif // LATERAL_INTERACTIONS_H
@@ -36,11 +36,24 @@ using namespace SurfaceTiles;
 //TODO: how to access pIO from children of this class?
 namespace MicroProcesses{
 
+class Process;
+
+/** Receives the channels whose probability may have changed (e.g. a selection engine that keeps
+ * the probabilities of the channels and only recomputes those that have changed). */
+class ChannelListener
+  {
+  public:
+    virtual ~ChannelListener(){}
+
+    /// The probability of the channel of the process may have changed.
+    virtual void channelChanged( Process* p, int channel ) = 0;
+  };
+
 class Process
   {
   public:
     /// Constructor of the interface.
-    Process(){}
+    Process():m_pListener( 0 ), m_iIndex( -1 ){}
 
     /// Destructor.
     virtual ~Process(){}
@@ -68,6 +81,42 @@ class Process
     /// Calculate and get the Probability of this process.
     virtual double getProbability() = 0;
 
+    /// The number of channels of this process. A channel is a group of sites with the same rate
+    /// (e.g. a rate class) and it is what the next reaction method schedules. By default one.
+    virtual int getNumChannels(){ return 1; }
+
+    /// The probability of a channel. The probabilities of all the channels sum to getProbability().
+    virtual double getChannelProbability( int /*channel*/ ){ return getProbability(); }
+
+    /// Select the site that this process will be performed from the sites of a channel.
+    virtual void selectChannelSite( int /*channel*/ ){ selectSite(); }
+
+    /// What the last perform chose beyond the site (e.g. the neighbour of a diffusion) so that
+    /// the event can be replayed from an event stream. By default nothing.
+    virtual int getEventData(){ return 0; }
+
+    /// Performs an event of an event stream again: the site and the choice of getEventData are given.
+    virtual void replay( Site* s, int /*data*/ ){ m_site = s; perform(); }
+
+    /// Recomputes the rates after the temperature or the pressure has changed and notifies the channels.
+    /// By default the probability is computed from the parameters on demand, so only the channels are notified.
+    virtual void updateRates(){ for ( int c = 0; c < getNumChannels(); c++ ) notifyChannel( c ); }
+
+    /// Sets the rate law given in the input (see RateLaw). Returns an error message, empty on success.
+    /// By default a process takes no rate law.
+    virtual string setRateLaw( const string& /*text*/ ){ return "The process " + getName() + " does not take a rate law."; }
+
+    /// Returns true if the rate depends on the coverages. Then updateRates is called after every event.
+    virtual bool isCoverageDependent(){ return false; }
+
+    /// Sets the numeric parameters of a process created by the factory (see the plugin keyword).
+    /// By default nothing.
+    virtual void setParameters( vector<double> /*parameters*/ ){}
+
+    /// Adds the process and the pools of the sites where it can be performed to the memory report.
+    /// By default nothing.
+    virtual void accountMemory( Utils::MemoryReport& /*report*/ ){}
+
     /// Get the list of active sites where the process can be performed.
     /// This is updated after a process is performed.
     virtual list<Site* > getActiveList() =0;
@@ -77,10 +126,28 @@ class Process
 
     int getSite();
 
+    /// Sets the listener that is notified when the probability of a channel may have changed.
+    void setListener( ChannelListener* listener ){ m_pListener = listener; }
+
+    /// Called by the process (or its rate classes) when the probability of a channel may have changed.
+    inline void notifyChannel( int channel ){ if ( m_pListener ) m_pListener->channelChanged( this, channel ); }
+
+    /// Sets the position of the process in the processes of the simulation.
+    void setIndex( int index ){ m_iIndex = index; }
+
+    /// The position of the process in the processes of the simulation, by which its events are counted. -1 if not set.
+    inline int getIndex(){ return m_iIndex; }
+
     protected:
     
     /// The site that desorption is performed
     Site* m_site;
+
+    /// The listener of the changes of the channels. Null if none.
+    ChannelListener* m_pListener;
+
+    /// The position of the process in the processes of the simulation
+    int m_iIndex;
   };
 
 }
@@ -0,0 +1,194 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "rate_classes.h"
+#include "site.h"
+#include "process.h"
+#include "memory_report.h"
+
+#include <cstdlib>
+#include <algorithm>
+
+namespace MicroProcesses
+{
+
+RateClasses::RateClasses( int numClasses ):m_vClasses( numClasses ),
+                                          m_vSums( numClasses, 0.0 ),
+                                          m_vMax( numClasses, 0.0 ),
+                                          m_pOwner( 0 ){;}
+
+RateClasses::~RateClasses(){;}
+
+void RateClasses::init( int size )
+{
+  m_vClass.assign( size, -1 );
+  m_vPos.assign( size, -1 );
+  m_vWeight.assign( size, 0.0 );
+}
+
+void RateClasses::resize( int numClasses )
+{
+  m_vClasses.assign( numClasses, vector< Site* >() );
+  m_vSums.assign( numClasses, 0.0 );
+  m_vMax.assign( numClasses, 0.0 );
+}
+
+bool RateClasses::contains( Site* s )
+{
+  return m_vClass[ s->getID() ] != -1;
+}
+
+int RateClasses::getClass( Site* s )
+{
+  return m_vClass[ s->getID() ];
+}
+
+void RateClasses::insert( Site* s, int c, double weight )
+{
+  int id = s->getID();
+  if ( m_vClass[ id ] == c )
+  {
+    if ( m_vWeight[ id ] == weight )
+      return;
+
+    // Same class, new weight
+    m_vSums[ c ] += weight - m_vWeight[ id ];
+    m_vWeight[ id ] = weight;
+    if ( weight > m_vMax[ c ] )
+      m_vMax[ c ] = weight;
+    if ( m_pOwner )
+      m_pOwner->notifyChannel( c );
+    return;
+  }
+
+  if ( m_vClass[ id ] != -1 )
+    remove( s );
+
+  m_vClass[ id ] = c;
+  m_vPos[ id ] = m_vClasses[ c ].size();
+  m_vClasses[ c ].push_back( s );
+  m_vWeight[ id ] = weight;
+  m_vSums[ c ] += weight;
+  if ( weight > m_vMax[ c ] )
+    m_vMax[ c ] = weight;
+  if ( m_pOwner )
+    m_pOwner->notifyChannel( c );
+}
+
+void RateClasses::remove( Site* s )
+{
+  int id = s->getID();
+  int c = m_vClass[ id ];
+  if ( c == -1 )
+    return;
+
+  // Swap with the last site of the class so that the removal is O(1)
+  vector< Site* >& sites = m_vClasses[ c ];
+  Site* last = sites.back();
+  sites[ m_vPos[ id ] ] = last;
+  m_vPos[ last->getID() ] = m_vPos[ id ];
+  sites.pop_back();
+
+  // An empty class also drops the round-off of its sum and its bound
+  m_vSums[ c ] -= m_vWeight[ id ];
+  if ( sites.empty() )
+  {
+    m_vSums[ c ] = 0.0;
+    m_vMax[ c ] = 0.0;
+  }
+
+  m_vClass[ id ] = -1;
+  m_vPos[ id ] = -1;
+  m_vWeight[ id ] = 0.0;
+  if ( m_pOwner )
+    m_pOwner->notifyChannel( c );
+}
+
+Site* RateClasses::selectSite( int c )
+{
+  vector< Site* >& sites = m_vClasses[ c ];
+  for ( int attempt = 1; ; attempt++ )
+  {
+    Site* s = sites[ rand()%sites.size() ];
+    double weight = m_vWeight[ s->getID() ];
+
+    // Sites with the largest weight (e.g. all the sites without interactions) are always accepted
+    if ( weight >= m_vMax[ c ] || (double)rand()/RAND_MAX*m_vMax[ c ] < weight )
+      return s;
+
+    // The bound is only raised on insertion. If it has become loose tighten it to the largest weight.
+    if ( attempt%64 == 0 )
+    {
+      m_vMax[ c ] = 0.0;
+      for ( Site* site : sites )
+        m_vMax[ c ] = max( m_vMax[ c ], m_vWeight[ site->getID() ] );
+    }
+  }
+}
+
+int RateClasses::getTotal()
+{
+  int total = 0;
+  for ( int c = 0; c < (int)m_vClasses.size(); c++ )
+    total += m_vClasses[ c ].size();
+  return total;
+}
+
+void RateClasses::accountMemory( Utils::MemoryReport& report )
+{
+  size_t bytes = Utils::MemoryReport::heap( m_vClasses ) + Utils::MemoryReport::heap( m_vClass ) + Utils::MemoryReport::heap( m_vPos )
+               + Utils::MemoryReport::heap( m_vWeight ) + Utils::MemoryReport::heap( m_vSums ) + Utils::MemoryReport::heap( m_vMax );
+  for ( int c = 0; c < (int)m_vClasses.size(); c++ )
+    bytes += Utils::MemoryReport::heap( m_vClasses[ c ] );
+
+  report.add( Utils::MemoryReport::POOLS, bytes );
+}
+
+void RateClasses::estimateMemory( Utils::MemoryReport& report, long sites, int numClasses )
+{
+  // The class, the position and the weight of every site, the vectors, the sums and the bounds of the classes
+  // and the sites in the vectors, whose capacities are at most twice their sizes
+  report.add( Utils::MemoryReport::POOLS, 2*Utils::MemoryReport::block( sites*sizeof( int ) ) + Utils::MemoryReport::block( sites*sizeof( double ) )
+              + Utils::MemoryReport::block( numClasses*sizeof( vector< SurfaceTiles::Site* > ) ) + 2*Utils::MemoryReport::block( numClasses*sizeof( double ) )
+              + 2*sites*sizeof( SurfaceTiles::Site* ) + numClasses*Utils::MemoryReport::block( sizeof( SurfaceTiles::Site* ) ) );
+}
+
+int RateClasses::selectClass( const vector<double>& rates, double random )
+{
+  double total = getTotalRate( rates );
+  if ( total <= 0.0 )
+    return -1;
+
+  double target = random*total;
+  double cumulative = 0.0;
+  int last = -1;
+  for ( int c = 0; c < (int)m_vClasses.size(); c++ )
+  {
+    if ( rates[ c ]*m_vSums[ c ] <= 0.0 )
+      continue;
+
+    cumulative += rates[ c ]*m_vSums[ c ];
+    last = c;
+    if ( target < cumulative )
+      return c;
+  }
+
+  // Round-off: return the last class with non zero weight
+  return last;
+}
+
+}
@@ -0,0 +1,134 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef RATE_CLASSES_H
+#define RATE_CLASSES_H
+
+#include <vector>
+
+using namespace std;
+
+namespace SurfaceTiles { class Site; }
+namespace Utils { class MemoryReport; }
+
+namespace MicroProcesses{
+
+class Process;
+
+/** The sites where a process can be performed binned in rate classes.
+ * For desorption and diffusion the class of a site is its number of neighbours
+ * since all the sites with the same number of neighbours have the same rate.
+ * Each class is a plain vector and every site knows its position in it,
+ * so adding, moving, removing and picking a site are all O(1).
+ * A site may carry a weight (e.g. the factor of its lateral interactions) that
+ * multiplies the rate of its class. Then a site is picked with composition-rejection:
+ * uniformly in its class and accepted with weight / (largest weight of the class). */
+
+class RateClasses
+{
+public:
+    /// Constructor. The classes are numbered from 0 to numClasses - 1.
+    RateClasses( int numClasses );
+
+    /// Destructor
+    virtual ~RateClasses();
+
+    /// Allocates the per site bookkeeping for a lattice with size sites.
+    void init( int size );
+
+    /// Changes the number of classes. Must be called before any site is inserted.
+    void resize( int numClasses );
+
+    /// Sets the process whose channels are the classes. It is notified whenever the weight of a class changes.
+    inline void setOwner( Process* owner ) { m_pOwner = owner; }
+
+    /// Returns true if the site belongs to any class.
+    bool contains( SurfaceTiles::Site* s );
+
+    /// Returns the class of the site or -1 if it does not belong to any.
+    int getClass( SurfaceTiles::Site* s );
+
+    /// Puts the site in class c with a weight. If it already belongs to another class it is moved.
+    void insert( SurfaceTiles::Site* s, int c, double weight = 1.0 );
+
+    /// Removes the site from its class.
+    void remove( SurfaceTiles::Site* s );
+
+    /// Returns the number of sites in class c.
+    inline int getSize( int c ) { return m_vClasses[ c ].size(); }
+
+    /// Returns the number of sites in all classes.
+    int getTotal();
+
+    /// Returns the number of classes.
+    inline int getNumClasses() { return m_vClasses.size(); }
+
+    /// Returns the i-th site of class c.
+    inline SurfaceTiles::Site* getSite( int c, int i ) { return m_vClasses[ c ][ i ]; }
+
+    /// Returns the sum of the weights of the sites in class c. Equal to the size if all weights are one.
+    inline double getWeight( int c ) { return m_vSums[ c ]; }
+
+    /// Rejection step: picks a site of class c with probability proportional to its weight.
+    SurfaceTiles::Site* selectSite( int c );
+
+    /// Composition step: selects a class with probability proportional to rates[c]*weight(c).
+    /// random must be in [0, 1). Returns -1 if all the classes have zero weight.
+    int selectClass( const vector<double>& rates, double random );
+
+    /// Returns the sum of rates[c]*weight(c) over all the classes. Inline since it is called by the
+    /// probability of the process in every step.
+    inline double getTotalRate( const vector<double>& rates )
+    {
+      double total = 0.0;
+      for ( int c = 0; c < (int)m_vClasses.size(); c++ )
+        total += rates[ c ]*m_vSums[ c ];
+      return total;
+    }
+
+    /// Adds the classes and the per site bookkeeping to the memory report (not the object, which is part of its owner).
+    void accountMemory( Utils::MemoryReport& report );
+
+    /// Adds the projection of numClasses classes of a lattice with sites sites, all of them in a class, to the memory report.
+    static void estimateMemory( Utils::MemoryReport& report, long sites, int numClasses );
+
+private:
+    /// The sites of each class.
+    vector< vector< SurfaceTiles::Site* > > m_vClasses;
+
+    /// The class of each site (indexed by the site ID), -1 if it does not belong to a class.
+    vector< int > m_vClass;
+
+    /// The position of each site (indexed by the site ID) in the vector of its class.
+    vector< int > m_vPos;
+
+    /// The weight of each site (indexed by the site ID).
+    vector< double > m_vWeight;
+
+    /// The sum of the weights of the sites of each class.
+    vector< double > m_vSums;
+
+    /// An upper bound of the weights of the sites of each class. Reset when the class empties.
+    vector< double > m_vMax;
+
+    /// The process that owns the classes. Null if none.
+    Process* m_pOwner;
+};
+
+}
+
+#endif // RATE_CLASSES_H
@@ -0,0 +1,302 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "rate_expression.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+
+namespace MicroProcesses{
+
+RateExpression::RateExpression():m_iPos( 0 ), m_iDepth( 0 ){;}
+
+RateExpression::~RateExpression(){;}
+
+string RateExpression::parse( const string& text, const vector<string>& names )
+{
+  m_sText = text;
+  m_iPos = 0;
+  m_vNames = names;
+  m_sError.clear();
+  m_iDepth = 0;
+  m_vSource.clear();
+  m_vCode.clear();
+
+  if ( mf_peek() == 0 )
+    return "The rate expression is empty.";
+
+  mf_parseSum();
+  if ( m_sError.empty() && mf_peek() != 0 )
+    m_sError = "Unexpected '" + string( 1, m_sText[ m_iPos ] ) + "' in the rate expression " + m_sText + ".";
+
+  if ( !m_sError.empty() ){
+    m_vSource.clear();
+    return m_sError;
+  }
+
+  // Until the first fold nothing is fixed
+  m_vCode = m_vSource;
+  return "";
+}
+
+char RateExpression::mf_peek()
+{
+  while ( m_iPos < m_sText.size() && isspace( (unsigned char)m_sText[ m_iPos ] ) )
+    m_iPos++;
+  return m_iPos < m_sText.size() ? m_sText[ m_iPos ] : 0;
+}
+
+void RateExpression::mf_emit( OpCode op, int variable, double value )
+{
+  Instruction i = { op, variable, value };
+  m_vSource.push_back( i );
+
+  if ( op == PUSH || op == LOAD )
+    m_iDepth++;
+  else if ( op != NEG && op != EXP && op != LOG && op != SQRT )
+    m_iDepth--;
+
+  if ( m_iDepth > MAX_DEPTH && m_sError.empty() )
+    m_sError = "The rate expression " + m_sText + " is nested too deeply.";
+}
+
+void RateExpression::mf_parseSum()
+{
+  mf_parseProduct();
+  while ( m_sError.empty() ){
+    char c = mf_peek();
+    if ( c != '+' && c != '-' )
+      return;
+    m_iPos++;
+    mf_parseProduct();
+    mf_emit( c == '+' ? ADD : SUB );
+  }
+}
+
+void RateExpression::mf_parseProduct()
+{
+  mf_parseUnary();
+  while ( m_sError.empty() ){
+    char c = mf_peek();
+    if ( c != '*' && c != '/' )
+      return;
+    m_iPos++;
+    mf_parseUnary();
+    mf_emit( c == '*' ? MUL : DIV );
+  }
+}
+
+void RateExpression::mf_parseUnary()
+{
+  if ( mf_peek() == '-' ){
+    m_iPos++;
+    mf_parseUnary();
+    mf_emit( NEG );
+  }
+  else if ( mf_peek() == '+' ){
+    m_iPos++;
+    mf_parseUnary();
+  }
+  else
+    mf_parsePower();
+}
+
+void RateExpression::mf_parsePower()
+{
+  mf_parsePrimary();
+
+  // Right associative: a^b^c is a^(b^c) and a^-b is a^(-b)
+  if ( m_sError.empty() && mf_peek() == '^' ){
+    m_iPos++;
+    mf_parseUnary();
+    mf_emit( POW );
+  }
+}
+
+void RateExpression::mf_parsePrimary()
+{
+  if ( !m_sError.empty() )
+    return;
+
+  char c = mf_peek();
+  if ( c == '(' ){
+    m_iPos++;
+    mf_parseSum();
+    if ( m_sError.empty() && mf_peek() != ')' )
+      m_sError = "Missing ')' in the rate expression " + m_sText + ".";
+    m_iPos++;
+    return;
+  }
+
+  if ( isdigit( (unsigned char)c ) || c == '.' ){
+    const char* start = m_sText.c_str() + m_iPos;
+    char* end;
+    double value = strtod( start, &end );
+    if ( end == start ){
+      m_sError = "Could not read the number at '" + m_sText.substr( m_iPos ) + "' in the rate expression.";
+      return;
+    }
+    m_iPos += end - start;
+    mf_emit( PUSH, -1, value );
+    return;
+  }
+
+  if ( !isalpha( (unsigned char)c ) && c != '_' ){
+    m_sError = c == 0 ? "The rate expression " + m_sText + " ends unexpectedly."
+                      : "Unexpected '" + string( 1, c ) + "' in the rate expression " + m_sText + ".";
+    return;
+  }
+
+  size_t start = m_iPos;
+  while ( m_iPos < m_sText.size() && ( isalnum( (unsigned char)m_sText[ m_iPos ] ) || m_sText[ m_iPos ] == '_' ) )
+    m_iPos++;
+  string name = m_sText.substr( start, m_iPos - start );
+
+  // A function call
+  if ( mf_peek() == '(' ){
+    OpCode op;
+    int arguments = 1;
+    if ( name == "exp" ) op = EXP;
+    else if ( name == "log" ) op = LOG;
+    else if ( name == "sqrt" ) op = SQRT;
+    else if ( name == "min" ){ op = MIN; arguments = 2; }
+    else if ( name == "max" ){ op = MAX; arguments = 2; }
+    else {
+      m_sError = "Unknown function " + name + " in the rate expression " + m_sText + ".";
+      return;
+    }
+
+    m_iPos++;
+    for ( int a = 0; a < arguments && m_sError.empty(); a++ ){
+      if ( a > 0 ){
+        if ( mf_peek() != ',' ){
+          m_sError = "The function " + name + " takes " + to_string( arguments ) + " arguments.";
+          return;
+        }
+        m_iPos++;
+      }
+      mf_parseSum();
+    }
+    if ( m_sError.empty() && mf_peek() != ')' )
+      m_sError = "Missing ')' after the arguments of " + name + " in the rate expression " + m_sText + ".";
+    m_iPos++;
+    mf_emit( op );
+    return;
+  }
+
+  for ( int v = 0; v < (int)m_vNames.size(); v++ )
+    if ( m_vNames[ v ] == name ){
+      mf_emit( LOAD, v );
+      return;
+    }
+
+  string known;
+  for ( const string& n : m_vNames )
+    known += " " + n;
+  m_sError = "Unknown variable " + name + " in the rate expression " + m_sText + ". The variables are" + known + ".";
+}
+
+bool RateExpression::uses( int variable )
+{
+  for ( const Instruction& i : m_vCode )
+    if ( i.op == LOAD && i.variable == variable )
+      return true;
+  return false;
+}
+
+inline double RateExpression::mf_apply( OpCode op, double a, double b )
+{
+  switch ( op ){
+    case ADD: return a + b;
+    case SUB: return a - b;
+    case MUL: return a*b;
+    case DIV: return a/b;
+    case POW: return pow( a, b );
+    case NEG: return -a;
+    case EXP: return exp( a );
+    case LOG: return log( a );
+    case SQRT: return sqrt( a );
+    case MIN: return a < b ? a : b;
+    case MAX: return a > b ? a : b;
+    default: return a;
+  }
+}
+
+void RateExpression::fold( const vector<double>& values, const vector<bool>& fixed )
+{
+  m_vCode.clear();
+
+  // Whether each entry of the stack is known here. A known entry is the last PUSH of the code.
+  vector<bool> constant;
+  for ( const Instruction& i : m_vSource ){
+    if ( i.op == PUSH || ( i.op == LOAD && fixed[ i.variable ] ) ){
+      Instruction push = { PUSH, -1, i.op == PUSH ? i.value : values[ i.variable ] };
+      m_vCode.push_back( push );
+      constant.push_back( true );
+    }
+    else if ( i.op == LOAD ){
+      m_vCode.push_back( i );
+      constant.push_back( false );
+    }
+    else if ( i.op == NEG || i.op == EXP || i.op == LOG || i.op == SQRT ){
+      if ( constant.back() )
+        m_vCode.back().value = mf_apply( i.op, m_vCode.back().value, 0.0 );
+      else
+        m_vCode.push_back( i );
+    }
+    else {
+      bool b = constant.back();
+      constant.pop_back();
+      bool a = constant.back();
+
+      if ( a && b ){
+        double value = mf_apply( i.op, m_vCode[ m_vCode.size() - 2 ].value, m_vCode.back().value );
+        m_vCode.pop_back();
+        m_vCode.back().value = value;
+      }
+      else {
+        m_vCode.push_back( i );
+        constant.back() = false;
+      }
+    }
+  }
+}
+
+double RateExpression::evaluate( const double* values ) const
+{
+  double stack[ MAX_DEPTH ];
+  int top = -1;
+  for ( const Instruction& i : m_vCode ){
+    switch ( i.op ){
+      case PUSH: stack[ ++top ] = i.value; break;
+      case LOAD: stack[ ++top ] = values[ i.variable ]; break;
+      case NEG: case EXP: case LOG: case SQRT: stack[ top ] = mf_apply( i.op, stack[ top ], 0.0 ); break;
+      default:
+        top--;
+        stack[ top ] = mf_apply( i.op, stack[ top ], stack[ top + 1 ] );
+    }
+  }
+  return stack[ 0 ];
+}
+
+size_t RateExpression::getHeap()
+{
+  return ( m_vSource.capacity() + m_vCode.capacity() )*sizeof( Instruction );
+}
+
+}
@@ -0,0 +1,111 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef RATE_EXPRESSION_H
+#define RATE_EXPRESSION_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace MicroProcesses{
+
+/** An arithmetic expression over named variables (e.g. a rate law) compiled to a postfix program.
+ *
+ *    nu*exp(-(E - 500*theta_O2)/(R*T))
+ *
+ * The operators are + - * / ^ and unary minus, the functions exp, log, sqrt, min and max.
+ * A name is the index of a variable given to parse. The text is parsed once. Then fold replaces the
+ * variables that are fixed in a condition (e.g. the temperature) by their values and computes once every
+ * operation on constants, so that evaluate runs only what depends on the variables left. */
+
+class RateExpression
+{
+public:
+    /// Constructor
+    RateExpression();
+
+    /// Destructor
+    virtual ~RateExpression();
+
+    /// Compiles the text. The names are the variables it may use. Returns an error message, empty on success.
+    string parse( const string& text, const vector<string>& names );
+
+    /// Returns true if nothing has been compiled.
+    inline bool isEmpty() { return m_vSource.empty(); }
+
+    /// Returns true if the expression reads a variable (its index in the names of parse).
+    bool uses( int variable );
+
+    /// Specializes the expression: the variables marked fixed are replaced by their values and folded.
+    void fold( const vector<double>& values, const vector<bool>& fixed );
+
+    /// Returns true if the folded expression is a constant.
+    inline bool isConstant() { return m_vCode.size() == 1 && m_vCode[ 0 ].op == PUSH; }
+
+    /// Evaluates the folded expression. values holds all the variables (the fixed ones are not read).
+    double evaluate( const double* values ) const;
+
+    /// Returns the size of the instructions (source and folded) on the heap.
+    size_t getHeap();
+
+private:
+    /// The instructions of the postfix program
+    enum OpCode{ PUSH, LOAD, ADD, SUB, MUL, DIV, POW, NEG, EXP, LOG, SQRT, MIN, MAX };
+
+    struct Instruction
+    {
+        OpCode op;
+        int variable;
+        double value;
+    };
+
+    /// The largest stack of an expression
+    static const int MAX_DEPTH = 32;
+
+    /// The program of the text and the program folded for the current condition
+    vector<Instruction> m_vSource;
+    vector<Instruction> m_vCode;
+
+    /// The state of the parser
+    string m_sText;
+    size_t m_iPos;
+    vector<string> m_vNames;
+    string m_sError;
+    int m_iDepth;
+
+    /// The recursive descent: sum, product, unary, power and primary (number, name, call or parentheses).
+    void mf_parseSum();
+    void mf_parseProduct();
+    void mf_parseUnary();
+    void mf_parsePower();
+    void mf_parsePrimary();
+
+    /// Skips the white space and returns the next character (0 at the end).
+    char mf_peek();
+
+    /// Appends an instruction to the source and tracks the depth of the stack.
+    void mf_emit( OpCode op, int variable = -1, double value = 0.0 );
+
+    /// Applies an operator to its operands (b is not read by the unary ones).
+    static inline double mf_apply( OpCode op, double a, double b );
+};
+
+}
+
+#endif // RATE_EXPRESSION_H
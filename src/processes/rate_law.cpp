@@ -0,0 +1,89 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "rate_law.h"
+#include "apothesis.h"
+#include "parameters.h"
+#include "species.h"
+#include "memory_report.h"
+
+namespace MicroProcesses{
+
+RateLaw::RateLaw():m_pApothesis( 0 ), m_pLattice( 0 ), m_bConstant( false ), m_dConstant( 0.0 ){;}
+
+RateLaw::~RateLaw(){;}
+
+string RateLaw::compile( const string& text, const vector<string>& names, const vector<bool>& dynamic, Apothesis* apothesis )
+{
+  m_pApothesis = apothesis;
+  m_pLattice = apothesis->pLattice;
+
+  vector<string> variables = { "T", "P", "kB", "NA", "R", "pi" };
+  variables.insert( variables.end(), names.begin(), names.end() );
+  m_vFixed.assign( variables.size(), true );
+  for ( int v = 0; v < (int)dynamic.size(); v++ )
+    m_vFixed[ NUM_COMMON + v ] = !dynamic[ v ];
+
+  // The coverages follow the variables of the process
+  map<string, Species*> species = apothesis->getAllSpecies();
+  vector<int> ids;
+  for ( const auto& [name, s] : species ){
+    if ( !s )
+      continue;
+    variables.push_back( "theta_" + name );
+    ids.push_back( s->getId() );
+    m_vFixed.push_back( false );
+  }
+
+  string error = m_expression.parse( text, variables );
+  if ( !error.empty() )
+    return error;
+
+  m_vValues.assign( variables.size(), 0.0 );
+  m_vCoverages.clear();
+  int first = NUM_COMMON + names.size();
+  for ( int i = 0; i < (int)ids.size(); i++ )
+    if ( m_expression.uses( first + i ) )
+      m_vCoverages.push_back( make_pair( first + i, ids[ i ] ) );
+
+  return "";
+}
+
+void RateLaw::fold()
+{
+  Utils::Parameters* parameters = m_pApothesis->pParameters;
+  m_vValues[ T ] = parameters->getTemperature();
+  m_vValues[ P ] = parameters->getPressure();
+  m_vValues[ KB ] = parameters->dkBoltz;
+  m_vValues[ NA ] = parameters->dAvogadroNum;
+  m_vValues[ R ] = parameters->dR;
+  m_vValues[ PI ] = 3.14159265358979323846;
+
+  m_expression.fold( m_vValues, m_vFixed );
+
+  m_bConstant = m_expression.isConstant();
+  if ( m_bConstant )
+    m_dConstant = m_expression.evaluate( m_vValues.data() );
+}
+
+void RateLaw::accountMemory( Utils::MemoryReport& report )
+{
+  report.add( Utils::MemoryReport::POOLS, m_expression.getHeap() + Utils::MemoryReport::heap( m_vValues )
+              + m_vFixed.capacity()/8 + Utils::MemoryReport::heap( m_vCoverages ) );
+}
+
+}
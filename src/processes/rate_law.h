@@ -0,0 +1,111 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef RATE_LAW_H
+#define RATE_LAW_H
+
+#include <string>
+#include <vector>
+
+#include "lattice.h"
+#include "rate_expression.h"
+
+using namespace std;
+
+class Apothesis;
+namespace Utils { class MemoryReport; }
+
+namespace MicroProcesses{
+
+/** A rate law of a process given in the input (see RateExpression), e.g. for a desorption
+ *
+ *    O2* -> O2 + *, simple 1.0e+13 1.0e+13, rate nu*exp(-n*(E - 2000*theta_O2)/(R*T))
+ *
+ * Every law reads the temperature T [K], the pressure P [Pa], the constants kB, NA, R and pi and the
+ * coverage theta_<species> of every species. The process adds its own variables (e.g. nu, E and n).
+ * The law is folded once per condition: the temperature, the pressure and the fixed variables of the
+ * process become constants. The variables marked dynamic (e.g. the number of neighbours of a rate table)
+ * and the coverages are read at every evaluation. A law that reads no coverage is usually a constant
+ * after the fold or is tabulated by its process, so it costs nothing per event. */
+
+class RateLaw
+{
+public:
+    /// The variables of every law
+    enum Common{ T, P, KB, NA, R, PI, NUM_COMMON };
+
+    /// Constructor
+    RateLaw();
+
+    /// Destructor
+    virtual ~RateLaw();
+
+    /// Compiles the law. The names are the variables of the process and dynamic marks the ones that are not folded.
+    /// Returns an error message, empty on success.
+    string compile( const string& text, const vector<string>& names, const vector<bool>& dynamic, Apothesis* apothesis );
+
+    /// Returns true if no law is given (the process uses its own).
+    inline bool isEmpty() { return m_expression.isEmpty(); }
+
+    /// Returns true if the law reads a coverage. Its process is updated after every event.
+    inline bool isCoverageDependent() { return !m_vCoverages.empty(); }
+
+    /// Sets a variable of the process (its index in the names of compile).
+    inline void set( int variable, double value ) { m_vValues[ NUM_COMMON + variable ] = value; }
+
+    /// Folds the law at the current temperature and pressure and the values of the fixed variables.
+    void fold();
+
+    /// Evaluates the law with the current values of the dynamic variables and the coverages.
+    inline double evaluate()
+    {
+      if ( m_bConstant )
+        return m_dConstant;
+
+      for ( const pair<int, int>& c : m_vCoverages )
+        m_vValues[ c.first ] = m_pLattice->getCoverage( c.second );
+      return m_expression.evaluate( m_vValues.data() );
+    }
+
+    /// Adds the law to the memory report (not the object, which is part of its process).
+    void accountMemory( Utils::MemoryReport& report );
+
+private:
+    /// The compiled expression
+    RateExpression m_expression;
+
+    /// The instance of Apothesis (the parameters) and its lattice (the coverages)
+    Apothesis* m_pApothesis;
+    Lattice* m_pLattice;
+
+    /// The values of the variables: the common ones, the ones of the process and the coverages
+    vector<double> m_vValues;
+
+    /// The variables replaced by their values in the fold
+    vector<bool> m_vFixed;
+
+    /// The coverages the law reads: their variable and the id of their species
+    vector< pair<int, int> > m_vCoverages;
+
+    /// The value of a law that is a constant after the fold
+    bool m_bConstant;
+    double m_dConstant;
+};
+
+}
+
+#endif // RATE_LAW_H
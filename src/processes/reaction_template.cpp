@@ -0,0 +1,224 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "reaction_template.h"
+#include "memory_report.h"
+
+#include <cctype>
+
+namespace MicroProcesses
+{
+
+ReactionTemplate::ReactionTemplate():
+    m_iSites( 0 ),
+    m_iOrientations( 1 )
+{
+}
+
+ReactionTemplate::~ReactionTemplate()
+{
+}
+
+string ReactionTemplate::parse( vector<string> reactants, vector<string> products, map<string, Species*> species )
+{
+    for ( string& term : reactants )
+    {
+        string error = mf_parseTerm( term, species, m_vReactants, true );
+        if ( !error.empty() )
+            return error;
+    }
+
+    for ( string& term : products )
+    {
+        string error = mf_parseTerm( term, species, m_vProducts, false );
+        if ( !error.empty() )
+            return error;
+    }
+
+    if ( m_vReactants.empty() )
+        return "A surface reaction needs at least one reactant on the surface.";
+
+    return "";
+}
+
+string ReactionTemplate::mf_parseTerm( string term, map<string, Species*>& species, vector<Term>& terms, bool reactant )
+{
+    string compact;
+    for ( char c : term )
+        if ( !isspace( (unsigned char)c ) )
+            compact += c;
+
+    int position = CENTRE;
+    size_t at = compact.find( '@' );
+    if ( at != string::npos )
+    {
+        string where = compact.substr( at + 1 );
+        compact = compact.substr( 0, at );
+        if ( where == "N" )
+            position = NORTH;
+        else if ( where == "S" )
+            position = SOUTH;
+        else if ( where == "E" )
+            position = EAST;
+        else if ( where == "W" )
+            position = WEST;
+        else if ( where == "nb" )
+            position = NEIGHBOUR;
+        else
+            return "Unknown position " + where + " in reaction term " + term + ". Use N, S, E, W or nb.";
+    }
+
+    size_t digits = 0;
+    while ( digits < compact.size() && isdigit( (unsigned char)compact[ digits ] ) )
+        digits++;
+    int count = digits > 0 ? stoi( compact.substr( 0, digits ) ) : 1;
+    compact = compact.substr( digits );
+
+    if ( compact.empty() || compact.back() != '*' )
+    {
+        // A gas species
+        if ( position != CENTRE )
+            return "Only surface species (with *) can be placed on a neighbour: " + term;
+        if ( !compact.empty() )
+            m_mGas[ compact ] += reactant ? -count : count;
+        return "";
+    }
+    compact.pop_back();
+
+    Species* s = 0;
+    if ( !compact.empty() )
+    {
+        if ( species.find( compact ) == species.end() )
+            return "Unknown species " + compact + " in reaction term " + term + ".";
+        s = species[ compact ];
+    }
+    else if ( !reactant )
+        return "";
+
+    if ( position == NEIGHBOUR )
+        m_iOrientations = 4;
+
+    for ( Term& t : terms )
+        if ( t.position == position && t.species == s )
+        {
+            t.count += count;
+            return "";
+        }
+
+    terms.push_back( { position, s, count } );
+    return "";
+}
+
+void ReactionTemplate::compile( Lattice* lattice )
+{
+    m_vSites = lattice->getSites();
+    m_iSites = m_vSites.size();
+
+    // The neighbour definitions of the lattice type give the sites of the positions
+    Site::NeighPoisition directions[] = { Site::NORTH, Site::SOUTH, Site::EAST, Site::WEST };
+    m_vTable.assign( 5*m_iSites, -1 );
+    for ( int i = 0; i < m_iSites; i++ )
+    {
+        m_vTable[ 5*i + CENTRE ] = i;
+        for ( int d = 0; d < 4; d++ )
+        {
+            Site* neigh = m_vSites[ i ]->getNeighPosition( directions[ d ] );
+            if ( neigh )
+                m_vTable[ 5*i + NORTH + d ] = neigh->getID();
+        }
+    }
+
+    // The inverse table: the keys that read each site. Counted first then filled.
+    vector<int> positions;
+    for ( Term& t : m_vReactants )
+        positions.push_back( t.position );
+
+    m_vAffectedOffsets.assign( m_iSites + 1, 0 );
+    for ( int key = 0; key < getNumKeys(); key++ )
+    {
+        vector<int> sites = mf_keySites( key, positions );
+        for ( int id : sites )
+            m_vAffectedOffsets[ id + 1 ]++;
+    }
+
+    for ( int i = 0; i < m_iSites; i++ )
+        m_vAffectedOffsets[ i + 1 ] += m_vAffectedOffsets[ i ];
+
+    m_vAffected.resize( m_vAffectedOffsets[ m_iSites ] );
+    vector<int> fill( m_vAffectedOffsets.begin(), m_vAffectedOffsets.end() - 1 );
+    for ( int key = 0; key < getNumKeys(); key++ )
+    {
+        vector<int> sites = mf_keySites( key, positions );
+        for ( int id : sites )
+            m_vAffected[ fill[ id ]++ ] = key;
+    }
+}
+
+vector<int> ReactionTemplate::mf_keySites( int key, vector<int>& positions )
+{
+    vector<int> sites;
+    int anchor = getAnchor( key );
+    int orientation = key%m_iOrientations;
+    for ( int p : positions )
+    {
+        int id = m_vTable[ 5*anchor + mf_position( p, orientation ) ];
+        if ( id >= 0 && find( sites.begin(), sites.end(), id ) == sites.end() )
+            sites.push_back( id );
+    }
+    return sites;
+}
+
+Site* ReactionTemplate::getSite( int key, int position )
+{
+    int id = m_vTable[ 5*getAnchor( key ) + mf_position( position, key%m_iOrientations ) ];
+    return id >= 0 ? m_vSites[ id ] : 0;
+}
+
+bool ReactionTemplate::matches( int key )
+{
+    for ( Term& t : m_vReactants )
+    {
+        Site* s = getSite( key, t.position );
+        if ( !s )
+            return false;
+
+        if ( t.species == 0 )
+        {
+            if ( s->getNumSpecies() != 0 )
+                return false;
+        }
+        else if ( s->getSpeciesCount( t.species->getId() ) < t.count )
+            return false;
+    }
+    return true;
+}
+
+void ReactionTemplate::accountMemory( Utils::MemoryReport& report )
+{
+    report.add( Utils::MemoryReport::POOLS, Utils::MemoryReport::heap( m_vSites ) + Utils::MemoryReport::heap( m_vReactants )
+                + Utils::MemoryReport::heap( m_vProducts ) + Utils::MemoryReport::heap( m_vTable )
+                + Utils::MemoryReport::heap( m_vAffectedOffsets ) + Utils::MemoryReport::heap( m_vAffected ) );
+}
+
+void ReactionTemplate::estimateMemory( Utils::MemoryReport& report, long sites )
+{
+    // At most four orientations and every key reads the five positions
+    report.add( Utils::MemoryReport::POOLS, Utils::MemoryReport::block( sites*sizeof( Site* ) ) + Utils::MemoryReport::block( 5*sites*sizeof( int ) )
+                + Utils::MemoryReport::block( ( sites + 1 )*sizeof( int ) ) + Utils::MemoryReport::block( 4*5*sites*sizeof( int ) ) );
+}
+
+}
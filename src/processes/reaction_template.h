@@ -0,0 +1,152 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef REACTION_TEMPLATE_H
+#define REACTION_TEMPLATE_H
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "lattice.h"
+#include "species.h"
+
+using namespace std;
+
+namespace MicroProcesses
+{
+
+/** A multi-site pattern of a surface reaction. Every term of the reaction is placed on the
+ * anchor site or on one of its NESW neighbours:
+ *
+ *    A* + B*@E -> C*          A on the site, B on its east neighbour
+ *    A* + *@nb -> A*@nb + *   A next to an empty site, in any of the four directions
+ *
+ * A term is [count]Species*[@N|S|E|W|nb]. A bare * is an empty site. Gas species (no *) do not
+ * take part in the pattern. The terms placed on "nb" refer to the same neighbour, so the pattern
+ * has four orientations and a match is an (anchor, orientation) pair, called key.
+ * At init the pattern is compiled against the lattice into a table with the sites of every
+ * position of every anchor and into the inverse table with the keys that read each site,
+ * so that after an event only the keys around the changed sites need to be matched again. */
+
+class ReactionTemplate
+{
+public:
+    /// The position of a term relative to the anchor site.
+    enum Position
+    {
+        CENTRE,
+        NORTH,
+        SOUTH,
+        EAST,
+        WEST,
+        NEIGHBOUR
+    };
+
+    /// A species (or an empty site if species is null) at a position.
+    struct Term
+    {
+        int position;
+        Species* species;
+        int count;
+    };
+
+    /// Constructor
+    ReactionTemplate();
+
+    /// Destructor
+    virtual ~ReactionTemplate();
+
+    /// Parses the reactant and product terms of a reaction. Returns an error message, empty on success.
+    string parse( vector<string> reactants, vector<string> products, map<string, Species*> species );
+
+    /// Builds the site table and the inverse table for the lattice.
+    void compile( Lattice* lattice );
+
+    /// The number of keys i.e. sites times orientations.
+    inline int getNumKeys() { return m_iSites*m_iOrientations; }
+
+    /// The anchor site of a key.
+    inline int getAnchor( int key ) { return key/m_iOrientations; }
+
+    /// The site of a position of a key. Null if the lattice has no such neighbour.
+    Site* getSite( int key, int position );
+
+    /// True if the reactants are present on the sites of a key.
+    bool matches( int key );
+
+    /// The number of keys whose pattern reads the site with this id.
+    inline int getNumAffected( int id ) { return m_vAffectedOffsets[ id + 1 ] - m_vAffectedOffsets[ id ]; }
+
+    /// The k-th key whose pattern reads the site with this id.
+    inline int getAffected( int id, int k ) { return m_vAffected[ m_vAffectedOffsets[ id ] + k ]; }
+
+    /// The reactant terms.
+    inline vector<Term>& getReactants() { return m_vReactants; }
+
+    /// The product terms.
+    inline vector<Term>& getProducts() { return m_vProducts; }
+
+    /// The number of molecules of each gas species that an event releases (negative if it consumes them).
+    inline map<string, int>& getGas() { return m_mGas; }
+
+    /// Adds the terms and the tables to the memory report (not the object, which is part of its owner).
+    void accountMemory( Utils::MemoryReport& report );
+
+    /// Adds the projection of the tables for a lattice with sites sites to the memory report.
+    static void estimateMemory( Utils::MemoryReport& report, long sites );
+
+private:
+    /// The sites of the lattice
+    vector<Site*> m_vSites;
+
+    /// The number of sites
+    int m_iSites;
+
+    /// One orientation, or four if a term is placed on "nb"
+    int m_iOrientations;
+
+    /// The reactant terms. The terms at the same position and of the same species are merged.
+    vector<Term> m_vReactants;
+
+    /// The product terms
+    vector<Term> m_vProducts;
+
+    /// The gas terms: the products count positive and the reactants negative
+    map<string, int> m_mGas;
+
+    /// The id of the site at each of the positions CENTRE to WEST of each anchor, -1 if missing
+    vector<int> m_vTable;
+
+    /// The keys that read each site in compressed rows
+    vector<int> m_vAffectedOffsets;
+    vector<int> m_vAffected;
+
+    /// The distinct sites read by the positions of a key
+    vector<int> mf_keySites( int key, vector<int>& positions );
+
+    /// Parses a term and adds it to terms. Gas terms are added to the gas balance. Returns an error message, empty on success.
+    string mf_parseTerm( string term, map<string, Species*>& species, vector<Term>& terms, bool reactant );
+
+    /// The position CENTRE to WEST of a term position for an orientation
+    inline int mf_position( int position, int orientation ) { return position == NEIGHBOUR ? NORTH + orientation : position; }
+};
+
+}
+
+#endif // REACTION_TEMPLATE_H
@@ -0,0 +1,126 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+/** The Python module of Apothesis (pybind11). An instance is built from the text of an input file and is
+ * advanced and driven from Python without a process or a log file:
+ *
+ *   import apothesis
+ *   sim = apothesis.Apothesis( open( "input.txt" ).read() )
+ *   sim.pressure = 2e5
+ *   sim.advance_until( 1e-6 )
+ *   h = sim.heights()              # (x, y) view of the heights of the engine
+ *   n = sim.species_counts()       # (x, y, species) view of the species on the sites
+ *   obs = sim.observables()        # column name -> array (needs the observables or observe keyword)
+ *
+ * The heights and the species counts are read-only NumPy views of the flat storage of the lattice: no copy is
+ * made and they follow the simulation as it advances. They keep the instance alive. Errors in the input
+ * terminate the interpreter as they terminate the executable. */
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include "apothesis.h"
+#include "lattice.h"
+#include "species.h"
+#include "observables.h"
+
+namespace py = pybind11;
+
+/// A read-only view of storage of the instance self. The view keeps self alive.
+static py::array readOnlyView( py::object self, int* data, vector< py::ssize_t > shape )
+{
+  vector< py::ssize_t > strides( shape.size(), sizeof( int ) );
+  for ( int i = (int)shape.size() - 2; i >= 0; i-- )
+    strides[ i ] = strides[ i + 1 ]*shape[ i + 1 ];
+
+  py::array view = py::array_t< int >( shape, strides, data, self );
+  view.attr( "setflags" )( py::arg( "write" ) = false );
+  return view;
+}
+
+PYBIND11_MODULE( apothesis, m )
+{
+  m.doc() = "Apothesis: a kinetic Monte Carlo code for deposition processes";
+
+  py::class_< Apothesis >( m, "Apothesis" )
+      .def( py::init( []( const string& input ){
+              Apothesis* apothesis = new Apothesis( input );
+              apothesis->init();
+              return apothesis;
+            } ), py::arg( "input" ), "Builds and initializes an instance from the text of an input file" )
+
+      .def( "advance_until", &Apothesis::advanceUntil, py::arg( "time" ),
+            "Performs events until the simulation time reaches time [s]. Returns the number of events." )
+      .def( "advance_events", &Apothesis::advanceEvents, py::arg( "n" ),
+            "Performs at least n events. Returns the number of events." )
+
+      .def_property_readonly( "time", &Apothesis::getTime, "The simulation time [s]" )
+      .def_property_readonly( "events", &Apothesis::getEvents, "The number of events performed" )
+      .def_property( "pressure", &Apothesis::getPressure, &Apothesis::setPressure, "The pressure [Pa]" )
+      .def_property( "temperature", &Apothesis::getTemperature, &Apothesis::setTemperature, "The temperature [K]" )
+
+      .def( "set_mass_fraction", []( Apothesis& apothesis, const string& species, double fraction ){
+              if ( !apothesis.setMassFraction( species, fraction ) )
+                throw py::key_error( "No adsorption of " + species );
+            }, py::arg( "species" ), py::arg( "fraction" ), "Sets the mass fraction of an adsorbing species" )
+      .def( "mass_fraction", []( Apothesis& apothesis, const string& species ){
+              double fraction = apothesis.getMassFraction( species );
+              if ( fraction < 0 )
+                throw py::key_error( "No adsorption of " + species );
+              return fraction;
+            }, py::arg( "species" ), "The mass fraction of an adsorbing species" )
+      .def( "flux", &Apothesis::getFlux, py::arg( "species" ),
+            "The net flux of a species to the surface (adsorptions minus desorptions and the gas of the surface reactions) [1/(site s)] during the last advance" )
+
+      .def( "species", []( Apothesis& apothesis ){
+              vector< string > names( apothesis.getNumSpecies() );
+              for ( auto& species : apothesis.getAllSpecies() )
+                if ( species.second )
+                  names[ species.second->getId() ] = species.first;
+              return names;
+            }, "The names of the species in the order of the species counts" )
+
+      .def( "heights", []( py::object self ){
+              Lattice* lattice = self.cast< Apothesis& >().pLattice;
+              return readOnlyView( self, lattice->getHeights(), { lattice->getX(), lattice->getY() } );
+            }, "The heights of the sites as an (x, y) view" )
+      .def( "species_counts", []( py::object self ){
+              Lattice* lattice = self.cast< Apothesis& >().pLattice;
+              return readOnlyView( self, lattice->getSpeciesCounts(), { lattice->getX(), lattice->getY(), lattice->getNumSpecies() } );
+            }, "The number of each species on the sites as an (x, y, species) view" )
+
+      .def( "observables", []( Apothesis& apothesis ){
+              py::dict columns;
+              Observables* observables = apothesis.pObservables;
+              if ( !observables )
+                return columns;
+
+              const vector< string >& names = observables->getColumns();
+              const vector< double >& rows = observables->getRows();
+              int numColumns = names.size();
+              int numRows = rows.size()/numColumns;
+              for ( int c = 0; c < numColumns; c++ ){
+                py::array_t< double > column( numRows );
+                double* values = column.mutable_data();
+                for ( int r = 0; r < numRows; r++ )
+                  values[ r ] = rows[ r*numColumns + c ];
+                columns[ py::str( names[ c ] ) ] = column;
+              }
+              return columns;
+            }, "The observables sampled so far: column name -> array" );
+}
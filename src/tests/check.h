@@ -0,0 +1,32 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <cstdlib>
+#include <iostream>
+
+/// The regression checks are programs that run Apothesis embedded. A failed check reports
+/// its message and the program returns 1, which ctest counts as a failure.
+#define CHECK( condition, message ) \
+  if ( !( condition ) ){ \
+    std::cerr << __FILE__ << ":" << __LINE__ << ": " << message << std::endl; \
+    return EXIT_FAILURE; \
+  }
+
+#endif // CHECK_H
@@ -0,0 +1,80 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+// The engines select the same events with different data structures: bkl scans the processes, nrm keeps a
+// putative time per channel and tree samples sum trees over the rate classes (composition-rejection over the
+// weights of the lateral interactions). On the same input they must give the same steady state: the mean
+// coverage and the number of events over the same time agree within their noise.
+
+#include "apothesis.h"
+#include "lattice.h"
+#include "species.h"
+#include "check.h"
+
+#include <cmath>
+
+static const char* input =
+  "build_lattice  BCC  40 40 10\n"
+  "nspecies 1\n"
+  "A 32\n"
+  "nprocesses 3\n"
+  "A + * -> A*, simple 0.1 0.5 1.0e+19\n"
+  "A* -> A + *, simple 1.0e+5 1.0e+13\n"
+  "A* -> A*, simple 7.14e+4 7.14e+4\n"
+  "time  1\n"
+  "temperature 1000\n"
+  "pressure 101325\n";
+
+/// The mean coverage of A over 1e-5 s after 1e-6 s, and the number of events
+static void steadyState( string engine, string settings, double& coverage, long& events )
+{
+  Apothesis kmc( string( input ) + "engine  " + engine + "\n" + settings );
+  kmc.init();
+  kmc.advanceUntil( 1e-6 );
+
+  int id = kmc.getSpecies( "A" )->getId();
+  const int samples = 200;
+  coverage = 0;
+  events = 0;
+  for ( int i = 1; i <= samples; i++ ){
+    events += kmc.advanceUntil( 1e-6 + i*5e-8 );
+    coverage += (double)kmc.pLattice->getSpeciesSites( id )/kmc.pLattice->getSize();
+  }
+  coverage /= samples;
+}
+
+int main()
+{
+  for ( string settings : { "", "lateral  A A 4000\n" } ){
+    double expected;
+    long expectedEvents;
+    steadyState( "bkl", settings, expected, expectedEvents );
+    CHECK( expected > 0.1 && expected < 0.4, "The coverage of bkl is " << expected );
+
+    for ( string engine : { "tree", "nrm" } ){
+      double coverage;
+      long events;
+      steadyState( engine, settings, coverage, events );
+      std::cout << engine << ( settings.empty() ? "" : " with lateral interactions" ) << ": coverage " << coverage << " vs " << expected << ", events " << events << " vs " << expectedEvents << std::endl;
+
+      CHECK( fabs( coverage - expected ) < 0.03*expected, "The coverage of " << engine << " " << coverage << " differs from " << expected );
+      CHECK( fabs( events - expectedEvents ) < 0.03*expectedEvents, "The " << events << " events of " << engine << " differ from " << expectedEvents );
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
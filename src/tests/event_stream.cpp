@@ -0,0 +1,78 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+// An event stream replayed up to a time must rebuild the lattice of the run at that time: the heights and
+// the species of every site. The time falls after several keyframes and between two of them.
+
+#include "apothesis.h"
+#include "lattice.h"
+#include "site.h"
+#include "check.h"
+
+#include <fstream>
+
+static const char* input =
+  "build_lattice  BCC  10 10 10\n"
+  "nspecies 1\n"
+  "O2 32\n"
+  "nprocesses 2\n"
+  "O2 + * -> O2*, simple 0.1 1.0 1.0e+19\n"
+  "O2* -> O2 + *, simple 1.0e+13 1.0e+13\n"
+  "time  2e-6\n"
+  "temperature 1000\n"
+  "pressure 101325\n"
+  "event_stream  Events.bin 100\n";
+
+/// The heights and the number of species of every site
+static vector< int > surface( Apothesis& kmc )
+{
+  vector< int > state;
+  for ( int i = 0; i < kmc.pLattice->getSize(); i++ ){
+    state.push_back( kmc.pLattice->getSite( i )->getHeight() );
+    state.push_back( kmc.pLattice->getSite( i )->getSpecies().size() );
+  }
+  return state;
+}
+
+int main()
+{
+  vector< int > expected;
+  long events;
+  {
+    Apothesis kmc( input );
+    kmc.init();
+    events = kmc.advanceUntil( 1e-6 );
+    expected = surface( kmc );
+
+    // The stream goes on after the time of the replay
+    kmc.advanceUntil( 2e-6 );
+  }
+  CHECK( events > 250, "Only " << events << " events before the time of the replay" );
+
+  // The replay reads the input of the working directory
+  std::ofstream( "input.txt" ) << input;
+
+  char program[] = "check_event_stream", option[] = "--replay", stream[] = "Events.bin", time[] = "1e-6";
+  char* argv[] = { program, option, stream, time };
+  Apothesis replay( 4, argv );
+  replay.init();
+  replay.replay();
+
+  CHECK( surface( replay ) == expected, "The replay differs from the run at 1e-6 s" );
+
+  return EXIT_SUCCESS;
+}
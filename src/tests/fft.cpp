@@ -0,0 +1,53 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+// The real 2D FFT of the morphology packs two real rows in one complex FFT. It must give the DFT of the
+// heights, for even and odd sizes (radix-2 and Bluestein), and irfft2 must invert it.
+
+#include "fft.h"
+#include "check.h"
+
+#include <cmath>
+
+int main()
+{
+  for ( int nx : { 1, 2, 5, 8, 9 } )
+    for ( int ny : { 1, 3, 4, 10, 16 } ){
+      vector< double > data( nx*ny );
+      for ( int i = 0; i < nx*ny; i++ )
+        data[ i ] = sin( 0.37*i ) + 0.3*cos( 1.1*i );
+
+      int nh = ny/2 + 1;
+      vector< complex< double > > spectrum = Utils::rfft2( data, nx, ny );
+      CHECK( (int)spectrum.size() == nx*nh, "The spectrum of " << nx << "x" << ny << " has " << spectrum.size() << " terms" );
+
+      for ( int a = 0; a < nx; a++ )
+        for ( int b = 0; b < nh; b++ ){
+          complex< double > dft = 0;
+          for ( int i = 0; i < nx; i++ )
+            for ( int j = 0; j < ny; j++ )
+              dft += data[ i*ny + j ]*polar( 1.0, -2.0*M_PI*( (double)a*i/nx + (double)b*j/ny ) );
+          CHECK( abs( dft - spectrum[ a*nh + b ] ) < 1e-9, "rfft2 of " << nx << "x" << ny << " differs from the DFT at " << a << "," << b );
+        }
+
+      vector< double > back = Utils::irfft2( spectrum, nx, ny );
+      for ( int i = 0; i < nx*ny; i++ )
+        CHECK( fabs( back[ i ] - data[ i ] ) < 1e-9, "irfft2 of " << nx << "x" << ny << " does not invert rfft2 at " << i );
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,58 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+// A hop of a surface reaction template moves a species to a neighbour and must keep the total height of the
+// film. Only the reactions declared with , deposit grow it.
+
+#include "apothesis.h"
+#include "lattice.h"
+#include "check.h"
+
+#include <numeric>
+
+static long totalHeight( Apothesis& kmc )
+{
+  int* heights = kmc.pLattice->getHeights();
+  return std::accumulate( heights, heights + kmc.pLattice->getSize(), 0L );
+}
+
+int main()
+{
+  Apothesis kmc( "build_lattice  FCC  10 10 10\n"
+                 "nspecies 1\n"
+                 "O2 32\n"
+                 "nprocesses 2\n"
+                 "O2 + * -> O2*, simple 0.1 1.0 1.0e+19\n"
+                 "O2* + *@nb -> O2*@nb + *, simple 1.0e+4 1.0e+13\n"
+                 "time  1e-4\n"
+                 "temperature 1000\n"
+                 "pressure 101325\n" );
+  kmc.init();
+
+  // Cover part of the surface, then let only the hops happen
+  long initial = totalHeight( kmc );
+  kmc.advanceEvents( 100 );
+  long covered = totalHeight( kmc );
+  CHECK( covered >= initial, "The adsorptions lowered the film from " << initial << " to " << covered );
+
+  kmc.setPressure( 0 );
+  long hops = kmc.advanceEvents( 100000 );
+  CHECK( hops == 100000, "Only " << hops << " hops were performed" );
+  CHECK( totalHeight( kmc ) == covered, "The hops changed the total height from " << covered << " to " << totalHeight( kmc ) );
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,91 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+// A rate law is compiled once and folded for the fixed variables. The folded law must not read them and
+// must give the value of the text, also after it is folded again for another condition.
+
+#include "rate_expression.h"
+#include "check.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace MicroProcesses;
+
+/// Compiles and folds an expression without variables
+static double constant( const string& text )
+{
+  RateExpression e;
+  if ( !e.parse( text, {} ).empty() )
+    return numeric_limits< double >::quiet_NaN();
+  e.fold( {}, {} );
+  return e.isConstant() ? e.evaluate( 0 ) : numeric_limits< double >::quiet_NaN();
+}
+
+static bool close( double a, double b )
+{
+  return fabs( a - b ) <= 1e-12*fabs( b );
+}
+
+int main()
+{
+  // Precedence, associativity and functions
+  CHECK( close( constant( "1 + 2*3" ), 7 ), "1 + 2*3 is " << constant( "1 + 2*3" ) );
+  CHECK( close( constant( "2^3^2" ), 512 ), "2^3^2 is " << constant( "2^3^2" ) );
+  CHECK( close( constant( "-2^2" ), -4 ), "-2^2 is " << constant( "-2^2" ) );
+  CHECK( close( constant( "2^-1" ), 0.5 ), "2^-1 is " << constant( "2^-1" ) );
+  CHECK( close( constant( "8/4/2" ), 1 ), "8/4/2 is " << constant( "8/4/2" ) );
+  CHECK( close( constant( "min(3, max(1, 2)) + sqrt(16)/2" ), 4 ), "min(3, max(1, 2)) + sqrt(16)/2 is wrong" );
+  CHECK( close( constant( "log(exp(1.5))" ), 1.5 ), "log(exp(1.5)) is " << constant( "log(exp(1.5))" ) );
+
+  // The errors are reported
+  for ( string bad : { "1 +", "2*", "(1", "exp(1", "min(1)", "nu", "1 2" } ){
+    RateExpression e;
+    CHECK( !e.parse( bad, {} ).empty(), "No error for " << bad );
+  }
+
+  // A desorption law with a coverage: all but theta are folded
+  enum { NU, E, THETA, R, T };
+  vector< string > names = { "nu", "E", "theta", "R", "T" };
+  RateExpression law;
+  string error = law.parse( "nu*exp(-(E - 5000*theta)/(R*T))", names );
+  CHECK( error.empty(), error );
+  CHECK( law.uses( THETA ) && law.uses( T ), "The variables of the law are not found" );
+
+  double nu = 1e13, energy = 1.5e5, r = 8.314;
+  vector< bool > fixed = { true, true, false, true, true };
+  for ( double temperature : { 700.0, 1000.0 } ){
+    law.fold( { nu, energy, 0, r, temperature }, fixed );
+    CHECK( !law.isConstant(), "The law is constant but reads the coverage" );
+
+    // The fixed variables are folded so they are not read any more
+    double nan = numeric_limits< double >::quiet_NaN();
+    for ( double theta : { 0.0, 0.3, 1.0 } ){
+      double values[] = { nan, nan, theta, nan, nan };
+      double expected = nu*exp( -( energy - 5000*theta )/( r*temperature ) );
+      CHECK( close( law.evaluate( values ), expected ), "The law at T = " << temperature << ", theta = " << theta << " is " << law.evaluate( values ) << " instead of " << expected );
+    }
+  }
+
+  // Without a coverage the law is folded to a constant
+  fixed[ THETA ] = true;
+  law.fold( { nu, energy, 0.5, r, 1000.0 }, fixed );
+  CHECK( law.isConstant(), "The law is not folded to a constant" );
+  CHECK( close( law.evaluate( 0 ), nu*exp( -( energy - 2500 )/( r*1000.0 ) ) ), "The folded law is " << law.evaluate( 0 ) );
+
+  return EXIT_SUCCESS;
+}
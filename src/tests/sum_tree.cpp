@@ -0,0 +1,63 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+// The sum tree must find every item with a probability proportional to its weight, never an item of zero
+// weight, and follow the updates of the weights.
+
+#include "sum_tree.h"
+#include "check.h"
+
+#include <cmath>
+
+int main()
+{
+  Utils::SumTree tree;
+  vector< double > weights = { 1.0, 0.0, 3.0, 0.5, 2.5, 0.0, 1e-3 };
+  tree.init( weights.size() );
+  for ( int i = 0; i < (int)weights.size(); i++ )
+    tree.update( i, weights[ i ] );
+
+  for ( int round = 0; round < 2; round++ ){
+    double total = 0;
+    for ( double w : weights )
+      total += w;
+    CHECK( fabs( tree.getTotal() - total ) < 1e-12, "The total is " << tree.getTotal() << " instead of " << total );
+
+    // The cumulative values on a fine grid fall on each item in proportion to its weight
+    const int samples = 1000000;
+    vector< long > counts( weights.size(), 0 );
+    for ( int k = 0; k < samples; k++ ){
+      double value = ( k + 0.5 )/samples*total;
+      int item = tree.find( value );
+      CHECK( item >= 0 && item < (int)weights.size() && weights[ item ] > 0, "The value fell on the item " << item );
+      CHECK( value >= 0 && value < weights[ item ], "The rest of the value " << value << " is outside the item " << item );
+      counts[ item ]++;
+    }
+
+    for ( int i = 0; i < (int)weights.size(); i++ )
+      CHECK( fabs( counts[ i ] - weights[ i ]/total*samples ) <= 1.0, "The item " << i << " was found " << counts[ i ] << " times" );
+
+    // Move the weight around and check again
+    weights[ 0 ] = 0.0;
+    weights[ 1 ] = 4.0;
+    weights[ 6 ] = 0.25;
+    for ( int i : { 0, 1, 6 } )
+      tree.update( i, weights[ i ] );
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposotion processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+// The tau leaping of the adsorptions must follow the exact steps. Pure adsorption on BCC 100x100 with a
+// tolerance of 0.03: the coverage at 2e-7 s of the leaps and of the exact steps (about 0.39) agree within the
+// noise of the 10^4 sites.
+
+#include "apothesis.h"
+#include "lattice.h"
+#include "species.h"
+#include "tau_leaping.h"
+#include "check.h"
+
+#include <cmath>
+
+static const char* input =
+  "build_lattice  BCC  100 100 10\n"
+  "nspecies 1\n"
+  "A 32\n"
+  "nprocesses 1\n"
+  "A + * -> A*, simple 0.1 0.5 1.0e+19\n"
+  "time  2e-7\n"
+  "temperature 1000\n"
+  "pressure 101325\n";
+
+/// The fraction of the sites that hold A, as in the observables
+static double coverage( Apothesis& kmc )
+{
+  return (double)kmc.pLattice->getSpeciesSites( kmc.getSpecies( "A" )->getId() )/kmc.pLattice->getSize();
+}
+
+int main()
+{
+  Apothesis exact( input );
+  exact.init();
+  exact.advanceUntil( 2e-7 );
+
+  Apothesis leaping( string( input ) + "tau_leaping 0.03\n" );
+  leaping.init();
+  leaping.advanceUntil( 2e-7 );
+
+  CHECK( leaping.pLeaping && leaping.pLeaping->getNumLeaps() > 0, "No leap was taken" );
+
+  double expected = coverage( exact );
+  double leaped = coverage( leaping );
+  std::cout << "Coverage at 2e-7 s: " << leaped << " leap vs " << expected << " exact" << std::endl;
+
+  CHECK( expected > 0.3 && expected < 0.5, "The coverage of the exact steps is " << expected );
+  CHECK( std::fabs( leaped - expected ) < 0.02, "The coverage of the leaps " << leaped << " differs from " << expected );
+
+  return EXIT_SUCCESS;
+}